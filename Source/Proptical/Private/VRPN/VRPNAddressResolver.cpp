@@ -0,0 +1,133 @@
+#include "VRPNAddressResolver.h"
+#include "VRPN/VRPNLog.h"
+#include "Async/Async.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+FVRPNAddressResolver::FVRPNAddressResolver(double InTimeToLive)
+	: TimeToLive(InTimeToLive)
+{
+}
+
+bool FVRPNAddressResolver::IsLiteralAddress(const FString& HostName)
+{
+	// Parses without any lookup
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	return SocketSubsystem && SocketSubsystem->GetAddressFromString(HostName).IsValid();
+}
+
+bool FVRPNAddressResolver::TryResolveNow(const FString& HostName, FString& OutAddress) const
+{
+	if (IsLiteralAddress(HostName))
+	{
+		OutAddress = HostName;
+		return true;
+	}
+
+	const FEntry* Entry = Entries.Find(HostName);
+	if (Entry && !Entry->bInFlight && !Entry->Address.IsEmpty() && FPlatformTime::Seconds() < Entry->ExpireTime)
+	{
+		OutAddress = Entry->Address;
+		return true;
+	}
+	return false;
+}
+
+void FVRPNAddressResolver::Resolve(const FString& HostName, FOnResolved OnResolved)
+{
+	check(IsInGameThread());
+
+	FString Address;
+	if (TryResolveNow(HostName, Address))
+	{
+		OnResolved(Address);
+		return;
+	}
+
+	FEntry& Entry = Entries.FindOrAdd(HostName);
+	if (!Entry.bInFlight && FPlatformTime::Seconds() < Entry.ExpireTime)
+	{
+		// Failed a moment ago; the next lookup waits for the failure to expire
+		OnResolved(FString());
+		return;
+	}
+
+	Entry.Waiting.Add(MoveTemp(OnResolved));
+	if (!Entry.bInFlight)
+	{
+		Entry.bInFlight = true;
+		StartLookup(HostName);
+	}
+}
+
+void FVRPNAddressResolver::Flush()
+{
+	for (TMap<FString, FEntry>::TIterator It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().bInFlight)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FVRPNAddressResolver::StartLookup(const FString& HostName)
+{
+	// DNS can take seconds to answer or time out, so it never runs on the game thread
+	TWeakPtr<FVRPNAddressResolver, ESPMode::ThreadSafe> WeakResolver = AsShared();
+	Async(EAsyncExecution::ThreadPool, [WeakResolver, HostName]()
+	{
+		FString Address;
+		if (ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM))
+		{
+			const FAddressInfoResult Result = SocketSubsystem->GetAddressInfo(*HostName, nullptr, EAddressInfoFlags::Default, NAME_None, ESocketType::SOCKTYPE_Datagram);
+
+			// The receive backends join groups and bind over IPv4; an IPv6-only host still resolves
+			for (const FAddressInfoResultData& Data : Result.Results)
+			{
+				const bool bIPv4 = Data.Address->GetProtocolType() == FNetworkProtocolTypes::IPv4;
+				if (Address.IsEmpty() || bIPv4)
+				{
+					Address = Data.Address->ToString(false);
+				}
+				if (bIPv4)
+				{
+					break;
+				}
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakResolver, HostName, Address]()
+		{
+			if (TSharedPtr<FVRPNAddressResolver, ESPMode::ThreadSafe> Resolver = WeakResolver.Pin())
+			{
+				Resolver->CompleteLookup(HostName, Address);
+			}
+		});
+	});
+}
+
+void FVRPNAddressResolver::CompleteLookup(const FString& HostName, const FString& Address)
+{
+	FEntry& Entry = Entries.FindOrAdd(HostName);
+	Entry.bInFlight = false;
+	Entry.Address = Address;
+	Entry.ExpireTime = FPlatformTime::Seconds() + (Address.IsEmpty() ? FailureTimeToLive : TimeToLive);
+
+	if (Address.IsEmpty())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Could not resolve host %s"), *HostName);
+	}
+	else
+	{
+		UE_LOG(LogVRPN, Log, TEXT("Resolved %s to %s"), *HostName, *Address);
+	}
+
+	// Callbacks may resolve again, which can touch the map
+	TArray<FOnResolved> Waiting = MoveTemp(Entry.Waiting);
+	Entry.Waiting.Reset();
+	for (FOnResolved& Callback : Waiting)
+	{
+		Callback(Address);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Resolves server hostnames without blocking the game thread, with a time-limited cache
+ *
+ * Literal IP addresses resolve immediately. Hostnames are looked up with GetAddressInfo on a
+ * thread pool worker and the answer is handed back on the game thread; concurrent requests for
+ * the same host share one lookup. Answers are kept for TimeToLive seconds, failures for a short
+ * while so a missing host is not looked up again on every connect attempt.
+ *
+ * Everything except the lookup itself runs on the game thread.
+ */
+class FVRPNAddressResolver : public TSharedFromThis<FVRPNAddressResolver, ESPMode::ThreadSafe>
+{
+public:
+	/**
+	 * Called on the game thread with the resolved IP address
+	 * @param Address IP address as a string, empty if the host could not be resolved
+	 */
+	using FOnResolved = TFunction<void(const FString& Address)>;
+
+	/** @param InTimeToLive Seconds a resolved address is reused before the host is looked up again */
+	explicit FVRPNAddressResolver(double InTimeToLive = 60.0);
+
+	/**
+	 * Resolve a host (game thread)
+	 * Literal and cached addresses call OnResolved before returning; anything else calls it from a later game thread task.
+	 */
+	void Resolve(const FString& HostName, FOnResolved OnResolved);
+
+	/**
+	 * Address of a host that is known without a lookup: a literal IP, or a cached answer that has not expired (game thread)
+	 * @return false if resolving the host would need a lookup
+	 */
+	bool TryResolveNow(const FString& HostName, FString& OutAddress) const;
+
+	/** Forget every cached answer (lookups in flight still complete) */
+	void Flush();
+
+	/** True if the string is a literal IPv4 or IPv6 address */
+	static bool IsLiteralAddress(const FString& HostName);
+
+private:
+	struct FEntry
+	{
+		/** Resolved IP, empty for a failed lookup */
+		FString Address;
+
+		/** Local time after which the answer is looked up again */
+		double ExpireTime = 0.0;
+
+		/** A lookup is running; Waiting is called when it completes */
+		bool bInFlight = false;
+		TArray<FOnResolved> Waiting;
+	};
+
+	/** Run the lookup on a worker */
+	void StartLookup(const FString& HostName);
+
+	/** Store a lookup's answer and call everyone waiting for it (game thread) */
+	void CompleteLookup(const FString& HostName, const FString& Address);
+
+	/** Cache by host name as given */
+	TMap<FString, FEntry> Entries;
+
+	/** Seconds a resolved address is reused */
+	double TimeToLive;
+
+	/** Seconds a failed lookup is remembered */
+	static constexpr double FailureTimeToLive = 5.0;
+};
@@ -0,0 +1,372 @@
+#include "VRPNBenchmarkCommandlet.h"
+#include "VRPNConnectionManager.h"
+#include "VRPNMessageParser.h"
+#include "VRPNSyntheticServer.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+
+namespace VRPNBenchmark
+{
+	struct FScenario
+	{
+		FString Name;
+		FVRPNSyntheticServerConfig Server;
+	};
+
+	/** Relay leg added to every scenario (empty group = none) */
+	struct FRelayConfig
+	{
+		/** Group the measured peer listens to; 0.0.0.0 makes the relay send unicast to 127.0.0.1 */
+		FString Group;
+		int32 Port = 3884;
+	};
+
+	struct FResult
+	{
+		FString Name;
+		int32 NumSensors = 0;
+		double RateHz = 0.0;
+		double Elapsed = 0.0;
+		uint64 DatagramsSent = 0;
+		uint64 DatagramsReceived = 0;
+		uint64 MessagesSent = 0;
+		uint64 SamplesDelivered = 0;
+		uint64 SamplesDropped = 0;
+		uint64 DatagramsLost = 0;
+		double ProcessMicrosPerMessage = 0.0;
+		double ParseNanosPerMessage = 0.0;
+		double QueueLatencyMs[4] = {};
+		double EndToEndLatencyMs[4] = {};
+	};
+
+	/** Percentiles reported for every latency distribution */
+	static constexpr double Percentiles[4] = { 0.50, 0.90, 0.99, 1.00 };
+
+	/** Fill Out with the Percentiles of Values (sorts Values) */
+	void ComputePercentiles(TArray<double>& Values, double (&Out)[4])
+	{
+		if (Values.Num() == 0)
+		{
+			return;
+		}
+
+		Values.Sort();
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			const int32 Rank = FMath::Clamp(FMath::CeilToInt32(Percentiles[Index] * Values.Num()) - 1, 0, Values.Num() - 1);
+			Out[Index] = Values[Rank] * 1000.0;
+		}
+	}
+
+	/** Parser cost in isolation: decode the same datagram many times */
+	double MeasureParseCost(const FVRPNSyntheticServerConfig& Config)
+	{
+		const int32 MessageSize = FVRPNMessageParser::VRPN_HEADER_SIZE + FVRPNMessageParser::VRPN_TRACKER_POS_QUAT_SIZE;
+		TArray<uint8> Datagram;
+		Datagram.SetNumZeroed(MessageSize * Config.MessagesPerDatagram);
+		int32 Size = 0;
+		for (int32 Message = 0; Message < Config.MessagesPerDatagram; ++Message)
+		{
+			Size += FVRPNMessageParser::WriteTrackerMessage(Datagram.GetData() + Size, Datagram.Num() - Size,
+				0, 0, 1700000000.25, Message, FVector(1.0, 2.0, 3.0), FQuat::Identity);
+		}
+
+		TArray<FVRPNTrackerSample> Samples;
+		Samples.SetNumUninitialized(Config.MessagesPerDatagram);
+
+		const int32 Iterations = FMath::Max(200000 / Config.MessagesPerDatagram, 1000);
+		int32 Checksum = 0;
+		const double Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			Checksum += FVRPNMessageParser::ParseDatagram(Datagram.GetData(), Size, INDEX_NONE, Samples).NumSamples;
+		}
+		const double Elapsed = FPlatformTime::Seconds() - Start;
+
+		check(Checksum == Iterations * Config.MessagesPerDatagram);
+		return Elapsed * 1.0e9 / (double(Iterations) * Config.MessagesPerDatagram);
+	}
+
+	/**
+	 * Stream one scenario over loopback into a connection manager and drain it like a game thread
+	 * With a relay, that manager relays everything it receives and a second one listening to the relay is drained instead
+	 */
+	bool RunScenario(const FScenario& Scenario, const FRelayConfig& Relay, double Duration, double DrainHz, FResult& OutResult)
+	{
+		OutResult.Name = Scenario.Name;
+		OutResult.NumSensors = Scenario.Server.NumSensors;
+		OutResult.RateHz = Scenario.Server.RateHz;
+		OutResult.ParseNanosPerMessage = MeasureParseCost(Scenario.Server);
+
+		const int32 SensorCapacity = FMath::Max(Scenario.Server.NumSensors, 512);
+		const int32 QueueCapacity = FMath::Max(1024, Scenario.Server.NumSensors * 8);
+
+		TUniquePtr<FVRPNConnectionManager> Peer;
+		if (!Relay.Group.IsEmpty())
+		{
+			Peer = MakeUnique<FVRPNConnectionManager>();
+			Peer->SetSensorCapacity(SensorCapacity);
+			Peer->SetUpdateQueueConfig(QueueCapacity, EVRPNQueueOverflowPolicy::DropOldest);
+			Peer->SetMulticastGroup(Relay.Group, FString());
+			Peer->SetLocalUDPPort(Relay.Port);
+			if (!Peer->InitializeConnection(FString()) || !Peer->StartReceiving())
+			{
+				UE_LOG(LogVRPN, Error, TEXT("Benchmark could not listen to the relay on %s:%d"), *Relay.Group, Relay.Port);
+				return false;
+			}
+		}
+
+		TUniquePtr<FVRPNConnectionManager> Manager = MakeUnique<FVRPNConnectionManager>();
+		Manager->SetSensorCapacity(SensorCapacity);
+		Manager->SetUpdateQueueConfig(QueueCapacity, EVRPNQueueOverflowPolicy::DropOldest);
+		Manager->SetLocalUDPPort(0);
+		if (Peer.IsValid())
+		{
+			const bool bMulticast = FVRPNDatagramReceiver::IsMulticastAddress(Relay.Group);
+			Manager->SetRelayTarget(bMulticast ? Relay.Group : FString(TEXT("127.0.0.1")), Relay.Port, FString());
+		}
+		if (!Manager->InitializeConnection(TEXT("127.0.0.1")) || !Manager->StartReceiving())
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Benchmark could not open the receive socket"));
+			return false;
+		}
+
+		// Latency and delivery are measured where the poses are consumed
+		FVRPNConnectionManager& Measured = Peer.IsValid() ? *Peer : *Manager;
+
+		FVRPNSyntheticServerConfig ServerConfig = Scenario.Server;
+		ServerConfig.TargetAddress = TEXT("127.0.0.1");
+		ServerConfig.TargetPort = Manager->GetLocalUDPPort();
+		FVRPNSyntheticServer Server(ServerConfig);
+		if (!Server.Start())
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Benchmark could not start the synthetic server"));
+			Manager->StopReceiving();
+			return false;
+		}
+
+		const int64 ExpectedSamples = static_cast<int64>(ServerConfig.NumSensors * ServerConfig.RateHz * (Duration + 1.0));
+		TArray<double> QueueLatencies;
+		TArray<double> EndToEndLatencies;
+		QueueLatencies.Reserve(ExpectedSamples);
+		EndToEndLatencies.Reserve(ExpectedSamples);
+
+		// Connection events are latched by the receive thread and delivered by whoever pumps the game thread; the
+		// commandlet runs on the game thread and stands in for the subsystem
+		auto DispatchConnectionEvents = [&]()
+		{
+			Manager->DispatchConnectionEvents();
+			if (Peer.IsValid())
+			{
+				Peer->DispatchConnectionEvents();
+			}
+		};
+
+		auto Drain = [&]()
+		{
+			DispatchConnectionEvents();
+
+			const double Now = FPlatformTime::Seconds();
+			Measured.DrainTransformUpdates([&](const FVRPNSensorUpdate& Sample)
+			{
+				QueueLatencies.Add(Now - Sample.ReceiveTime);
+				EndToEndLatencies.Add(Now - Sample.Transform.Timestamp);
+			});
+		};
+
+		const double DrainPeriod = 1.0 / FMath::Max(DrainHz, 1.0);
+		const double Start = FPlatformTime::Seconds();
+		double NextDrain = Start + DrainPeriod;
+		while (FPlatformTime::Seconds() - Start < Duration)
+		{
+			const double Remaining = NextDrain - FPlatformTime::Seconds();
+			if (Remaining > 0.0)
+			{
+				FPlatformProcess::SleepNoStats(static_cast<float>(Remaining));
+			}
+			NextDrain += DrainPeriod;
+			Drain();
+		}
+
+		Server.Shutdown();
+		FPlatformProcess::SleepNoStats(0.05f);
+		Drain();
+		OutResult.Elapsed = FPlatformTime::Seconds() - Start;
+
+		OutResult.DatagramsSent = Server.GetNumDatagramsSent();
+		OutResult.MessagesSent = Server.GetNumMessagesSent();
+		OutResult.DatagramsLost = Server.GetNumDatagramsLost();
+		OutResult.SamplesDelivered = QueueLatencies.Num();
+		OutResult.SamplesDropped = Measured.GetNumDroppedUpdates();
+		if (const FVRPNReceiveCounters* Counters = Measured.GetReceiveCounters())
+		{
+			OutResult.DatagramsReceived = Counters->Datagrams.load(std::memory_order_relaxed);
+			const double ProcessMs = FPlatformTime::ToMilliseconds64(Counters->ProcessCycles.load(std::memory_order_relaxed));
+			OutResult.ProcessMicrosPerMessage = ProcessMs * 1000.0 / double(FMath::Max<uint64>(OutResult.MessagesSent, 1));
+		}
+
+		Manager->StopReceiving();
+		if (Peer.IsValid())
+		{
+			Peer->StopReceiving();
+		}
+		DispatchConnectionEvents();
+
+		ComputePercentiles(QueueLatencies, OutResult.QueueLatencyMs);
+		ComputePercentiles(EndToEndLatencies, OutResult.EndToEndLatencyMs);
+		return true;
+	}
+
+	void LogResult(const FResult& Result)
+	{
+		UE_LOG(LogVRPN, Display, TEXT("[%s] %d sensors @ %.0f Hz for %.1f s"), *Result.Name, Result.NumSensors, Result.RateHz, Result.Elapsed);
+		UE_LOG(LogVRPN, Display, TEXT("  packets/s %.0f (sent %llu, received %llu, lost on purpose %llu), messages/s %.0f"),
+			Result.DatagramsReceived / Result.Elapsed, Result.DatagramsSent, Result.DatagramsReceived, Result.DatagramsLost, Result.MessagesSent / Result.Elapsed);
+		UE_LOG(LogVRPN, Display, TEXT("  parse %.1f ns/message, receive thread %.2f us/message"), Result.ParseNanosPerMessage, Result.ProcessMicrosPerMessage);
+		UE_LOG(LogVRPN, Display, TEXT("  receive -> game thread ms p50 %.3f p90 %.3f p99 %.3f max %.3f"),
+			Result.QueueLatencyMs[0], Result.QueueLatencyMs[1], Result.QueueLatencyMs[2], Result.QueueLatencyMs[3]);
+		UE_LOG(LogVRPN, Display, TEXT("  measurement -> game thread ms p50 %.3f p90 %.3f p99 %.3f max %.3f"),
+			Result.EndToEndLatencyMs[0], Result.EndToEndLatencyMs[1], Result.EndToEndLatencyMs[2], Result.EndToEndLatencyMs[3]);
+		UE_LOG(LogVRPN, Display, TEXT("  samples delivered %llu, dropped in queue %llu"), Result.SamplesDelivered, Result.SamplesDropped);
+	}
+
+	FString ToCsvRow(const FResult& Result)
+	{
+		return FString::Printf(TEXT("%s,%d,%.0f,%.2f,%llu,%llu,%.0f,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu\n"),
+			*Result.Name, Result.NumSensors, Result.RateHz, Result.Elapsed, Result.DatagramsSent, Result.DatagramsReceived,
+			Result.DatagramsReceived / Result.Elapsed, Result.ParseNanosPerMessage, Result.ProcessMicrosPerMessage,
+			Result.QueueLatencyMs[0], Result.QueueLatencyMs[1], Result.QueueLatencyMs[2], Result.QueueLatencyMs[3],
+			Result.EndToEndLatencyMs[0], Result.EndToEndLatencyMs[1], Result.EndToEndLatencyMs[2], Result.EndToEndLatencyMs[3],
+			Result.SamplesDelivered, Result.SamplesDropped);
+	}
+
+	/** Read the synthetic server settings given on the command line over a default */
+	FVRPNSyntheticServerConfig ParseServerConfig(const FString& Params, const FVRPNSyntheticServerConfig& Default)
+	{
+		FVRPNSyntheticServerConfig Config = Default;
+		FParse::Value(*Params, TEXT("Sensors="), Config.NumSensors);
+		FParse::Value(*Params, TEXT("Rate="), Config.RateHz);
+		FParse::Value(*Params, TEXT("PerDatagram="), Config.MessagesPerDatagram);
+		FParse::Value(*Params, TEXT("Jitter="), Config.JitterMs);
+		FParse::Value(*Params, TEXT("Loss="), Config.LossRate);
+		FParse::Value(*Params, TEXT("Reorder="), Config.ReorderRate);
+		FParse::Value(*Params, TEXT("ClockOffset="), Config.ClockOffset);
+		FParse::Value(*Params, TEXT("Seed="), Config.Seed);
+		return Config;
+	}
+}
+
+UVRPNBenchmarkCommandlet::UVRPNBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UVRPNBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace VRPNBenchmark;
+
+	double Duration = 10.0;
+	FParse::Value(*Params, TEXT("Duration="), Duration);
+
+	if (FParse::Param(*Params, TEXT("Serve")))
+	{
+		FVRPNSyntheticServerConfig Config = ParseServerConfig(Params, FVRPNSyntheticServerConfig());
+		FParse::Value(*Params, TEXT("Target="), Config.TargetAddress);
+		FParse::Value(*Params, TEXT("Port="), Config.TargetPort);
+
+		FVRPNSyntheticServer Server(Config);
+		if (!Server.Start())
+		{
+			return 1;
+		}
+
+		// Duration <= 0 serves until the process is killed
+		const double Start = FPlatformTime::Seconds();
+		while (Duration <= 0.0 || FPlatformTime::Seconds() - Start < Duration)
+		{
+			FPlatformProcess::SleepNoStats(1.0f);
+			UE_LOG(LogVRPN, Display, TEXT("Synthetic server sent %llu datagrams (%llu messages)"), Server.GetNumDatagramsSent(), Server.GetNumMessagesSent());
+		}
+		Server.Shutdown();
+		return 0;
+	}
+
+	double DrainHz = 90.0;
+	FParse::Value(*Params, TEXT("DrainHz="), DrainHz);
+
+	FRelayConfig Relay;
+	if (FParse::Param(*Params, TEXT("Relay")))
+	{
+		Relay.Group = TEXT("0.0.0.0");
+		FParse::Value(*Params, TEXT("RelayGroup="), Relay.Group);
+		FParse::Value(*Params, TEXT("RelayPort="), Relay.Port);
+	}
+
+	TArray<FScenario> Scenarios;
+	FString CustomValue;
+	if (FParse::Value(*Params, TEXT("Sensors="), CustomValue) || FParse::Value(*Params, TEXT("Rate="), CustomValue))
+	{
+		Scenarios.Add({ TEXT("custom"), ParseServerConfig(Params, FVRPNSyntheticServerConfig()) });
+	}
+	else
+	{
+		// Fixed sweep; keep it stable so numbers are comparable between builds
+		FVRPNSyntheticServerConfig Config;
+		Config.NumSensors = 1;
+		Config.RateHz = 240.0;
+		Config.MessagesPerDatagram = 1;
+		Scenarios.Add({ TEXT("single"), Config });
+
+		Config.NumSensors = 32;
+		Config.MessagesPerDatagram = 8;
+		Scenarios.Add({ TEXT("stage"), Config });
+
+		Config.NumSensors = 128;
+		Config.MessagesPerDatagram = 16;
+		Scenarios.Add({ TEXT("crowd"), Config });
+
+		Config.NumSensors = 512;
+		Config.RateHz = 120.0;
+		Scenarios.Add({ TEXT("stress"), Config });
+
+		Config.NumSensors = 32;
+		Config.RateHz = 240.0;
+		Config.MessagesPerDatagram = 8;
+		Config.JitterMs = 2.0;
+		Config.LossRate = 0.01;
+		Config.ReorderRate = 0.01;
+		Scenarios.Add({ TEXT("lossy"), Config });
+	}
+
+	FString CsvPath;
+	const bool bWriteCsv = FParse::Value(*Params, TEXT("Csv="), CsvPath);
+	FString Csv = TEXT("scenario,sensors,rate_hz,elapsed_s,datagrams_sent,datagrams_received,packets_per_s,parse_ns_per_msg,receive_us_per_msg,")
+		TEXT("queue_p50_ms,queue_p90_ms,queue_p99_ms,queue_max_ms,e2e_p50_ms,e2e_p90_ms,e2e_p99_ms,e2e_max_ms,samples_delivered,samples_dropped\n");
+
+	int32 NumFailed = 0;
+	for (const FScenario& Scenario : Scenarios)
+	{
+		FResult Result;
+		if (!RunScenario(Scenario, Relay, Duration, DrainHz, Result))
+		{
+			++NumFailed;
+			continue;
+		}
+
+		LogResult(Result);
+		Csv += ToCsvRow(Result);
+	}
+
+	if (bWriteCsv && !FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Failed to write %s"), *CsvPath);
+		++NumFailed;
+	}
+
+	return NumFailed == 0 ? 0 : 1;
+}
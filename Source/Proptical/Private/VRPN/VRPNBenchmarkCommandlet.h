@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VRPNBenchmarkCommandlet.generated.h"
+
+/**
+ * VRPN loopback server and benchmark suite
+ *
+ * Benchmark (default): runs FVRPNSyntheticServer against an FVRPNConnectionManager over loopback
+ * and reports sustained packets/s, parse cost per message, receive-to-game-thread latency
+ * percentiles and dropped samples. Without scenario arguments a fixed sweep runs, so results can
+ * be compared between builds to catch throughput regressions. -Relay puts a relaying node in
+ * between and measures a peer listening to it (unicast on loopback, or the given multicast group).
+ *
+ *   UnrealEditor-Cmd <Project> -run=VRPNBenchmark [-Sensors=N -Rate=Hz -PerDatagram=N -Jitter=ms -Loss=p -Reorder=p]
+ *       [-Duration=s] [-DrainHz=Hz] [-Csv=File] [-Relay [-RelayGroup=239.255.42.99] [-RelayPort=3884]]
+ *
+ * Server: only runs the synthetic server, as a stand-in for tracking hardware.
+ *
+ *   UnrealEditor-Cmd <Project> -run=VRPNBenchmark -Serve -Target=127.0.0.1 -Port=3883 [-Sensors=... -Duration=s]
+ */
+UCLASS()
+class UVRPNBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVRPNBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,576 @@
+#include "VRPNCapture.h"
+#include "VRPN/VRPNLog.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "Async/MappedFileHandle.h"
+
+FVRPNCaptureWriter::FVRPNCaptureWriter()
+	: File(nullptr)
+	, WriterThread(nullptr)
+	, WakeEvent(nullptr)
+	, ChunkSize(0)
+	, CurrentChunk(INDEX_NONE)
+	, ChunkStartTime(0.0)
+	, FileOffset(0)
+	, NextIndexTime(0.0)
+	, NumWrittenRecords(0)
+	, bStopRequested(false)
+	, bProducerDetached(false)
+	, NumRecorded(0)
+	, NumDropped(0)
+{
+}
+
+FVRPNCaptureWriter::~FVRPNCaptureWriter()
+{
+	if (WriterThread != nullptr)
+	{
+		DetachProducer();
+		Finish();
+	}
+
+	if (WakeEvent != nullptr)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+}
+
+bool FVRPNCaptureWriter::Open(const FString& InPath, int32 InChunkSize, int32 NumChunks)
+{
+	Path = InPath;
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path);
+	if (File == nullptr)
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Failed to create capture file %s"), *Path);
+		return false;
+	}
+
+	VRPNCapture::FFileHeader Header;
+	FMemory::Memcpy(Header.Magic, VRPNCapture::FileMagic, sizeof(Header.Magic));
+	Header.Version = VRPNCapture::Version;
+	Header.HeaderSize = sizeof(Header);
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	FileOffset = sizeof(Header);
+
+	// Every buffer the receive thread will ever write into is allocated here
+	ChunkSize = FMath::Max<int32>(InChunkSize, VRPNCapture::GetRecordSize(64 * 1024));
+	Chunks.SetNum(NumChunks);
+	ChunkUsed.Init(0, NumChunks);
+	FullChunks.Initialize(NumChunks);
+	FreeChunks.Initialize(NumChunks);
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		Chunks[ChunkIndex].SetNumUninitialized(ChunkSize);
+		FreeChunks.Push(ChunkIndex);
+	}
+	Index.Reserve(4096);
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	WriterThread = FRunnableThread::Create(this, TEXT("VRPNCaptureWriter"), 0, TPri_BelowNormal);
+	if (WriterThread == nullptr)
+	{
+		delete File;
+		File = nullptr;
+		return false;
+	}
+
+	UE_LOG(LogVRPN, Log, TEXT("Recording to %s"), *Path);
+	return true;
+}
+
+void FVRPNCaptureWriter::Record(const FVRPNDatagramBatch& Batch)
+{
+	if (bProducerDetached.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	for (int32 DatagramIndex = 0; DatagramIndex < Batch.Num; ++DatagramIndex)
+	{
+		const int32 DatagramSize = Batch.Sizes[DatagramIndex];
+		const int64 RecordSize = VRPNCapture::GetRecordSize(DatagramSize);
+
+		if (CurrentChunk != INDEX_NONE && ChunkUsed[CurrentChunk] + RecordSize > ChunkSize)
+		{
+			SubmitChunk();
+		}
+
+		if (CurrentChunk == INDEX_NONE)
+		{
+			if (!FreeChunks.Pop(CurrentChunk))
+			{
+				// Writer is behind and the pool is exhausted; never wait for it
+				CurrentChunk = INDEX_NONE;
+				NumDropped.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			ChunkUsed[CurrentChunk] = 0;
+			ChunkStartTime = Batch.ReceiveTime;
+		}
+
+		uint8* Dest = Chunks[CurrentChunk].GetData() + ChunkUsed[CurrentChunk];
+		VRPNCapture::FRecordHeader Header;
+		Header.Size = static_cast<uint32>(DatagramSize);
+		Header.Reserved = 0;
+		Header.ReceiveTime = Batch.ReceiveTime;
+		FMemory::Memcpy(Dest, &Header, sizeof(Header));
+		FMemory::Memcpy(Dest + sizeof(Header), Batch.GetBuffer(DatagramIndex), DatagramSize);
+
+		const int64 Padding = RecordSize - sizeof(Header) - DatagramSize;
+		FMemory::Memzero(Dest + sizeof(Header) + DatagramSize, Padding);
+
+		ChunkUsed[CurrentChunk] += static_cast<int32>(RecordSize);
+		NumRecorded.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool FVRPNCaptureWriter::Poll(double Now)
+{
+	if (bProducerDetached.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	if (bStopRequested.load(std::memory_order_acquire))
+	{
+		DetachProducer();
+		return false;
+	}
+
+	if (CurrentChunk != INDEX_NONE && ChunkUsed[CurrentChunk] > 0 && Now - ChunkStartTime > FlushIntervalSeconds)
+	{
+		SubmitChunk();
+	}
+	return true;
+}
+
+void FVRPNCaptureWriter::SubmitChunk()
+{
+	// Cannot fail: the queue holds every chunk in the pool
+	FullChunks.Push(CurrentChunk);
+	CurrentChunk = INDEX_NONE;
+	WakeEvent->Trigger();
+}
+
+void FVRPNCaptureWriter::DetachProducer()
+{
+	if (bProducerDetached.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	if (CurrentChunk != INDEX_NONE && ChunkUsed[CurrentChunk] > 0)
+	{
+		SubmitChunk();
+	}
+
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+
+	// Last access by the producer; the owner may destroy the writer once it sees this
+	bProducerDetached.store(true, std::memory_order_release);
+}
+
+uint32 FVRPNCaptureWriter::Run()
+{
+	for (;;)
+	{
+		// Read the flag first so chunks submitted just before detaching are still drained below
+		const bool bDetached = bProducerDetached.load(std::memory_order_acquire);
+
+		int32 ChunkIndex = INDEX_NONE;
+		while (FullChunks.Pop(ChunkIndex))
+		{
+			WriteChunk(ChunkIndex);
+			FreeChunks.Push(ChunkIndex);
+		}
+
+		if (bDetached)
+		{
+			break;
+		}
+
+		WakeEvent->Wait(100);
+	}
+
+	return 0;
+}
+
+void FVRPNCaptureWriter::WriteChunk(int32 ChunkIndex)
+{
+	const uint8* ChunkData = Chunks[ChunkIndex].GetData();
+	const int32 Used = ChunkUsed[ChunkIndex];
+
+	// Index the records before writing so the offsets are their final file offsets
+	for (int32 Offset = 0; Offset < Used;)
+	{
+		VRPNCapture::FRecordHeader Header;
+		FMemory::Memcpy(&Header, ChunkData + Offset, sizeof(Header));
+		if (Index.Num() == 0 || Header.ReceiveTime >= NextIndexTime)
+		{
+			Index.Add({ Header.ReceiveTime, FileOffset + Offset });
+			NextIndexTime = Header.ReceiveTime + VRPNCapture::IndexIntervalSeconds;
+		}
+		Offset += static_cast<int32>(VRPNCapture::GetRecordSize(Header.Size));
+		++NumWrittenRecords;
+	}
+
+	File->Write(ChunkData, Used);
+	FileOffset += Used;
+}
+
+void FVRPNCaptureWriter::Finish()
+{
+	if (WriterThread == nullptr)
+	{
+		return;
+	}
+
+	// The writer thread drains the remaining chunks and exits once the producer has detached
+	check(IsProducerDetached() || IsStopRequested());
+	WakeEvent->Trigger();
+	WriterThread->WaitForCompletion();
+	delete WriterThread;
+	WriterThread = nullptr;
+
+	VRPNCapture::FTrailer Trailer;
+	Trailer.IndexOffset = FileOffset;
+	Trailer.NumIndexEntries = Index.Num();
+	Trailer.NumRecords = NumWrittenRecords;
+	FMemory::Memcpy(Trailer.Magic, VRPNCapture::TrailerMagic, sizeof(Trailer.Magic));
+
+	File->Write(reinterpret_cast<const uint8*>(Index.GetData()), Index.Num() * sizeof(VRPNCapture::FIndexEntry));
+	File->Write(reinterpret_cast<const uint8*>(&Trailer), sizeof(Trailer));
+	File->Flush();
+	delete File;
+	File = nullptr;
+
+	UE_LOG(LogVRPN, Log, TEXT("Capture %s closed (%llu datagrams, %llu dropped)"), *Path, NumWrittenRecords, GetNumDropped());
+}
+
+FVRPNCaptureReplayReceiver::FVRPNCaptureReplayReceiver(const FString& InPath, double InPlaybackRate, bool bInLoop)
+	: Path(InPath)
+	, PlaybackRate(FMath::Max(InPlaybackRate, 0.0))
+	, bLoop(bInLoop)
+	, Data(nullptr)
+	, DataStart(0)
+	, DataEnd(0)
+	, FirstRecordTime(0.0)
+	, LastRecordTime(0.0)
+	, Cursor(0)
+	, PlaybackStart(-1.0)
+	, PlaybackOrigin(0.0)
+	, PendingSeek(-1.0)
+	, TimelineVersion(0)
+	, LastError(SE_NO_ERROR)
+{
+}
+
+FVRPNCaptureReplayReceiver::~FVRPNCaptureReplayReceiver()
+{
+	Close();
+}
+
+bool FVRPNCaptureReplayReceiver::Open(int32 LocalPort, int32 ReceiveBufferSize)
+{
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!MappedFile.IsValid())
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Failed to open capture file %s"), *Path);
+		return false;
+	}
+
+	const int64 FileSize = MappedFile->GetFileSize();
+	if (FileSize < static_cast<int64>(sizeof(VRPNCapture::FFileHeader)))
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Capture file %s is empty"), *Path);
+		Close();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, FileSize));
+	if (!MappedRegion.IsValid())
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Failed to map capture file %s"), *Path);
+		Close();
+		return false;
+	}
+	Data = MappedRegion->GetMappedPtr();
+
+	const VRPNCapture::FFileHeader& Header = *reinterpret_cast<const VRPNCapture::FFileHeader*>(Data);
+	if (FMemory::Memcmp(Header.Magic, VRPNCapture::FileMagic, sizeof(Header.Magic)) != 0 || Header.Version != VRPNCapture::Version)
+	{
+		UE_LOG(LogVRPN, Error, TEXT("%s is not a VRPN capture (or an unsupported version)"), *Path);
+		Close();
+		return false;
+	}
+	if (Header.HeaderSize < sizeof(VRPNCapture::FFileHeader) || Header.HeaderSize % 8 != 0 || Header.HeaderSize > static_cast<uint64>(FileSize))
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Capture %s has a corrupt header"), *Path);
+		Close();
+		return false;
+	}
+	DataStart = Header.HeaderSize;
+	DataEnd = FileSize;
+
+	// A closed capture carries its index in a trailer; otherwise rebuild it from the records
+	bool bHasTrailer = false;
+	if (FileSize >= DataStart + static_cast<int64>(sizeof(VRPNCapture::FTrailer)))
+	{
+		const VRPNCapture::FTrailer& Trailer = *reinterpret_cast<const VRPNCapture::FTrailer*>(Data + FileSize - sizeof(VRPNCapture::FTrailer));
+		const uint64 MaxIndexEntries = static_cast<uint64>(FileSize) / sizeof(VRPNCapture::FIndexEntry);
+		bHasTrailer = FMemory::Memcmp(Trailer.Magic, VRPNCapture::TrailerMagic, sizeof(Trailer.Magic)) == 0
+			&& Trailer.NumIndexEntries <= FMath::Min<uint64>(MaxIndexEntries, MAX_int32)
+			&& Trailer.IndexOffset >= static_cast<uint64>(DataStart)
+			&& Trailer.IndexOffset % alignof(VRPNCapture::FIndexEntry) == 0
+			&& Trailer.IndexOffset + Trailer.NumIndexEntries * sizeof(VRPNCapture::FIndexEntry) + sizeof(VRPNCapture::FTrailer) == static_cast<uint64>(FileSize);
+		if (bHasTrailer)
+		{
+			DataEnd = Trailer.IndexOffset;
+			Index = MakeArrayView(reinterpret_cast<const VRPNCapture::FIndexEntry*>(Data + Trailer.IndexOffset), static_cast<int32>(Trailer.NumIndexEntries));
+
+			// The index is trusted only as far as it points at whole records; records themselves are checked as they play
+			if (!IsIndexValid())
+			{
+				UE_LOG(LogVRPN, Warning, TEXT("Capture %s has a corrupt seek index"), *Path);
+				DataEnd = FileSize;
+				Index = TConstArrayView<VRPNCapture::FIndexEntry>();
+				bHasTrailer = false;
+			}
+		}
+	}
+
+	if (!bHasTrailer)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Capture %s was not closed cleanly; rebuilding its index"), *Path);
+		ScanRecords();
+	}
+
+	if (Index.Num() == 0)
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Capture %s holds no datagrams"), *Path);
+		Close();
+		return false;
+	}
+
+	FirstRecordTime = RecordAt(Index[0].Offset).ReceiveTime;
+	LastRecordTime = Index.Last().ReceiveTime;
+	Cursor = DataStart;
+	PlaybackStart = -1.0;
+
+	UE_LOG(LogVRPN, Log, TEXT("Replaying %s (%.1f s) at %s"), *Path, GetDuration(),
+		PlaybackRate > 0.0 ? *FString::Printf(TEXT("%.2fx"), PlaybackRate) : TEXT("maximum speed"));
+	return true;
+}
+
+bool FVRPNCaptureReplayReceiver::IsRecordInBounds(int64 Offset) const
+{
+	// Records are 8-byte aligned from the data start, which keeps their headers aligned
+	if (Offset < DataStart || (Offset - DataStart) % 8 != 0 || Offset + static_cast<int64>(sizeof(VRPNCapture::FRecordHeader)) > DataEnd)
+	{
+		return false;
+	}
+	return Offset + VRPNCapture::GetRecordSize(RecordAt(Offset).Size) <= DataEnd;
+}
+
+bool FVRPNCaptureReplayReceiver::IsIndexValid() const
+{
+	for (const VRPNCapture::FIndexEntry& Entry : Index)
+	{
+		if (Entry.Offset > static_cast<uint64>(DataEnd) || !IsRecordInBounds(static_cast<int64>(Entry.Offset)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FVRPNCaptureReplayReceiver::CheckCursor()
+{
+	if (Cursor >= DataEnd)
+	{
+		return false;
+	}
+	if (!IsRecordInBounds(Cursor))
+	{
+		// Nothing after a corrupt size can be trusted to be a record boundary
+		UE_LOG(LogVRPN, Warning, TEXT("Capture %s has a corrupt record at offset %lld; the rest is skipped"), *Path, Cursor);
+		Counters.Malformed.fetch_add(1, std::memory_order_relaxed);
+		Cursor = DataEnd;
+		return false;
+	}
+	return true;
+}
+
+void FVRPNCaptureReplayReceiver::ScanRecords()
+{
+	ScannedIndex.Reset();
+	double NextIndexTime = 0.0;
+	int64 Offset = DataStart;
+	while (Offset < DataEnd)
+	{
+		if (!IsRecordInBounds(Offset))
+		{
+			break;
+		}
+		const VRPNCapture::FRecordHeader& Header = RecordAt(Offset);
+		const int64 RecordSize = VRPNCapture::GetRecordSize(Header.Size);
+
+		if (ScannedIndex.Num() == 0 || Header.ReceiveTime >= NextIndexTime)
+		{
+			ScannedIndex.Add({ Header.ReceiveTime, static_cast<uint64>(Offset) });
+			NextIndexTime = Header.ReceiveTime + VRPNCapture::IndexIntervalSeconds;
+		}
+		Offset += RecordSize;
+	}
+
+	// Anything after the last whole record was cut off mid-write (or is corrupt)
+	DataEnd = Offset;
+	Index = ScannedIndex;
+}
+
+void FVRPNCaptureReplayReceiver::Close()
+{
+	Index = TConstArrayView<VRPNCapture::FIndexEntry>();
+	ScannedIndex.Empty();
+	Data = nullptr;
+	DataStart = 0;
+	DataEnd = 0;
+	Cursor = 0;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+void FVRPNCaptureReplayReceiver::PrepareCursor()
+{
+	const double SeekTime = PendingSeek.exchange(-1.0, std::memory_order_acquire);
+	if (SeekTime >= 0.0)
+	{
+		// Last index entry at or before the target, then walk forward to the exact record
+		const double Target = FirstRecordTime + SeekTime;
+		int32 Low = 0;
+		int32 High = Index.Num() - 1;
+		while (Low < High)
+		{
+			const int32 Mid = (Low + High + 1) / 2;
+			if (Index[Mid].ReceiveTime <= Target)
+			{
+				Low = Mid;
+			}
+			else
+			{
+				High = Mid - 1;
+			}
+		}
+
+		Cursor = static_cast<int64>(Index[Low].Offset);
+		while (CheckCursor() && RecordAt(Cursor).ReceiveTime < Target)
+		{
+			Cursor += VRPNCapture::GetRecordSize(RecordAt(Cursor).Size);
+		}
+		PlaybackStart = -1.0;
+		++TimelineVersion;
+	}
+
+	if (Cursor >= DataEnd && bLoop)
+	{
+		Cursor = DataStart;
+		PlaybackStart = -1.0;
+		++TimelineVersion;
+	}
+
+	if (PlaybackStart < 0.0 && CheckCursor())
+	{
+		PlaybackStart = FPlatformTime::Seconds();
+		PlaybackOrigin = RecordAt(Cursor).ReceiveTime;
+	}
+}
+
+bool FVRPNCaptureReplayReceiver::Wait(const FTimespan& Timeout)
+{
+	if (Data == nullptr)
+	{
+		return false;
+	}
+
+	PrepareCursor();
+	if (!CheckCursor())
+	{
+		// End of a non-looping capture: behave like an idle socket
+		FPlatformProcess::Sleep(static_cast<float>(Timeout.GetTotalSeconds()));
+		return false;
+	}
+
+	if (PlaybackRate <= 0.0)
+	{
+		return true;
+	}
+
+	const double Remaining = GetPlayoutTime(RecordAt(Cursor).ReceiveTime) - FPlatformTime::Seconds();
+	if (Remaining > 0.0)
+	{
+		FPlatformProcess::Sleep(static_cast<float>(FMath::Min(Remaining, Timeout.GetTotalSeconds())));
+	}
+	return Remaining <= Timeout.GetTotalSeconds();
+}
+
+int32 FVRPNCaptureReplayReceiver::ReceiveBatch(FVRPNDatagramBatch& Batch)
+{
+	Batch.Num = 0;
+	LastError = SE_EWOULDBLOCK;
+	if (Data == nullptr)
+	{
+		return 0;
+	}
+
+	PrepareCursor();
+
+	const double Now = FPlatformTime::Seconds();
+	double BatchRecordTime = 0.0;
+	uint64 NumBytes = 0;
+	while (Batch.Num < Batch.GetMaxDatagrams() && CheckCursor())
+	{
+		const VRPNCapture::FRecordHeader& Header = RecordAt(Cursor);
+		if (PlaybackRate > 0.0)
+		{
+			// Keep the original receive batching and timing: one recorded receive call per batch, none before it is due
+			const double PlayoutTime = GetPlayoutTime(Header.ReceiveTime);
+			if (PlayoutTime > Now || (Batch.Num > 0 && Header.ReceiveTime != BatchRecordTime))
+			{
+				break;
+			}
+			Batch.ReceiveTime = PlayoutTime;
+			BatchRecordTime = Header.ReceiveTime;
+		}
+		else
+		{
+			Batch.ReceiveTime = Now;
+		}
+
+		const int32 CopySize = static_cast<int32>(FMath::Min<uint32>(Header.Size, static_cast<uint32>(Batch.GetMaxDatagramSize())));
+		if (static_cast<uint32>(CopySize) < Header.Size)
+		{
+			Counters.Truncated.fetch_add(1, std::memory_order_relaxed);
+		}
+		FMemory::Memcpy(Batch.GetBuffer(Batch.Num), Data + Cursor + sizeof(VRPNCapture::FRecordHeader), CopySize);
+		Batch.Sizes[Batch.Num++] = CopySize;
+		NumBytes += CopySize;
+
+		Cursor += VRPNCapture::GetRecordSize(Header.Size);
+	}
+
+	if (Batch.Num > 0)
+	{
+		LastError = SE_NO_ERROR;
+		Counters.ReceiveCalls.fetch_add(1, std::memory_order_relaxed);
+		Counters.Datagrams.fetch_add(Batch.Num, std::memory_order_relaxed);
+		Counters.Bytes.fetch_add(NumBytes, std::memory_order_relaxed);
+	}
+	return Batch.Num;
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "VRPNDatagramReceiver.h"
+#include "VRPNSpscQueue.h"
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * On-disk layout of a VRPN capture (.vrpncap)
+ *
+ * [FFileHeader][FRecordHeader payload pad]...[FIndexEntry x N][FTrailer]
+ *
+ * Records hold raw datagrams exactly as received, each padded to 8 bytes. The writer appends a
+ * seek index entry roughly every IndexIntervalSeconds of capture and writes the index and trailer
+ * when the capture is closed; a capture cut short (crash, power loss) has no trailer and is
+ * re-indexed by scanning its records. All fields are little-endian.
+ */
+namespace VRPNCapture
+{
+	static constexpr uint8 FileMagic[8] = { 'V', 'R', 'P', 'N', 'C', 'A', 'P', '1' };
+	static constexpr uint8 TrailerMagic[8] = { 'V', 'R', 'P', 'N', 'I', 'D', 'X', '1' };
+	static constexpr uint32 Version = 1;
+
+	/** Capture time between seek index entries (seconds) */
+	static constexpr double IndexIntervalSeconds = 0.25;
+
+	struct FFileHeader
+	{
+		uint8 Magic[8];
+		uint32 Version;
+		uint32 HeaderSize;
+	};
+
+	struct FRecordHeader
+	{
+		/** Datagram size in bytes (payload follows, padded to 8) */
+		uint32 Size;
+		uint32 Reserved;
+
+		/** Local receive time (FPlatformTime::Seconds on the recording machine) */
+		double ReceiveTime;
+	};
+
+	struct FIndexEntry
+	{
+		double ReceiveTime;
+
+		/** File offset of the first record at or after ReceiveTime */
+		uint64 Offset;
+	};
+
+	struct FTrailer
+	{
+		uint64 IndexOffset;
+		uint64 NumIndexEntries;
+		uint64 NumRecords;
+		uint8 Magic[8];
+	};
+
+	/** Bytes a record of a given datagram size occupies */
+	inline int64 GetRecordSize(uint32 DatagramSize) { return Align(static_cast<int64>(sizeof(FRecordHeader)) + DatagramSize, 8); }
+}
+
+/**
+ * Recorder tap for the receive thread
+ *
+ * Record() copies datagrams into preallocated chunks and hands full chunks to a writer thread
+ * through a lock-free queue; the receive thread never allocates, never touches the file and never
+ * waits. If the writer falls behind and no free chunk is left, datagrams are dropped and counted.
+ */
+class FVRPNCaptureWriter : public FRunnable
+{
+public:
+	FVRPNCaptureWriter();
+	virtual ~FVRPNCaptureWriter();
+
+	/**
+	 * Create the file and start the writer thread (game thread)
+	 * @param ChunkSize Bytes per chunk
+	 * @param NumChunks Chunks in the pool; their total is how much backlog the writer may accumulate
+	 */
+	bool Open(const FString& InPath, int32 ChunkSize = 256 * 1024, int32 NumChunks = 16);
+
+	/** Append every datagram of a batch (receive thread) */
+	void Record(const FVRPNDatagramBatch& Batch);
+
+	/**
+	 * Periodic upkeep on the receive thread: hands over partly filled chunks so the file stays
+	 * current, and detaches once a stop was requested
+	 * @return false once detached; the caller must not touch the writer afterwards
+	 */
+	bool Poll(double Now);
+
+	/** Ask the producer to detach at its next Poll() (any thread) */
+	void RequestStop() { bStopRequested.store(true, std::memory_order_release); }
+
+	/** True once RequestStop() was called */
+	bool IsStopRequested() const { return bStopRequested.load(std::memory_order_acquire); }
+
+	/**
+	 * Submit the partly filled chunk and stop producing
+	 * Called by the producer, or by the owner once no producer is running
+	 */
+	void DetachProducer();
+
+	/** True once the producer detached */
+	bool IsProducerDetached() const { return bProducerDetached.load(std::memory_order_acquire); }
+
+	/**
+	 * Wait for the writer to flush everything, then write the index and trailer and close the file
+	 * Blocks until the producer has detached, so call it after DetachProducer() or RequestStop(); any single thread
+	 */
+	void Finish();
+
+	/** Datagrams written to chunks */
+	uint64 GetNumRecorded() const { return NumRecorded.load(std::memory_order_relaxed); }
+
+	/** Datagrams dropped because no chunk was free */
+	uint64 GetNumDropped() const { return NumDropped.load(std::memory_order_relaxed); }
+
+	const FString& GetPath() const { return Path; }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+
+private:
+	/** Hand the current chunk to the writer thread (producer) */
+	void SubmitChunk();
+
+	/** Write one chunk to the file and index its records (writer thread) */
+	void WriteChunk(int32 ChunkIndex);
+
+	/** Longest a partly filled chunk waits before it is handed to the writer */
+	static constexpr double FlushIntervalSeconds = 0.5;
+
+	FString Path;
+	IFileHandle* File;
+	FRunnableThread* WriterThread;
+	FEvent* WakeEvent;
+
+	/** Chunk pool: storage and bytes used per chunk */
+	TArray<TArray<uint8>> Chunks;
+	TArray<int32> ChunkUsed;
+	int32 ChunkSize;
+
+	/** Chunks ready to write (producer -> writer) and chunks ready to fill (writer -> producer) */
+	TVRPNSpscQueue<int32> FullChunks;
+	TVRPNSpscQueue<int32> FreeChunks;
+
+	/** Producer state */
+	int32 CurrentChunk;
+	double ChunkStartTime;
+
+	/** Writer state */
+	uint64 FileOffset;
+	double NextIndexTime;
+	uint64 NumWrittenRecords;
+	TArray<VRPNCapture::FIndexEntry> Index;
+
+	std::atomic<bool> bStopRequested;
+	std::atomic<bool> bProducerDetached;
+	std::atomic<uint64> NumRecorded;
+	std::atomic<uint64> NumDropped;
+};
+
+/**
+ * Receive backend that replays a capture file instead of reading a socket
+ *
+ * The file is memory-mapped and its datagrams are fed through the same parse and dispatch path
+ * as live data, preserving the original receive batching. Playback runs at real time scaled by
+ * PlaybackRate, or as fast as the pipeline consumes it when PlaybackRate is 0.
+ */
+class FVRPNCaptureReplayReceiver : public FVRPNDatagramReceiver
+{
+public:
+	/**
+	 * @param InPath Capture file
+	 * @param InPlaybackRate 1 = real time, N = N times faster, 0 = as fast as possible
+	 * @param bInLoop Restart from the beginning at the end of the capture
+	 */
+	FVRPNCaptureReplayReceiver(const FString& InPath, double InPlaybackRate, bool bInLoop);
+	virtual ~FVRPNCaptureReplayReceiver();
+
+	/** Maps the file; the port and buffer size are ignored */
+	virtual bool Open(int32 LocalPort, int32 ReceiveBufferSize) override;
+	virtual void Close() override;
+	virtual bool Wait(const FTimespan& Timeout) override;
+	virtual int32 ReceiveBatch(FVRPNDatagramBatch& Batch) override;
+	virtual ESocketErrors GetLastError() const override { return LastError; }
+	virtual int32 GetLocalPort() const override { return 0; }
+	virtual const TCHAR* GetName() const override { return TEXT("replay"); }
+
+	/**
+	 * Jump to a time in the capture (any thread; applied before the next batch)
+	 * @param Time Seconds from the start of the capture
+	 */
+	void Seek(double Time) { PendingSeek.store(Time, std::memory_order_release); }
+
+	/** Capture length in seconds */
+	double GetDuration() const { return LastRecordTime - FirstRecordTime; }
+
+	/** True once a non-looping replay has delivered every datagram */
+	bool IsFinished() const { return !bLoop && Cursor >= DataEnd; }
+
+	/**
+	 * Bumped whenever playback jumps back or forth in the recorded timeline (seek or loop) (receive thread)
+	 * Server timestamps after a change do not continue the ones before it.
+	 */
+	uint32 GetTimelineVersion() const { return TimelineVersion; }
+
+private:
+	/** Record header at the cursor */
+	const VRPNCapture::FRecordHeader& RecordAt(int64 Offset) const { return *reinterpret_cast<const VRPNCapture::FRecordHeader*>(Data + Offset); }
+
+	/** Local time a recorded receive time plays out at */
+	double GetPlayoutTime(double RecordTime) const { return PlaybackStart + (RecordTime - PlaybackOrigin) / PlaybackRate; }
+
+	/** True if a whole record starts at Offset inside the data section */
+	bool IsRecordInBounds(int64 Offset) const;
+
+	/** True if the trailer's seek index points at records inside the data section */
+	bool IsIndexValid() const;
+
+	/**
+	 * Check the record at the cursor; a corrupt one ends the data (counted as malformed) (receive thread)
+	 * @return false if the cursor is at the end of the data
+	 */
+	bool CheckCursor();
+
+	/** Build the seek index by walking every record (capture without a trailer) */
+	void ScanRecords();
+
+	/** Apply a pending seek, restart a loop, and start the playback clock */
+	void PrepareCursor();
+
+	FString Path;
+	double PlaybackRate;
+	bool bLoop;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const uint8* Data;
+	int64 DataStart;
+	int64 DataEnd;
+
+	/** Seek index, pointing into the mapping when the capture has a trailer */
+	TConstArrayView<VRPNCapture::FIndexEntry> Index;
+	TArray<VRPNCapture::FIndexEntry> ScannedIndex;
+
+	double FirstRecordTime;
+	double LastRecordTime;
+
+	/** Playback position (receive thread) */
+	int64 Cursor;
+	double PlaybackStart;
+	double PlaybackOrigin;
+
+	/** Seek target in seconds from the start, negative if none */
+	std::atomic<double> PendingSeek;
+
+	/** See GetTimelineVersion() */
+	uint32 TimelineVersion;
+
+	ESocketErrors LastError;
+};
@@ -0,0 +1,169 @@
+#include "VRPNClockSync.h"
+
+FVRPNClockSync::FVRPNClockSync()
+	: MinRoundTrip(-1.0)
+{
+	Reset();
+}
+
+void FVRPNClockSync::Reset()
+{
+	bHasReference = false;
+	RefServerTime = 0.0;
+	Intercept = 0.0;
+	Slope = 0.0;
+	MeanLatency = 0.0;
+	LatencyJitter = 0.0;
+	NumSamples = 0;
+	CurrentBucket = -1;
+	CurrentMinX = 0.0;
+	CurrentMinY = TNumericLimits<double>::Max();
+	NumFilledBuckets = 0;
+	NextBucket = 0;
+	MinRoundTrip.store(-1.0, std::memory_order_relaxed);
+}
+
+void FVRPNClockSync::AddSample(double ServerTime, double LocalReceiveTime)
+{
+	const double Difference = LocalReceiveTime - ServerTime;
+	if (!bHasReference)
+	{
+		bHasReference = true;
+		RefServerTime = ServerTime;
+		Intercept = Difference;
+		Slope = 0.0;
+	}
+
+	const double RelativeTime = ServerTime - RefServerTime;
+	const int64 Bucket = FMath::FloorToInt64(RelativeTime / BucketSeconds);
+	if (Bucket < CurrentBucket)
+	{
+		// A reordered or late packet must not reopen a closed bucket and discard the running minimum; only a jump
+		// back past the whole fit window is a restarted server clock, which starts the model over
+		if (CurrentBucket - Bucket <= NumBuckets)
+		{
+			return;
+		}
+		Reset();
+		AddSample(ServerTime, LocalReceiveTime);
+		return;
+	}
+	if (Bucket != CurrentBucket)
+	{
+		if (CurrentBucket >= 0 && CurrentMinY < TNumericLimits<double>::Max())
+		{
+			BucketX[NextBucket] = CurrentMinX;
+			BucketY[NextBucket] = CurrentMinY;
+			NextBucket = (NextBucket + 1) % NumBuckets;
+			NumFilledBuckets = FMath::Min(NumFilledBuckets + 1, NumBuckets);
+			Refit();
+		}
+		CurrentBucket = Bucket;
+		CurrentMinY = TNumericLimits<double>::Max();
+	}
+
+	if (Difference < CurrentMinY)
+	{
+		CurrentMinX = RelativeTime;
+		CurrentMinY = Difference;
+	}
+
+	// The envelope must stay a lower bound; a faster-than-ever packet pulls it down immediately
+	const double Predicted = Envelope(RelativeTime);
+	if (Difference < Predicted)
+	{
+		Intercept -= Predicted - Difference;
+	}
+
+	const double Latency = LocalReceiveTime - ServerToLocal(ServerTime);
+	if (NumSamples == 0)
+	{
+		MeanLatency = Latency;
+	}
+	MeanLatency += (Latency - MeanLatency) / 16.0;
+	LatencyJitter += (FMath::Abs(Latency - MeanLatency) - LatencyJitter) / 16.0;
+	++NumSamples;
+
+	FVRPNClockEstimate Estimate;
+	Estimate.Offset = Envelope(RelativeTime) - GetMinOneWayDelay();
+	Estimate.Drift = Slope;
+	Estimate.Latency = MeanLatency;
+	Estimate.Jitter = LatencyJitter;
+	Estimate.RoundTrip = MinRoundTrip.load(std::memory_order_relaxed);
+	Estimate.NumSamples = NumSamples;
+	Published.Write(Estimate);
+}
+
+void FVRPNClockSync::AddRoundTrip(double LocalSendTime, double LocalReceiveTime)
+{
+	const double RoundTrip = LocalReceiveTime - LocalSendTime;
+	if (RoundTrip < 0.0)
+	{
+		return;
+	}
+
+	double Current = MinRoundTrip.load(std::memory_order_relaxed);
+	while ((Current < 0.0 || RoundTrip < Current)
+		&& !MinRoundTrip.compare_exchange_weak(Current, RoundTrip, std::memory_order_relaxed))
+	{
+	}
+}
+
+double FVRPNClockSync::ServerToLocal(double ServerTime) const
+{
+	if (!bHasReference)
+	{
+		return ServerTime;
+	}
+
+	const double RelativeTime = ServerTime - RefServerTime;
+	return ServerTime + Envelope(RelativeTime) - GetMinOneWayDelay();
+}
+
+bool FVRPNClockSync::GetEstimate(FVRPNClockEstimate& OutEstimate) const
+{
+	return Published.Read(OutEstimate);
+}
+
+double FVRPNClockSync::GetMinOneWayDelay() const
+{
+	const double RoundTrip = MinRoundTrip.load(std::memory_order_relaxed);
+	return RoundTrip > 0.0 ? RoundTrip * 0.5 : 0.0;
+}
+
+void FVRPNClockSync::Refit()
+{
+	if (NumFilledBuckets < 2)
+	{
+		return;
+	}
+
+	double SumX = 0.0;
+	double SumY = 0.0;
+	for (int32 Index = 0; Index < NumFilledBuckets; ++Index)
+	{
+		SumX += BucketX[Index];
+		SumY += BucketY[Index];
+	}
+	const double MeanX = SumX / NumFilledBuckets;
+	const double MeanY = SumY / NumFilledBuckets;
+
+	double Covariance = 0.0;
+	double Variance = 0.0;
+	for (int32 Index = 0; Index < NumFilledBuckets; ++Index)
+	{
+		const double DeltaX = BucketX[Index] - MeanX;
+		Covariance += DeltaX * (BucketY[Index] - MeanY);
+		Variance += DeltaX * DeltaX;
+	}
+
+	Slope = Variance > 0.0 ? Covariance / Variance : 0.0;
+
+	// Shift the fitted line down so it lies under every bucket minimum
+	double LowestResidual = 0.0;
+	for (int32 Index = 0; Index < NumFilledBuckets; ++Index)
+	{
+		LowestResidual = FMath::Min(LowestResidual, BucketY[Index] - (MeanY + Slope * (BucketX[Index] - MeanX)));
+	}
+	Intercept = MeanY - Slope * MeanX + LowestResidual;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPNSeqLock.h"
+#include <atomic>
+
+/**
+ * Snapshot of the server-to-local clock model and link timing
+ */
+struct FVRPNClockEstimate
+{
+	/** Local minus server time at the newest sample, excluding the minimum one-way delay when it is known (seconds) */
+	double Offset = 0.0;
+
+	/** Rate of change of the offset per second of server time (drift) */
+	double Drift = 0.0;
+
+	/** Smoothed one-way latency from server timestamp to local receive (seconds) */
+	double Latency = 0.0;
+
+	/** Smoothed mean deviation of the one-way latency (seconds) */
+	double Jitter = 0.0;
+
+	/** Smallest round-trip time measured by probes (seconds), negative if no probe has completed */
+	double RoundTrip = -1.0;
+
+	/** Number of timestamps that contributed to the estimate */
+	int64 NumSamples = 0;
+};
+
+/**
+ * Online estimator of clock offset and drift between a VRPN server and the local monotonic clock
+ *
+ * Every received report contributes (server timestamp, local receive time). The lower envelope of
+ * local-minus-server over one-second buckets removes queueing delay; a least-squares line through
+ * the bucket minima gives offset and drift. One-way transit cannot be separated from offset with
+ * one-way data alone, so until a round-trip probe completes the minimum one-way delay is treated as
+ * zero and Latency reports delay in excess of it. Once probes arrive, half the smallest round trip
+ * is taken as the minimum one-way delay.
+ *
+ * AddSample/ServerToLocal belong to the receive thread; AddRoundTrip may be called from the
+ * control thread; GetEstimate is safe from any thread.
+ */
+class FVRPNClockSync
+{
+public:
+	FVRPNClockSync();
+
+	/** Forget all history (receive thread, or before it starts) */
+	void Reset();
+
+	/**
+	 * Add one server timestamp and the local time it was received (receive thread)
+	 * Samples older than the bucket being filled are ignored; one older than the whole fit window restarts the model
+	 */
+	void AddSample(double ServerTime, double LocalReceiveTime);
+
+	/**
+	 * Add a round-trip probe result (any single thread)
+	 * @param LocalSendTime Local time the probe was sent
+	 * @param LocalReceiveTime Local time the reply arrived
+	 */
+	void AddRoundTrip(double LocalSendTime, double LocalReceiveTime);
+
+	/**
+	 * Map a server timestamp onto the local clock (receive thread)
+	 * @return Local FPlatformTime::Seconds() at which the server time occurred
+	 */
+	double ServerToLocal(double ServerTime) const;
+
+	/**
+	 * Copy the latest estimate (any thread)
+	 * @return false if no sample has been added yet
+	 */
+	bool GetEstimate(FVRPNClockEstimate& OutEstimate) const;
+
+private:
+	/** Width of one lower-envelope bucket (seconds of server time) */
+	static constexpr double BucketSeconds = 1.0;
+
+	/** Buckets used for the drift fit */
+	static constexpr int32 NumBuckets = 60;
+
+	/** Offset plus minimum delay at a server time relative to RefServerTime */
+	double Envelope(double RelativeServerTime) const { return Intercept + Slope * RelativeServerTime; }
+
+	/** Minimum one-way delay implied by round-trip probes (0 if none) */
+	double GetMinOneWayDelay() const;
+
+	/** Refit the envelope line through the bucket minima */
+	void Refit();
+
+	/** Receive-thread model state */
+	bool bHasReference;
+	double RefServerTime;
+	double Intercept;
+	double Slope;
+	double MeanLatency;
+	double LatencyJitter;
+	int64 NumSamples;
+
+	/** Bucket being filled */
+	int64 CurrentBucket;
+	double CurrentMinX;
+	double CurrentMinY;
+
+	/** Completed bucket minima (ring) */
+	double BucketX[NumBuckets];
+	double BucketY[NumBuckets];
+	int32 NumFilledBuckets;
+	int32 NextBucket;
+
+	/** Smallest probe round trip (seconds), negative until one completes */
+	std::atomic<double> MinRoundTrip;
+
+	/** Published estimate */
+	TVRPNSeqLock<FVRPNClockEstimate> Published;
+};
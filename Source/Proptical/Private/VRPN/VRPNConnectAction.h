@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LatentActions.h"
+#include "VRPN/VRPNClient.h"
+
+/**
+ * Latent action behind UVRPNClient::ConnectToServerAndWait
+ *
+ * Polls the component once per frame until its connect attempt is streaming, has failed, or the
+ * timeout runs out. A later connect or disconnect on the component supersedes the attempt and
+ * finishes the action as failed.
+ */
+class FVRPNConnectAction : public FPendingLatentAction
+{
+public:
+	/**
+	 * @param InClient Component that started connecting
+	 * @param InResult Output pin selector of the Blueprint node
+	 * @param LatentInfo Node to resume
+	 * @param TimeoutSeconds Seconds to wait before finishing as timed out, 0 to wait forever
+	 */
+	FVRPNConnectAction(UVRPNClient* InClient, EVRPNConnectResult& InResult, const FLatentActionInfo& LatentInfo, float TimeoutSeconds)
+		: Client(InClient)
+		, ConnectSerial(InClient->ConnectSerial)
+		, Deadline(TimeoutSeconds > 0.0f ? FPlatformTime::Seconds() + TimeoutSeconds : 0.0)
+		, Result(InResult)
+		, ExecutionFunction(LatentInfo.ExecutionFunction)
+		, OutputLink(LatentInfo.Linkage)
+		, CallbackTarget(LatentInfo.CallbackTarget)
+	{
+	}
+
+	virtual void UpdateOperation(FLatentResponse& Response) override
+	{
+		const UVRPNClient* Target = Client.Get();
+		if (!Target || Target->ConnectSerial != ConnectSerial || Target->bConnectFailed)
+		{
+			Result = EVRPNConnectResult::Failed;
+		}
+		else if (!Target->bConnecting)
+		{
+			Result = EVRPNConnectResult::Connected;
+		}
+		else if (Deadline > 0.0 && FPlatformTime::Seconds() >= Deadline)
+		{
+			Result = EVRPNConnectResult::TimedOut;
+		}
+		else
+		{
+			return;
+		}
+
+		Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
+	}
+
+#if WITH_EDITOR
+	virtual FString GetDescription() const override
+	{
+		return FString::Printf(TEXT("Connecting to %s"), Client.IsValid() ? *Client->ServerAddress : TEXT("(gone)"));
+	}
+#endif
+
+private:
+	TWeakObjectPtr<UVRPNClient> Client;
+
+	/** UVRPNClient::ConnectSerial of the attempt this action waits for */
+	uint32 ConnectSerial;
+
+	/** Local time to give up at, 0 for never */
+	double Deadline;
+
+	EVRPNConnectResult& Result;
+	FName ExecutionFunction;
+	int32 OutputLink;
+	FWeakObjectPtr CallbackTarget;
+};
@@ -2,13 +2,113 @@
 #include "VRPNMessageParser.h"
 #include "Async/Async.h"
 #include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+TRACE_DECLARE_INT_COUNTER(VRPNQueueDepth, TEXT("VRPN/QueueDepth"));
+TRACE_DECLARE_INT_COUNTER(VRPNSamplesDrained, TEXT("VRPN/SamplesDrained"));
+TRACE_DECLARE_FLOAT_COUNTER(VRPNPacketAgeMax, TEXT("VRPN/PacketAgeMaxMs"));
 
 FVRPNConnectionManager::FVRPNConnectionManager()
 	: ReceiveThread(nullptr)
 	, bShouldStop(false)
 	, bIsConnected(false)
 	, ServerPort(3883)
+	, BoundUDPPort(0)
+	, bReceiverOpen(false)
+	, LastDataTime(0.0)
+	, NextReconnectTime(0.0)
+	, ReconnectBackoff(0.0)
+	, FirstPoseWaitStart(0.0)
+	, bLinkLost(false)
+	, PendingServerPort(0)
+	, bRetargetPending(false)
+	, bConnectionEventsPending(false)
+	, LocalUDPPort(0)
+	, bBatchedReceive(true)
+	, TransportMode(EVRPNTransportMode::UDP)
+	, RelayPort(3884)
+	, NextRelayNamesTime(0.0)
+	, ReplayRate(1.0)
+	, bReplayLoop(false)
+	, ReplayReceiver(nullptr)
+	, ReplayTimelineVersion(0)
+	, PendingRecorder(nullptr)
+	, ActiveRecorder(nullptr)
+	, FilterBank(SenderNames)
+	, ReceiveWaitMode(EVRPNReceiveWaitMode::Blocking)
+	, PoseHistoryBudget(DefaultPoseHistoryBudget)
+	, QueueOverflowPolicy(EVRPNQueueOverflowPolicy::DropOldest)
+	, NumDroppedUpdates(0)
+	, AgeWindowStart(0.0)
+	, PacketsPerSecond(0.0f)
+	, PacketAgeP50Ms(0.0f)
+	, PacketAgeP99Ms(0.0f)
+	, PacketAgeMaxMs(0.0f)
+	, WindowStartPackets(0)
+	, LastStatPackets(0)
+	, LastStatBytes(0)
+	, LastStatParseFailures(0)
+	, LastStatDropped(0)
+	, LastStatStale(0)
+	, LastQueueDepth(0)
+{
+	// Parse output is preallocated once so the receive thread never allocates per message
+	ParsedSamples.SetNumUninitialized(MaxSamplesPerDatagram);
+	SampleSensorIds.SetNumUninitialized(MaxSamplesPerDatagram);
+	SampleTimestamps.SetNumUninitialized(MaxSamplesPerDatagram);
+	SampleVelocities.SetNumUninitialized(MaxSamplesPerDatagram);
+	SampleAngularVelocities.SetNumUninitialized(MaxSamplesPerDatagram);
+	ParsedDerivatives.SetNumUninitialized(MaxSamplesPerDatagram);
+	UpdateQueue.Initialize(DefaultUpdateQueueCapacity);
+	SetSensorCapacity(DefaultSensorCapacity);
+}
+
+void FVRPNConnectionManager::SetSensorCapacity(int32 Capacity)
+{
+	if (ReceiveThread != nullptr)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Sensor capacity cannot be changed while receiving"));
+		return;
+	}
+
+	SensorTable.Initialize(Capacity);
+	const int32 NumSensors = SensorTable.Capacity();
+	OrderGuard.Initialize(NumSensors);
+	FilterBank.Initialize(NumSensors);
+	ServerMotion.Initialize(NumSensors);
+	PoseHistory.Initialize(NumSensors, PoseHistoryBudget);
+
+	// Everything indexed by sensor ID is sized here, never on the receive thread
+	CoalesceIndices.Init(INDEX_NONE, NumSensors);
+	DrainedUpdates.Reset(NumSensors);
+	SensorSnapshot.Positions.Reserve(NumSensors);
+	SensorSnapshot.Rotations.Reserve(NumSensors);
+	SensorSnapshot.Timestamps.Reserve(NumSensors);
+	SensorSnapshot.Velocities.Reserve(NumSensors);
+	SensorSnapshot.AngularVelocities.Reserve(NumSensors);
+	SensorSnapshot.Accelerations.Reserve(NumSensors);
+	SensorSnapshot.AngularAccelerations.Reserve(NumSensors);
+	SensorSnapshot.SenderIds.Reserve(NumSensors);
+	SensorSnapshot.SensorIndices.Reserve(NumSensors);
+
+	OverflowedSensors.SetNum((NumSensors + 31) / 32);
+	for (std::atomic<uint32>& Bits : OverflowedSensors)
+	{
+		Bits.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FVRPNConnectionManager::SetPoseHistoryBudget(int64 BudgetBytes)
 {
+	if (ReceiveThread != nullptr)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Pose history cannot be resized while receiving"));
+		return;
+	}
+
+	PoseHistoryBudget = FMath::Max<int64>(BudgetBytes, 0);
+	PoseHistory.Initialize(SensorTable.Capacity(), PoseHistoryBudget);
 }
 
 FVRPNConnectionManager::~FVRPNConnectionManager()
@@ -20,34 +120,107 @@ bool FVRPNConnectionManager::InitializeConnection(const FString& InServerAddress
 {
 	ServerAddress = InServerAddress;
 	ServerPort = InServerPort;
+	TrackerTypeIds.Reset();
+	SenderNames.Reset();
+
+	// Relaying is optional: a node that cannot publish still tracks for itself
+	Relay.Reset();
+	if (!RelayAddress.IsEmpty())
+	{
+		Relay = MakeUnique<FVRPNRelay>();
+		if (!Relay->Open(RelayAddress, RelayPort, RelayInterface))
+		{
+			UE_LOG(LogVRPN, Warning, TEXT("Relay to %s:%d could not be opened; poses are not relayed"), *RelayAddress, RelayPort);
+			Relay.Reset();
+		}
+	}
+
+	if (!ReplayPath.IsEmpty())
+	{
+		// Replaying a capture: no sockets at all, the datagrams come from the file
+		ReplayReceiver = new FVRPNCaptureReplayReceiver(ReplayPath, ReplayRate, bReplayLoop);
+		ReplayTimelineVersion = 0;
+		Receiver.Reset(ReplayReceiver);
+		if (!Receiver->Open(0, 0))
+		{
+			Receiver.Reset();
+			ReplayReceiver = nullptr;
+			return false;
+		}
+		ReceiveBatch.Initialize(MaxDatagramsPerBatch, MaxDatagramSize);
+		bReceiverOpen = true;
+		return true;
+	}
 
 	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
 	if (!SocketSubsystem)
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to get socket subsystem"));
+		UE_LOG(LogVRPN, Error, TEXT("Failed to get socket subsystem"));
 		return false;
 	}
 
+	if (!MulticastGroup.IsEmpty())
+	{
+		// Cluster peer: the group (or a relay) streams to a known port and there is no server to shake hands with
+		if (TransportMode == EVRPNTransportMode::TCPOnly)
+		{
+			UE_LOG(LogVRPN, Warning, TEXT("TCP-only transport does not apply to multicast reception and is ignored"));
+		}
+		if (LocalUDPPort == 0)
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Multicast reception needs a local UDP port (the group's port)"));
+			return false;
+		}
+
+		bool bGroupValid = false;
+		ServerAddr = SocketSubsystem->CreateInternetAddr();
+		ServerAddr->SetIp(*MulticastGroup, bGroupValid);
+		if (!bGroupValid)
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Invalid multicast group: %s"), *MulticastGroup);
+			return false;
+		}
+		ServerAddr->SetPort(LocalUDPPort);
+		ServerProtocolType = ServerAddr->GetProtocolType();
+		return SetupUDPSocket();
+	}
+
 	// Resolve server address
 	ServerAddr = SocketSubsystem->CreateInternetAddr();
 	bool bIsValid = false;
 	ServerAddr->SetIp(*ServerAddress, bIsValid);
 	if (!bIsValid)
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Invalid server address: %s"), *ServerAddress);
+		UE_LOG(LogVRPN, Error, TEXT("Invalid server address: %s"), *ServerAddress);
 		return false;
 	}
 	ServerAddr->SetPort(ServerPort);
+	ServerProtocolType = ServerAddr->GetProtocolType();
+
+	if (TransportMode == EVRPNTransportMode::TCPOnly)
+	{
+		// Tracker data arrives on the TCP stream, so the control channel doubles as the receive backend
+		ControlChannel = MakeUnique<FVRPNControlChannel>(ClockSync, TrackerTypeIds, SenderNames);
+		Receiver = MakeUnique<FVRPNTcpStreamReceiver>(*ControlChannel, ServerAddr.ToSharedRef());
+		if (!Receiver->Open(0, ReceiveBufferSize))
+		{
+			Receiver.Reset();
+			ControlChannel.Reset();
+			return false;
+		}
+		ReceiveBatch.Initialize(MaxDatagramsPerBatch, MaxDatagramSize);
+		bReceiverOpen = true;
+		return true;
+	}
 
 	// Setup UDP socket (primary for data reception)
 	if (!SetupUDPSocket())
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to setup UDP socket"));
+		UE_LOG(LogVRPN, Error, TEXT("Failed to setup UDP socket"));
 		return false;
 	}
 
-	// TCP handshake is low priority - may be deferred
-	// For now, we'll attempt it but won't fail if it doesn't work
+	// Servers without a TCP port may still stream UDP to us, so a failed handshake is not fatal
 	PerformTCPHandshake();
 
 	return true;
@@ -55,66 +228,94 @@ bool FVRPNConnectionManager::InitializeConnection(const FString& InServerAddress
 
 bool FVRPNConnectionManager::SetupUDPSocket()
 {
-	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
-	if (!SocketSubsystem)
+	// Create UDP receive backend (batched recvmmsg on Linux, FSocket elsewhere)
+	Receiver = FVRPNDatagramReceiver::Create(bBatchedReceive, ServerAddr->GetProtocolType());
+	if (Receiver.IsValid())
 	{
-		return false;
+		Receiver->SetMulticastGroup(MulticastGroup, MulticastInterface);
 	}
-
-	// Create UDP socket
-	FSocket* RawSocket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("VRPN_UDP"), ServerAddr->GetProtocolType());
-	UDPSocket = MakeShareable(RawSocket);
-	if (!UDPSocket)
+	if (!Receiver.IsValid() || !Receiver->Open(LocalUDPPort, ReceiveBufferSize))
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to create UDP socket"));
+		UE_LOG(LogVRPN, Error, TEXT("Failed to create UDP socket"));
+		Receiver.Reset();
 		return false;
 	}
 
-	// Set socket to non-blocking
-	UDPSocket->SetNonBlocking(true);
-
-	// Set receive buffer size
-	int32 ReceiveBufferSize = 1024 * 64; // 64KB
-	UDPSocket->SetReceiveBufferSize(ReceiveBufferSize, ReceiveBufferSize);
+	// Buffers for a whole batch are allocated once, up front
+	ReceiveBatch.Initialize(bBatchedReceive ? MaxDatagramsPerBatch : 1, MaxDatagramSize);
+	BoundUDPPort.store(Receiver->GetLocalPort(), std::memory_order_relaxed);
+	bReceiverOpen = true;
 
-	UE_LOG(LogTemp, Log, TEXT("VRPN: UDP socket created successfully"));
+	UE_LOG(LogVRPN, Log, TEXT("UDP socket created successfully (port %d, %s backend%s%s)"), Receiver->GetLocalPort(), Receiver->GetName(),
+		MulticastGroup.IsEmpty() ? TEXT("") : TEXT(", group "), *MulticastGroup);
 	return true;
 }
 
 bool FVRPNConnectionManager::PerformTCPHandshake()
 {
-	// TCP handshake is low priority for alpha
-	// This is a placeholder - full implementation deferred if needed
-	// For now, we'll focus on UDP data reception
-	
-	UE_LOG(LogTemp, Warning, TEXT("VRPN: TCP handshake not yet implemented (low priority)"));
-	return false;
+	// VRPN servers accept TCP on the same port number as UDP. Once they have our UDP port they
+	// send tracker messages there; descriptions and ping/pong stay on TCP. The connect itself is
+	// non-blocking and the rest of the handshake runs on the control channel's thread.
+	ControlChannel = MakeUnique<FVRPNControlChannel>(ClockSync, TrackerTypeIds, SenderNames);
+	if (!ControlChannel->Open(*ServerAddr, Receiver->GetLocalPort(), ControlReceiveBufferSize))
+	{
+		ControlChannel.Reset();
+		return false;
+	}
+	return true;
 }
 
 bool FVRPNConnectionManager::StartReceiving()
 {
 	if (ReceiveThread != nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("VRPN: Receive thread already running"));
+		UE_LOG(LogVRPN, Warning, TEXT("Receive thread already running"));
 		return false;
 	}
 
-	if (!UDPSocket.IsValid())
+	if (!Receiver.IsValid())
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: UDP socket not initialized"));
+		UE_LOG(LogVRPN, Error, TEXT("UDP socket not initialized"));
 		return false;
 	}
 
 	bShouldStop = false;
+	ClockSync.Reset();
+	OrderGuard.Reset();
+	PoseHistory.Reset();
+	ServerMotion.Reset();
+	NextRelayNamesTime = 0.0;
+
+	// The first connection is timed like a reconnect; the link is supervised from here on
+	const double Now = FPlatformTime::Seconds();
+	LastDataTime = Now;
+	ReconnectBackoff = ReconnectSettings.MinBackoff;
+	NextReconnectTime = Now + ReconnectBackoff;
+	FirstPoseWaitStart = Now;
+	bLinkLost = false;
+	bRetargetPending = false;
+
+	// In UDP mode control traffic gets a thread of its own, away from the receive loop.
+	// It starts first: once the receive thread runs, only that thread touches the channel.
+	const bool bControlThread = ControlChannel.IsValid() && TransportMode == EVRPNTransportMode::UDP;
+	if (bControlThread)
+	{
+		ControlChannel->StartThread();
+	}
+
 	ReceiveThread = FRunnableThread::Create(this, TEXT("VRPNConnectionManager"), 0, TPri_Normal);
 	
 	if (ReceiveThread == nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to create receive thread"));
+		UE_LOG(LogVRPN, Error, TEXT("Failed to create receive thread"));
+		if (bControlThread)
+		{
+			ControlChannel->StopThread();
+		}
 		return false;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("VRPN: Started receiving data on background thread"));
+	UE_LOG(LogVRPN, Log, TEXT("Started receiving data on background thread"));
 	return true;
 }
 
@@ -126,128 +327,947 @@ void FVRPNConnectionManager::StopReceiving()
 		ReceiveThread->WaitForCompletion();
 		delete ReceiveThread;
 		ReceiveThread = nullptr;
+
+		// A writer handed off by StopRecording() may still be waiting for the receive thread to let go of it
+		if (ActiveRecorder != nullptr && ActiveRecorder->IsStopRequested())
+		{
+			ActiveRecorder->DetachProducer();
+			ActiveRecorder = nullptr;
+		}
 	}
 
-	if (UDPSocket.IsValid())
+	if (ControlChannel.IsValid())
 	{
-		UDPSocket->Close();
-		UDPSocket.Reset();
+		ControlChannel->StopThread();
 	}
 
-	if (TCPSocket.IsValid())
+	// Finalize here rather than on a worker: the receive thread is gone and the file must be complete once this returns
+	if (TUniquePtr<FVRPNCaptureWriter> Writer = TakeRecorder())
 	{
-		TCPSocket->Close();
-		TCPSocket.Reset();
+		Writer->Finish();
 	}
 
+	if (Relay.IsValid())
+	{
+		Relay->Close();
+		UE_LOG(LogVRPN, Log, TEXT("Relayed %llu datagrams"), Relay->GetNumDatagramsSent());
+		Relay.Reset();
+	}
+
+	if (Receiver.IsValid())
+	{
+		const FVRPNReceiveCounters& Counters = Receiver->GetCounters();
+		const uint64 Calls = Counters.ReceiveCalls.load(std::memory_order_relaxed);
+		const uint64 Datagrams = Counters.Datagrams.load(std::memory_order_relaxed);
+		if (Datagrams > 0)
+		{
+			UE_LOG(LogVRPN, Log, TEXT("Received %llu datagrams in %llu receive calls (%.2f per call), %.2f us CPU per datagram"),
+				Datagrams, Calls, double(Datagrams) / double(FMath::Max<uint64>(Calls, 1)),
+				FPlatformTime::ToMilliseconds64(Counters.ProcessCycles.load(std::memory_order_relaxed)) * 1000.0 / double(Datagrams));
+		}
+
+		Receiver->Close();
+		Receiver.Reset();
+		ReplayReceiver = nullptr;
+	}
+	BoundUDPPort.store(0, std::memory_order_relaxed);
+	bReceiverOpen = false;
+
+	// Tells the server we are leaving
+	ControlChannel.Reset();
+
 	bIsConnected = false;
-	UE_LOG(LogTemp, Log, TEXT("VRPN: Stopped receiving data"));
+	UE_LOG(LogVRPN, Log, TEXT("Stopped receiving data"));
 }
 
 uint32 FVRPNConnectionManager::Run()
 {
-	const int32 BufferSize = 1024 * 64; // 64KB buffer
-	uint8* ReceiveBuffer = new uint8[BufferSize];
-	
-	FDateTime ConnectionStartTime = FDateTime::Now();
+	const FTimespan WaitTimeout = FTimespan::FromMilliseconds(StopCheckIntervalMs);
 
 	while (!bShouldStop)
 	{
-		if (!UDPSocket.IsValid())
+		if (!Receiver.IsValid())
 		{
 			FPlatformProcess::Sleep(0.01f); // 10ms sleep
 			continue;
 		}
 
-		// Receive UDP packet
-		int32 BytesRead = 0;
-		TSharedRef<FInternetAddr> FromAddr = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
-		
-		if (UDPSocket->RecvFrom(ReceiveBuffer, BufferSize, BytesRead, *FromAddr))
+		const double Now = FPlatformTime::Seconds();
+
+		// Pick up a recorder handed over by StartRecording(); Poll() flushes it and lets it detach on stop
+		if (FVRPNCaptureWriter* NewRecorder = PendingRecorder.exchange(nullptr, std::memory_order_acquire))
+		{
+			ActiveRecorder = NewRecorder;
+		}
+		if (ActiveRecorder != nullptr && !ActiveRecorder->Poll(Now))
+		{
+			ActiveRecorder = nullptr;
+		}
+
+		SuperviseLink(Now);
+		if (!bReceiverOpen)
+		{
+			// A reopen failed; wait for the next attempt without spinning on a closed socket
+			FPlatformProcess::Sleep(0.01f);
+			continue;
+		}
+
+		// Block in the kernel until a datagram arrives so it is handled immediately;
+		// the timeout only bounds how long Stop() takes to be noticed while idle
+		if (ReceiveWaitMode == EVRPNReceiveWaitMode::Blocking && !Receiver->Wait(WaitTimeout))
+		{
+			continue;
+		}
+
+		// Receive every datagram that is ready, a whole batch per call, before waiting again
+		while (!bShouldStop)
 		{
-			if (BytesRead > 0)
+			int32 NumReceived = 0;
 			{
-				if (!bIsConnected)
-				{
-					bIsConnected = true;
-					// Marshal connection established event to game thread
-					AsyncTask(ENamedThreads::GameThread, [this]()
-					{
-						OnConnectionEstablished.ExecuteIfBound();
-					});
-				}
+				VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Receive);
+				NumReceived = Receiver->ReceiveBatch(ReceiveBatch);
+			}
+			if (NumReceived <= 0)
+			{
+				break;
+			}
 
-				// Process received packet
-				ProcessUDPPacket(ReceiveBuffer, BytesRead);
+			LastDataTime = ReceiveBatch.ReceiveTime;
+			if (!bIsConnected)
+			{
+				bIsConnected = true;
+				ReconnectBackoff = ReconnectSettings.MinBackoff;
+				// Fired on the game thread at the owner's next DispatchConnectionEvents()
+				QueueConnectionEvent(true, FString());
 			}
+
+			// A replay that looped or seeked restarts the server's clock: fit it again and forget the old ordering and rates
+			if (ReplayReceiver != nullptr && ReplayReceiver->GetTimelineVersion() != ReplayTimelineVersion)
+			{
+				ReplayTimelineVersion = ReplayReceiver->GetTimelineVersion();
+				ClockSync.Reset();
+				OrderGuard.Reset();
+				ServerMotion.Reset();
+			}
+
+			if (ActiveRecorder != nullptr)
+			{
+				ActiveRecorder->Record(ReceiveBatch);
+			}
+
+			// Process received packets
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 DatagramIndex = 0; DatagramIndex < ReceiveBatch.Num; ++DatagramIndex)
+			{
+				ProcessUDPPacket(ReceiveBatch.GetBuffer(DatagramIndex), ReceiveBatch.Sizes[DatagramIndex], ReceiveBatch.ReceiveTime);
+			}
+			Receiver->GetCounters().ProcessCycles.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
 		}
-		else
+
+		// Check for connection errors
+		ESocketErrors ErrorCode = Receiver->GetLastError();
+		if (ErrorCode != SE_EWOULDBLOCK && ErrorCode != SE_NO_ERROR)
 		{
-			// Check for connection errors
-			ESocketErrors ErrorCode = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode();
-			if (ErrorCode != SE_EWOULDBLOCK)
+			PipelineCounters.ReceiveErrors.fetch_add(1, std::memory_order_relaxed);
+
+			// Check if we should warn about firewall/network configuration
+			const bool bFirewallHint = ErrorCode == SE_ECONNREFUSED || ErrorCode == SE_EACCES;
+
+			// A dead socket fails on every iteration; log at a bounded rate instead of flooding the log
+			uint32 NumSuppressed = 0;
+			if (ReceiveErrorLog.ShouldLog(FPlatformTime::Seconds(), NumSuppressed))
 			{
-				FString ErrorMsg = FString::Printf(TEXT("VRPN: UDP receive error: %d"), (int32)ErrorCode);
-				UE_LOG(LogTemp, Warning, TEXT("%s"), *ErrorMsg);
-				
-				// Check if we should warn about firewall/network configuration
-				if (ErrorCode == SE_ECONNREFUSED || ErrorCode == SE_EACCES)
+				UE_LOG(LogVRPN, Warning, TEXT("UDP receive error: %d (%u more since the last report)"), (int32)ErrorCode, NumSuppressed);
+				if (bFirewallHint)
 				{
-					ErrorMsg = TEXT("VRPN: UDP connection failed. Check firewall settings and ensure UDP port is open.");
-					UE_LOG(LogTemp, Error, TEXT("%s"), *ErrorMsg);
+					UE_LOG(LogVRPN, Error, TEXT("UDP connection failed. Check firewall settings and ensure UDP port is open."));
 				}
+			}
 
-				// Marshal connection lost event to game thread
-				AsyncTask(ENamedThreads::GameThread, [this, ErrorMsg]()
-				{
-					if (bIsConnected)
-					{
-						bIsConnected = false;
-						OnConnectionLost.ExecuteIfBound(ErrorMsg);
-					}
-				});
+			// The next SuperviseLink() reconnects once the backoff allows
+			if (bIsConnected)
+			{
+				ReportLinkLost(bFirewallHint
+					? FString(TEXT("VRPN: UDP connection failed. Check firewall settings and ensure UDP port is open."))
+					: FString::Printf(TEXT("VRPN: UDP receive error: %d"), (int32)ErrorCode));
 			}
 
-			// Small sleep to prevent busy-waiting
+			// Back off on hard errors so a broken socket does not spin
 			FPlatformProcess::Sleep(0.001f); // 1ms
 		}
+
+		// BusyPoll: go straight back to the socket without sleeping (dedicates a core to this thread)
 	}
 
-	delete[] ReceiveBuffer;
 	return 0;
 }
 
+void FVRPNConnectionManager::SuperviseLink(double Now)
+{
+	if (bRetargetPending.exchange(false, std::memory_order_acquire))
+	{
+		ApplyRetarget(Now);
+		return;
+	}
+
+	// A capture has no link to lose
+	if (ReplayReceiver != nullptr)
+	{
+		return;
+	}
+
+	if (bIsConnected)
+	{
+		// Trackers stream continuously, so silence means the server or the path to it is gone
+		const double Silence = Now - LastDataTime;
+		if (ReconnectSettings.LivenessTimeout <= 0.0 || Silence <= ReconnectSettings.LivenessTimeout)
+		{
+			return;
+		}
+		ReportLinkLost(FString::Printf(TEXT("VRPN: no data for %.0f ms"), Silence * 1000.0));
+	}
+
+	if (!ReconnectSettings.bAutoReconnect || Now < NextReconnectTime)
+	{
+		return;
+	}
+
+	// Between outages, retry only when the TCP connection is down too: a connect in progress has its own
+	// timeout, and a server that accepted us but sends nothing (no bodies, UDP blocked) is not fixed by reconnecting
+	if (!bLinkLost && ControlChannel.IsValid())
+	{
+		const EVRPNControlState State = ControlChannel->GetState();
+		if (State == EVRPNControlState::Connecting || State == EVRPNControlState::AwaitingCookie || State == EVRPNControlState::Connected)
+		{
+			return;
+		}
+	}
+
+	Reconnect(Now);
+}
+
+void FVRPNConnectionManager::Reconnect(double Now)
+{
+	bLinkLost = false;
+	NextReconnectTime = Now + ReconnectBackoff;
+	ReconnectBackoff = FMath::Min(ReconnectBackoff * 2.0, ReconnectSettings.MaxBackoff);
+	PipelineCounters.Reconnects.fetch_add(1, std::memory_order_relaxed);
+	if (FirstPoseWaitStart == 0.0)
+	{
+		FirstPoseWaitStart = Now;
+	}
+
+	UE_LOG(LogVRPN, Log, TEXT("Reconnecting to %s (next attempt in %.2f s)"),
+		MulticastGroup.IsEmpty() ? *ServerAddr->ToString(true) : *MulticastGroup, NextReconnectTime - Now);
+
+	// A restarted server has a new clock and may number its senders and types differently.
+	// The control thread adds round trips to the clock model, so it is stopped before the reset.
+	const bool bTcpStream = TransportMode == EVRPNTransportMode::TCPOnly && MulticastGroup.IsEmpty();
+	if (ControlChannel.IsValid() && !bTcpStream)
+	{
+		ControlChannel->StopThread();
+		ControlChannel->Close();
+	}
+	ClockSync.Reset();
+	if (MulticastGroup.IsEmpty())
+	{
+		TrackerTypeIds.Reset();
+		SenderNames.Reset();
+	}
+
+	// Same receiver object: counters and the receive batch carry over, only the socket is new
+	Receiver->Close();
+	bReceiverOpen = Receiver->Open(bTcpStream ? 0 : LocalUDPPort, ReceiveBufferSize);
+	BoundUDPPort.store(bReceiverOpen ? Receiver->GetLocalPort() : 0, std::memory_order_relaxed);
+	if (!bReceiverOpen)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Reconnect failed to reopen the %s socket"), Receiver->GetName());
+		return;
+	}
+	if (bTcpStream || !MulticastGroup.IsEmpty())
+	{
+		return;
+	}
+
+	// Tell the server where to stream; it may be a server that never had a TCP port
+	if (!ControlChannel.IsValid())
+	{
+		ControlChannel = MakeUnique<FVRPNControlChannel>(ClockSync, TrackerTypeIds, SenderNames);
+	}
+	if (ControlChannel->Open(*ServerAddr, Receiver->GetLocalPort(), ControlReceiveBufferSize))
+	{
+		ControlChannel->StartThread();
+	}
+}
+
+void FVRPNConnectionManager::ApplyRetarget(double Now)
+{
+	FString NewAddress;
+	int32 NewPort = 0;
+	{
+		FScopeLock ScopeLock(&RetargetLock);
+		NewAddress = PendingServerAddress;
+		NewPort = PendingServerPort;
+	}
+
+	// Updated in place: the TCP stream receiver shares the address object
+	bool bIsValid = false;
+	ServerAddr->SetIp(*NewAddress, bIsValid);
+	ServerAddr->SetPort(NewPort);
+	ReportLinkLost(FString::Printf(TEXT("VRPN: switching to %s:%d"), *NewAddress, NewPort));
+
+	// Sensor IDs stay; ordering and server-side rates belong to the old server's clock
+	OrderGuard.Reset();
+	ServerMotion.Reset();
+
+	ReconnectBackoff = ReconnectSettings.MinBackoff;
+	FirstPoseWaitStart = Now;
+	LastDataTime = Now;
+	Reconnect(Now);
+}
+
+void FVRPNConnectionManager::ReportLinkLost(const FString& ErrorMessage)
+{
+	if (!bIsConnected)
+	{
+		return;
+	}
+
+	// Tell the game thread once per outage
+	bIsConnected = false;
+	bLinkLost = true;
+	UE_LOG(LogVRPN, Warning, TEXT("%s"), *ErrorMessage);
+	QueueConnectionEvent(false, ErrorMessage);
+}
+
+void FVRPNConnectionManager::QueueConnectionEvent(bool bEstablished, const FString& ErrorMessage)
+{
+	FScopeLock ScopeLock(&ConnectionEventLock);
+
+	// Only the latest of a run of the same event matters (a link flapping while nobody drains)
+	if (PendingConnectionEvents.Num() > 0 && PendingConnectionEvents.Last().bEstablished == bEstablished)
+	{
+		PendingConnectionEvents.Last().ErrorMessage = ErrorMessage;
+	}
+	else
+	{
+		PendingConnectionEvents.Add({ bEstablished, ErrorMessage });
+	}
+	bConnectionEventsPending.store(true, std::memory_order_release);
+}
+
+void FVRPNConnectionManager::DispatchConnectionEvents()
+{
+	check(IsInGameThread());
+	if (!bConnectionEventsPending.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	TArray<FConnectionEvent> Events;
+	{
+		FScopeLock ScopeLock(&ConnectionEventLock);
+		Events = MoveTemp(PendingConnectionEvents);
+		PendingConnectionEvents.Reset();
+		bConnectionEventsPending.store(false, std::memory_order_relaxed);
+	}
+
+	for (const FConnectionEvent& Event : Events)
+	{
+		if (Event.bEstablished)
+		{
+			OnConnectionEstablished.ExecuteIfBound();
+		}
+		else
+		{
+			OnConnectionLost.ExecuteIfBound(Event.ErrorMessage);
+		}
+	}
+}
+
+bool FVRPNConnectionManager::Retarget(const FString& NewServerAddress, int32 NewServerPort)
+{
+	check(IsInGameThread());
+	if (ReceiveThread == nullptr || ReplayReceiver != nullptr || !MulticastGroup.IsEmpty() || !ServerAddr.IsValid())
+	{
+		return false;
+	}
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedPtr<FInternetAddr> NewAddr = SocketSubsystem ? SocketSubsystem->CreateInternetAddr() : nullptr;
+	bool bIsValid = false;
+	if (NewAddr.IsValid())
+	{
+		NewAddr->SetIp(*NewServerAddress, bIsValid);
+	}
+	if (!bIsValid || NewAddr->GetProtocolType() != ServerProtocolType)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Cannot switch to %s: not an address of the current address family"), *NewServerAddress);
+		return false;
+	}
+
+	{
+		FScopeLock ScopeLock(&RetargetLock);
+		PendingServerAddress = NewServerAddress;
+		PendingServerPort = NewServerPort;
+	}
+	ServerAddress = NewServerAddress;
+	ServerPort = NewServerPort;
+	bRetargetPending.store(true, std::memory_order_release);
+
+	UE_LOG(LogVRPN, Log, TEXT("Switching to server %s:%d"), *NewServerAddress, NewServerPort);
+	return true;
+}
+
+void FVRPNConnectionManager::SetReconnectSettings(const FVRPNReconnectSettings& Settings)
+{
+	if (ReceiveThread != nullptr)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Reconnect settings cannot be changed while receiving"));
+		return;
+	}
+
+	ReconnectSettings = Settings;
+	ReconnectSettings.MinBackoff = FMath::Max(ReconnectSettings.MinBackoff, 0.01);
+	ReconnectSettings.MaxBackoff = FMath::Max(ReconnectSettings.MaxBackoff, ReconnectSettings.MinBackoff);
+}
+
+void FVRPNConnectionManager::SetBatchedReceive(bool bEnable)
+{
+	if (Receiver.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Receive backend cannot be changed after the connection is initialized"));
+		return;
+	}
+
+	bBatchedReceive = bEnable;
+}
+
+void FVRPNConnectionManager::SetMulticastGroup(const FString& GroupAddress, const FString& InterfaceAddress)
+{
+	if (Receiver.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Multicast group cannot be changed after the connection is initialized"));
+		return;
+	}
+
+	MulticastGroup = GroupAddress;
+	MulticastInterface = InterfaceAddress;
+}
+
+void FVRPNConnectionManager::SetRelayTarget(const FString& Address, int32 Port, const FString& InterfaceAddress)
+{
+	if (Receiver.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Relay target cannot be changed after the connection is initialized"));
+		return;
+	}
+
+	RelayAddress = Address;
+	RelayPort = Port;
+	RelayInterface = InterfaceAddress;
+}
+
+void FVRPNConnectionManager::SetTransportMode(EVRPNTransportMode InTransportMode)
+{
+	if (Receiver.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Transport mode cannot be changed after the connection is initialized"));
+		return;
+	}
+
+	TransportMode = InTransportMode;
+}
+
+bool FVRPNConnectionManager::GetSenderName(int32 SenderId, FString& OutName) const
+{
+	return SenderNames.GetName(SenderId, OutName);
+}
+
+void FVRPNConnectionManager::SetReplaySource(const FString& CapturePath, double PlaybackRate, bool bLoop)
+{
+	if (Receiver.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Replay source cannot be changed after the connection is initialized"));
+		return;
+	}
+
+	ReplayPath = CapturePath;
+	ReplayRate = PlaybackRate;
+	bReplayLoop = bLoop;
+}
+
+void FVRPNConnectionManager::SeekReplay(double Time)
+{
+	if (ReplayReceiver != nullptr)
+	{
+		ReplayReceiver->Seek(Time);
+	}
+}
+
+bool FVRPNConnectionManager::StartRecording(const FString& CapturePath)
+{
+	check(IsInGameThread());
+
+	if (Recorder.IsValid())
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Already recording to %s"), *Recorder->GetPath());
+		return false;
+	}
+
+	TUniquePtr<FVRPNCaptureWriter> NewRecorder = MakeUnique<FVRPNCaptureWriter>();
+	if (!NewRecorder->Open(CapturePath))
+	{
+		return false;
+	}
+
+	Recorder = MoveTemp(NewRecorder);
+	PendingRecorder.store(Recorder.Get(), std::memory_order_release);
+	return true;
+}
+
+void FVRPNConnectionManager::StopRecording()
+{
+	check(IsInGameThread());
+
+	TUniquePtr<FVRPNCaptureWriter> Writer = TakeRecorder();
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+
+	// Waiting for the detach and writing out the backlog, index and trailer can take a while; the worker owns the writer from here
+	Async(EAsyncExecution::ThreadPool, [Writer = MoveTemp(Writer)]()
+	{
+		Writer->Finish();
+	});
+}
+
+TUniquePtr<FVRPNCaptureWriter> FVRPNConnectionManager::TakeRecorder()
+{
+	if (!Recorder.IsValid())
+	{
+		return nullptr;
+	}
+
+	FVRPNCaptureWriter* Expected = Recorder.Get();
+	if (PendingRecorder.compare_exchange_strong(Expected, nullptr) || ReceiveThread == nullptr)
+	{
+		// The receive thread never picked it up, or is not running: detach on its behalf
+		ActiveRecorder = nullptr;
+		Recorder->DetachProducer();
+	}
+	else
+	{
+		// The receive thread detaches at its next loop iteration (bounded by the wait timeout)
+		Recorder->RequestStop();
+	}
+
+	return MoveTemp(Recorder);
+}
+
+void FVRPNConnectionManager::SetLocalUDPPort(int32 InLocalPort)
+{
+	LocalUDPPort = InLocalPort;
+}
+
+void FVRPNConnectionManager::SetReceiveWaitMode(EVRPNReceiveWaitMode WaitMode)
+{
+	if (ReceiveThread != nullptr)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Receive wait mode cannot be changed while receiving"));
+		return;
+	}
+
+	ReceiveWaitMode = WaitMode;
+}
+
 void FVRPNConnectionManager::Stop()
 {
 	bShouldStop = true;
 }
 
-void FVRPNConnectionManager::ProcessUDPPacket(const uint8* Data, int32 DataSize)
+void FVRPNConnectionManager::ProcessUDPPacket(const uint8* Data, int32 DataSize, double ReceiveTime)
 {
-	// Parse VRPN message
-	FVRPNTransformData TransformData;
-	FString RigidBodyName;
-	
-	// Use FVRPNMessageParser to parse the packet
-	if (FVRPNMessageParser::ParseTrackerMessage(Data, DataSize, TransformData, RigidBodyName))
+	// Decode every tracker message in the datagram straight out of the receive buffer
+	// (relay datagrams from another cluster node carry poses that are already in Unreal space)
+	FVRPNParseResult Result;
+	const bool bFromRelay = FVRPNRelay::IsRelayDatagram(Data, DataSize);
+	{
+		VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Parse);
+		Result = bFromRelay
+			? FVRPNRelay::ParseDatagram(Data, DataSize, ParsedSamples, SenderNames)
+			: FVRPNMessageParser::ParseDatagram(Data, DataSize, TrackerTypeIds.Load(), ParsedSamples, ParsedDerivatives);
+	}
+
+	PipelineCounters.Messages.fetch_add(Result.NumMessages, std::memory_order_relaxed);
+	PipelineCounters.Samples.fetch_add(Result.NumSamples, std::memory_order_relaxed);
+	if (Result.bMalformed)
+	{
+		PipelineCounters.ParseFailures.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (Result.NumDropped > 0)
 	{
-		// Update last transform (thread-safe)
+		NumDroppedUpdates.fetch_add(Result.NumDropped, std::memory_order_relaxed);
+	}
+
+	// Engine-space poses from here on: axis remap, handedness, units and calibration in one pass
+	if (!bFromRelay)
+	{
+		VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Convert);
+		FrameConverter.ConvertBatch(MakeArrayView(ParsedSamples.GetData(), Result.NumSamples));
+		FrameConverter.ConvertDerivatives(MakeArrayView(ParsedDerivatives.GetData(), Result.NumDerivatives));
+	}
+
+	// Server-side velocity and acceleration reports, applied to the poses of their sensors at dispatch
+	for (int32 DerivativeIndex = 0; DerivativeIndex < Result.NumDerivatives; ++DerivativeIndex)
+	{
+		const FVRPNTrackerDerivative& Derivative = ParsedDerivatives[DerivativeIndex];
+		const int32 SensorId = SensorTable.FindOrAdd(Derivative.SenderId, Derivative.SensorIndex);
+		if (SensorId != INDEX_NONE)
 		{
-			FScopeLock Lock(&TransformDataCS);
-			LastTransform = TransformData;
+			ServerMotion.Store(SensorId, Derivative);
 		}
+	}
 
-		// Marshal transform update to game thread
-		AsyncTask(ENamedThreads::GameThread, [this, TransformData]()
+	// Local measurement time and dense ID of every sample; new sensors are registered on first sight without allocating.
+	// Samples older than the newest one of their sensor are compacted out here, so nothing downstream ever sees them.
+	int32 NumSamples = 0;
+	for (int32 SampleIndex = 0; SampleIndex < Result.NumSamples; ++SampleIndex)
+	{
+		const FVRPNTrackerSample& Sample = ParsedSamples[SampleIndex];
+
+		// Every server timestamp refines the clock model; poses carry their measurement time on the local clock
+		ClockSync.AddSample(Sample.ServerTime, ReceiveTime);
+
+		const int32 SensorId = SensorTable.FindOrAdd(Sample.SenderId, Sample.SensorIndex);
+		if (SensorId != INDEX_NONE && !OrderGuard.Accept(SensorId, Sample.ServerTime))
+		{
+			continue;
+		}
+
+		if (NumSamples != SampleIndex)
 		{
-			OnTransformUpdated.ExecuteIfBound(TransformData);
-		});
+			ParsedSamples[NumSamples] = Sample;
+		}
+		SampleTimestamps[NumSamples] = ClockSync.ServerToLocal(Sample.ServerTime);
+		SampleSensorIds[NumSamples] = SensorId;
+		++NumSamples;
+	}
+
+	{
+		VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Filter);
+		FilterBank.FilterBatch(MakeArrayView(ParsedSamples.GetData(), NumSamples),
+			MakeArrayView(SampleSensorIds.GetData(), NumSamples),
+			MakeArrayView(SampleTimestamps.GetData(), NumSamples),
+			MakeArrayView(SampleVelocities.GetData(), NumSamples),
+			MakeArrayView(SampleAngularVelocities.GetData(), NumSamples));
+	}
+
+	VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Dispatch);
+
+	// Relayed poses are not relayed again, so a relay listening to its own group does not loop
+	FVRPNRelay* const ActiveRelay = bFromRelay ? nullptr : Relay.Get();
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		const FVRPNTrackerSample& Sample = ParsedSamples[SampleIndex];
+		const int32 SensorId = SampleSensorIds[SampleIndex];
+		FVRPNTransformData TransformData(Sample.Position, Sample.Rotation, SampleTimestamps[SampleIndex],
+			SampleVelocities[SampleIndex], SampleAngularVelocities[SampleIndex]);
+		if (SensorId != INDEX_NONE)
+		{
+			// The server's own rates are measured rather than differenced from noisy positions, so they win over the filter's
+			ServerMotion.Apply(SensorId, Sample.ServerTime, TransformData);
+		}
+		LatestSlot.Write(TransformData);
+
+		if (SensorId == INDEX_NONE)
+		{
+			NumDroppedUpdates.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		// Publish latest pose (never blocks on readers)
+		SensorTable.Write(SensorId, TransformData);
+		PoseHistory.Write(SensorId, TransformData.Position, TransformData.Rotation, TransformData.Timestamp);
+		if (ActiveRelay != nullptr)
+		{
+			ActiveRelay->Add(SensorTable.GetSenderId(SensorId), SensorTable.GetSensorIndex(SensorId), TransformData, ReceiveTime);
+		}
+
+		// Hand the update to the game thread; it drains the queue once per frame
+		EnqueueUpdate(FVRPNSensorUpdate{ SensorId, TransformData, ReceiveTime });
+	}
+
+	if (NumSamples > 0 && FirstPoseWaitStart > 0.0)
+	{
+		// First pose since the last connect, reconnect or switch
+		const double TimeToFirstPose = ReceiveTime - FirstPoseWaitStart;
+		FirstPoseWaitStart = 0.0;
+		PipelineCounters.TimeToFirstPoseMicros.store(FMath::Max<uint64>(uint64(TimeToFirstPose * 1e6), 1), std::memory_order_relaxed);
+		UE_LOG(LogVRPN, Log, TEXT("First pose %.1f ms after connecting"), TimeToFirstPose * 1000.0);
+	}
+
+	if (ActiveRelay != nullptr)
+	{
+		ActiveRelay->Flush();
+		if (ReceiveTime >= NextRelayNamesTime)
+		{
+			NextRelayNamesTime = ReceiveTime + RelayNamesIntervalSeconds;
+			ActiveRelay->PublishNames(SensorTable, SenderNames);
+		}
+	}
+}
+
+void FVRPNConnectionManager::SetUpdateQueueConfig(int32 Capacity, EVRPNQueueOverflowPolicy OverflowPolicy)
+{
+	if (ReceiveThread != nullptr)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Update queue cannot be reconfigured while receiving"));
+		return;
+	}
+
+	UpdateQueue.Initialize(Capacity);
+	QueueOverflowPolicy = OverflowPolicy;
+}
+
+void FVRPNConnectionManager::EnqueueUpdate(const FVRPNSensorUpdate& Update)
+{
+	if (QueueOverflowPolicy == EVRPNQueueOverflowPolicy::DropOldest)
+	{
+		if (UpdateQueue.PushOverwrite(Update))
+		{
+			NumDroppedUpdates.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	else if (!UpdateQueue.Push(Update))
+	{
+		// The sensor's latest pose is already in its slot; flag it so the drain picks it up from there
+		OverflowedSensors[Update.SensorId / 32].fetch_or(1u << (Update.SensorId % 32), std::memory_order_release);
+		NumDroppedUpdates.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+TConstArrayView<FVRPNSensorUpdate> FVRPNConnectionManager::DrainTransformUpdates()
+{
+	return DrainTransformUpdates([](const FVRPNSensorUpdate&) {});
+}
+
+TConstArrayView<FVRPNSensorUpdate> FVRPNConnectionManager::DrainTransformUpdates(TFunctionRef<void(const FVRPNSensorUpdate&)> OnSample)
+{
+	check(IsInGameThread());
+	VRPN_SCOPE_CYCLE_COUNTER(STAT_VRPN_Drain);
+	DrainedUpdates.Reset();
+
+	const double Now = FPlatformTime::Seconds();
+	LastQueueDepth = UpdateQueue.Num();
+	int32 NumSamples = 0;
+
+	FVRPNSensorUpdate Update;
+	while (UpdateQueue.Pop(Update))
+	{
+		AgeWindow.Add(Now - Update.ReceiveTime);
+		++NumSamples;
+		OnSample(Update);
+		CoalesceUpdate(Update);
+	}
+
+	// Sensors that overflowed under KeepLatestPerSensor deliver their latest pose straight from the slot
+	for (int32 WordIndex = 0; WordIndex < OverflowedSensors.Num(); ++WordIndex)
+	{
+		uint32 Bits = OverflowedSensors[WordIndex].exchange(0, std::memory_order_acquire);
+		while (Bits != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+
+			Update.SensorId = WordIndex * 32 + Bit;
+			Update.ReceiveTime = Now;
+			if (SensorTable.Read(Update.SensorId, Update.Transform))
+			{
+				++NumSamples;
+				OnSample(Update);
+				CoalesceUpdate(Update);
+			}
+		}
+	}
+
+	for (const FVRPNSensorUpdate& Coalesced : DrainedUpdates)
+	{
+		CoalesceIndices[Coalesced.SensorId] = INDEX_NONE;
+	}
+
+	SensorTable.CopyTo(SensorSnapshot);
+	UpdatePipelineStats(Now, NumSamples);
+	return DrainedUpdates;
+}
+
+void FVRPNConnectionManager::UpdatePipelineStats(double Now, int32 NumSamples)
+{
+	const FVRPNReceiveCounters* Counters = GetReceiveCounters();
+	const uint64 Packets = Counters ? Counters->Datagrams.load(std::memory_order_relaxed) : 0;
+	const uint64 Bytes = Counters ? Counters->Bytes.load(std::memory_order_relaxed) : 0;
+	const uint64 Malformed = Counters ? Counters->Malformed.load(std::memory_order_relaxed) : 0;
+	const uint64 ParseFailures = PipelineCounters.ParseFailures.load(std::memory_order_relaxed) + Malformed;
+	const uint64 Dropped = NumDroppedUpdates.load(std::memory_order_relaxed);
+	const uint64 Stale = OrderGuard.GetTotalReordered() + OrderGuard.GetTotalDuplicated();
+
+	// Receive counters restart when the socket is reopened
+	auto Delta = [](uint64 Current, uint64& Last)
+	{
+		const uint64 Result = Current >= Last ? Current - Last : Current;
+		Last = Current;
+		return static_cast<uint32>(Result);
+	};
+
+	const uint32 NewPackets = Delta(Packets, LastStatPackets);
+	const uint32 NewBytes = Delta(Bytes, LastStatBytes);
+	const uint32 NewParseFailures = Delta(ParseFailures, LastStatParseFailures);
+	const uint32 NewDropped = Delta(Dropped, LastStatDropped);
+	const uint32 NewStale = Delta(Stale, LastStatStale);
+
+	// Counters are summed over every connection drained this frame
+	INC_DWORD_STAT_BY(STAT_VRPN_Packets, NewPackets);
+	INC_DWORD_STAT_BY(STAT_VRPN_Bytes, NewBytes);
+	INC_DWORD_STAT_BY(STAT_VRPN_Samples, NumSamples);
+	INC_DWORD_STAT_BY(STAT_VRPN_ParseFailures, NewParseFailures);
+	INC_DWORD_STAT_BY(STAT_VRPN_Dropped, NewDropped);
+	INC_DWORD_STAT_BY(STAT_VRPN_Stale, NewStale);
+	INC_DWORD_STAT_BY(STAT_VRPN_QueueDepth, LastQueueDepth);
+
+	TRACE_COUNTER_SET(VRPNQueueDepth, LastQueueDepth);
+	TRACE_COUNTER_SET(VRPNSamplesDrained, NumSamples);
+
+	if (AgeWindowStart == 0.0)
+	{
+		AgeWindowStart = Now;
+		WindowStartPackets = Packets;
+		return;
+	}
+
+	const double WindowLength = Now - AgeWindowStart;
+	if (WindowLength < 1.0)
+	{
+		return;
+	}
+
+	PacketsPerSecond = static_cast<float>((Packets >= WindowStartPackets ? Packets - WindowStartPackets : Packets) / WindowLength);
+	PacketAgeP50Ms = static_cast<float>(AgeWindow.GetPercentile(0.5) * 1000.0);
+	PacketAgeP99Ms = static_cast<float>(AgeWindow.GetPercentile(0.99) * 1000.0);
+	PacketAgeMaxMs = static_cast<float>(AgeWindow.MaxAge * 1000.0);
+
+	SET_FLOAT_STAT(STAT_VRPN_PacketAgeP50, PacketAgeP50Ms);
+	SET_FLOAT_STAT(STAT_VRPN_PacketAgeP99, PacketAgeP99Ms);
+	TRACE_COUNTER_SET(VRPNPacketAgeMax, PacketAgeMaxMs);
+
+	AgeWindow.Reset();
+	AgeWindowStart = Now;
+	WindowStartPackets = Packets;
+}
+
+void FVRPNConnectionManager::GetPipelineStats(FVRPNPipelineStats& OutStats) const
+{
+	OutStats = FVRPNPipelineStats();
+	OutStats.SamplesParsed = static_cast<int64>(PipelineCounters.Samples.load(std::memory_order_relaxed));
+	OutStats.ParseFailures = static_cast<int64>(PipelineCounters.ParseFailures.load(std::memory_order_relaxed));
+	if (const FVRPNReceiveCounters* Counters = GetReceiveCounters())
+	{
+		OutStats.PacketsReceived = static_cast<int64>(Counters->Datagrams.load(std::memory_order_relaxed));
+		OutStats.BytesReceived = static_cast<int64>(Counters->Bytes.load(std::memory_order_relaxed));
+		OutStats.ParseFailures += static_cast<int64>(Counters->Malformed.load(std::memory_order_relaxed));
+	}
+	OutStats.DroppedSamples = static_cast<int64>(NumDroppedUpdates.load(std::memory_order_relaxed));
+	OutStats.ReceiveErrors = static_cast<int64>(PipelineCounters.ReceiveErrors.load(std::memory_order_relaxed));
+	OutStats.ReorderedSamples = static_cast<int64>(OrderGuard.GetTotalReordered());
+	OutStats.DuplicateSamples = static_cast<int64>(OrderGuard.GetTotalDuplicated());
+	OutStats.LostSamples = static_cast<int64>(OrderGuard.GetTotalLost());
+	OutStats.QueueDepth = LastQueueDepth;
+	OutStats.PacketsPerSecond = PacketsPerSecond;
+	OutStats.PacketAgeP50Ms = PacketAgeP50Ms;
+	OutStats.PacketAgeP99Ms = PacketAgeP99Ms;
+	OutStats.PacketAgeMaxMs = PacketAgeMaxMs;
+	OutStats.Reconnects = static_cast<int64>(PipelineCounters.Reconnects.load(std::memory_order_relaxed));
+
+	const uint64 TimeToFirstPoseMicros = PipelineCounters.TimeToFirstPoseMicros.load(std::memory_order_relaxed);
+	OutStats.TimeToFirstPoseMs = TimeToFirstPoseMicros > 0 ? static_cast<float>(double(TimeToFirstPoseMicros) / 1000.0) : -1.0f;
+}
+
+void FVRPNConnectionManager::CoalesceUpdate(const FVRPNSensorUpdate& Update)
+{
+	int32& Index = CoalesceIndices[Update.SensorId];
+	if (Index == INDEX_NONE)
+	{
+		Index = DrainedUpdates.Add(Update);
+	}
+	else
+	{
+		DrainedUpdates[Index] = Update;
 	}
 }
 
 FVRPNTransformData FVRPNConnectionManager::GetLastTransform() const
 {
-	FScopeLock Lock(&TransformDataCS);
-	return LastTransform;
+	FVRPNTransformData Transform;
+	LatestSlot.Read(Transform);
+	return Transform;
+}
+
+bool FVRPNConnectionManager::GetSensorTransform(int32 SensorId, FVRPNTransformData& OutTransform) const
+{
+	return SensorTable.Read(SensorId, OutTransform);
+}
+
+int32 FVRPNConnectionManager::GetSensorSnapshotAtTime(double Time, FVRPNSensorSnapshot& OutSnapshot) const
+{
+	const int32 Count = SensorTable.Num();
+
+	// Same layout as the latest-pose snapshot, so callers iterate both the same way
+	OutSnapshot.Positions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Rotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Timestamps.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Velocities.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.AngularVelocities.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Accelerations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.AngularAccelerations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.SenderIds.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.SensorIndices.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.ValidBits.SetNum(Count, false);
+
+	int32 NumFound = 0;
+	FVRPNTransformData Transform;
+	for (int32 SensorId = 0; SensorId < Count; ++SensorId)
+	{
+		const bool bFound = PoseHistory.Sample(SensorId, Time, Transform);
+		if (!bFound)
+		{
+			Transform = FVRPNTransformData();
+		}
+
+		OutSnapshot.Positions[SensorId] = Transform.Position;
+		OutSnapshot.Rotations[SensorId] = Transform.Rotation;
+		OutSnapshot.Timestamps[SensorId] = Transform.Timestamp;
+		OutSnapshot.Velocities[SensorId] = Transform.Velocity;
+		OutSnapshot.AngularVelocities[SensorId] = Transform.AngularVelocity;
+		OutSnapshot.Accelerations[SensorId] = Transform.Acceleration;
+		OutSnapshot.AngularAccelerations[SensorId] = Transform.AngularAcceleration;
+		OutSnapshot.SenderIds[SensorId] = SensorTable.GetSenderId(SensorId);
+		OutSnapshot.SensorIndices[SensorId] = SensorTable.GetSensorIndex(SensorId);
+		OutSnapshot.ValidBits[SensorId] = bFound;
+		NumFound += bFound ? 1 : 0;
+	}
+	return NumFound;
+}
+
+int32 FVRPNConnectionManager::FindSensorByIndex(int32 SensorIndex) const
+{
+	const int32 NumSensors = SensorTable.Num();
+	for (int32 SensorId = 0; SensorId < NumSensors; ++SensorId)
+	{
+		if (SensorTable.GetSensorIndex(SensorId) == SensorIndex)
+		{
+			return SensorId;
+		}
+	}
+	return INDEX_NONE;
 }
 
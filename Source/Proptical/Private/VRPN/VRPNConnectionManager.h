@@ -7,16 +7,77 @@
 #include "Sockets.h"
 #include "SocketSubsystem.h"
 #include "Interfaces/IPv4/IPv4Address.h"
-#include "Common/TcpSocketBuilder.h"
 #include "VRPN/VRPNTransformData.h"
+#include "VRPN/VRPNTypes.h"
+#include "VRPNMessageParser.h"
+#include "VRPNSeqLock.h"
+#include "VRPNSpscQueue.h"
+#include "VRPNSensorTable.h"
+#include "VRPNDatagramReceiver.h"
+#include "VRPNClockSync.h"
+#include "VRPNCapture.h"
+#include "VRPNStats.h"
+#include "VRPNControlChannel.h"
+#include "VRPNFrameConverter.h"
+#include "VRPNFilterBank.h"
+#include "VRPNNameTable.h"
+#include "VRPNOrderGuard.h"
+#include "VRPNPoseHistory.h"
+#include "VRPNServerMotion.h"
+#include "VRPNRelay.h"
 
 class FSocket;
 class FInternetAddr;
 
+/**
+ * Pose update handed from the receive thread to the game thread
+ */
+struct FVRPNSensorUpdate
+{
+	/** Dense sensor ID from the connection's sensor table */
+	int32 SensorId;
+
+	/** Received pose */
+	FVRPNTransformData Transform;
+
+	/** Local time the datagram carrying this sample arrived (FPlatformTime::Seconds) */
+	double ReceiveTime;
+};
+
+/**
+ * How a connection notices a dead link and reconnects
+ */
+struct FVRPNReconnectSettings
+{
+	/** Reconnect on its own after a receive error or when the link goes silent */
+	bool bAutoReconnect = true;
+
+	/** Seconds without a datagram before a connected link counts as lost (0 = only receive errors count) */
+	double LivenessTimeout = 1.0;
+
+	/** Delay before the second attempt of an outage, doubled after every further attempt up to MaxBackoff (seconds) */
+	double MinBackoff = 0.25;
+	double MaxBackoff = 8.0;
+};
+
 /**
  * Manages VRPN connection lifecycle
  * Handles TCP handshake and UDP data reception
  * Thread-safe socket operations with game thread marshaling
+ *
+ * The TCP control channel (cookie exchange, UDP port negotiation, sender/type descriptions, pings)
+ * runs on its own low-priority thread so it never delays the UDP receive thread. In TCP-only mode
+ * the stream carries the tracker data too and is read by the receive thread instead.
+ *
+ * Every sensor seen on the wire gets a dense ID in the connection's sensor table, which holds
+ * the latest pose of all of them in structure-of-arrays storage.
+ * Pose updates reach the game thread through a bounded single-producer/single-consumer queue
+ * that the owner drains once per frame with DrainTransformUpdates().
+ *
+ * The receive thread also supervises the link: a receive error or a silent socket marks it lost,
+ * and the same thread reopens the sockets with exponential backoff until data flows again. A
+ * reconnect or a switch to another server only swaps sockets; the thread, buffers, sensor table,
+ * pose history and update queue stay as they are, so dense sensor IDs survive.
  */
 class FVRPNConnectionManager : public FRunnable
 {
@@ -26,7 +87,8 @@ public:
 
 	/**
 	 * Initialize connection to VRPN server
-	 * @param ServerAddress IP address or hostname of VRPN server
+	 * Blocks while sockets are bound and the capture file opened; UVRPNSubsystem calls it from a worker thread.
+	 * @param ServerAddress IP address of VRPN server (hostnames are resolved beforehand by UVRPNSubsystem)
 	 * @param ServerPort UDP port for initial contact (default: 3883)
 	 * @return true if initialization started successfully
 	 */
@@ -43,24 +105,269 @@ public:
 	 */
 	void StopReceiving();
 
+	/**
+	 * Switch to another server without stopping the receive thread (game thread)
+	 * The receive thread closes the old sockets and connects to the new server at its next loop
+	 * iteration; sensor IDs, pose history and queued updates are kept. OnConnectionLost fires for the
+	 * old server and OnConnectionEstablished once the new one sends data.
+	 * @param NewServerAddress IP address of the new server (same address family as the current one)
+	 * @param NewServerPort Port of the new server
+	 * @return false if not receiving, replaying, listening to a multicast group, or the address is invalid
+	 */
+	bool Retarget(const FString& NewServerAddress, int32 NewServerPort);
+
+	/**
+	 * Set how a lost link is detected and reconnected
+	 * Must be called before StartReceiving()
+	 */
+	void SetReconnectSettings(const FVRPNReconnectSettings& Settings);
+
 	/**
 	 * Check if currently connected
 	 */
 	bool IsConnected() const { return bIsConnected; }
 
 	/**
-	 * Get last received transform data
+	 * Get last received transform data (any sensor)
+	 * Lock-free; safe to call from any thread
 	 */
 	FVRPNTransformData GetLastTransform() const;
 
 	/**
-	 * Delegate for transform updates (called on game thread)
+	 * Get last received transform data for one sensor
+	 * Lock-free; safe to call from any thread
+	 * @param SensorId Dense sensor ID from the sensor table
+	 * @param OutTransform Snapshot of the latest pose for that sensor
+	 * @return false if the sensor has not reported yet
+	 */
+	bool GetSensorTransform(int32 SensorId, FVRPNTransformData& OutTransform) const;
+
+	/**
+	 * Get one sensor's pose at a past time, interpolated from its pose history
+	 * Lock-free; safe to call from any thread
+	 * @param SensorId Dense sensor ID from the sensor table
+	 * @param Time Local time (FPlatformTime::Seconds, same clock as FVRPNTransformData::Timestamp)
+	 * @param OutTransform Pose at that time; times after the newest sample return the newest sample
+	 * @return false if the sensor has no history or Time is older than the history reaches
+	 */
+	bool GetTransformAtTime(int32 SensorId, double Time, FVRPNTransformData& OutTransform) const { return PoseHistory.Sample(SensorId, Time, OutTransform); }
+
+	/**
+	 * Sample every sensor's pose history at one time in a single pass (reuses the snapshot's storage)
+	 * Safe to call from any thread; sensors without history at that time are left invalid in the snapshot
+	 * @param Time Local time (FPlatformTime::Seconds)
+	 * @param OutSnapshot Poses at Time, indexed by dense sensor ID
+	 * @return Number of sensors with a pose at Time
+	 */
+	int32 GetSensorSnapshotAtTime(double Time, FVRPNSensorSnapshot& OutSnapshot) const;
+
+	/**
+	 * Find the dense ID of a sensor
+	 * @param SenderId Server-side sender ID
+	 * @param SensorIndex Sensor index within the sender
+	 * @return Dense sensor ID, or INDEX_NONE if the sensor has not reported yet
+	 */
+	int32 FindSensor(int32 SenderId, int32 SensorIndex) const { return SensorTable.Find(SenderId, SensorIndex); }
+
+	/**
+	 * Find the dense ID of the first sensor with a given index, from any sender
+	 * @return Dense sensor ID, or INDEX_NONE if no such sensor has reported yet
+	 */
+	int32 FindSensorByIndex(int32 SensorIndex) const;
+
+	/** Latest-pose storage for every sensor (lock-free reads from any thread) */
+	const FVRPNSensorTable& GetSensorTable() const { return SensorTable; }
+
+	/**
+	 * Game-thread copy of every sensor, refreshed by DrainTransformUpdates()
+	 * Spans over it can be iterated without locks or copies until the next drain
+	 */
+	const FVRPNSensorSnapshot& GetSensorSnapshot() const { return SensorSnapshot; }
+
+	/**
+	 * Set the maximum number of distinct sensors tracked by this connection
+	 * Must be called before StartReceiving()
+	 */
+	void SetSensorCapacity(int32 Capacity);
+
+	/**
+	 * Set the memory shared by the pose history rings of all sensors (0 = no history)
+	 * The ring depth per sensor is the budget over the sensor capacity. Must be called before StartReceiving()
+	 */
+	void SetPoseHistoryBudget(int64 BudgetBytes);
+
+	/**
+	 * Choose how the receive thread waits for datagrams
+	 * Must be called before StartReceiving()
+	 */
+	void SetReceiveWaitMode(EVRPNReceiveWaitMode WaitMode);
+
+	/**
+	 * Use the batched (recvmmsg) receive backend on platforms that support it
+	 * Must be called before InitializeConnection(); other platforms always receive one datagram per call
+	 */
+	void SetBatchedReceive(bool bEnable);
+
+	/**
+	 * Choose the local UDP port the data socket binds to (0 = ephemeral)
+	 * Must be called before InitializeConnection()
+	 */
+	void SetLocalUDPPort(int32 InLocalPort);
+
+	/**
+	 * Listen to a multicast group (or a relay) instead of connecting to a server
+	 * No TCP handshake is made; the group's port is the local UDP port, which must be set. A non-multicast
+	 * address such as 0.0.0.0 only listens on that port, so a relay sending to 127.0.0.1 can be received.
+	 * Must be called before InitializeConnection(); the server address is then ignored
+	 * @param GroupAddress IPv4 multicast group, empty to connect to the server as usual
+	 * @param InterfaceAddress Address of the local interface to join on, empty for the system default
+	 */
+	void SetMulticastGroup(const FString& GroupAddress, const FString& InterfaceAddress);
+
+	/**
+	 * Re-publish every received pose to cluster peers as compact relay datagrams
+	 * Must be called before InitializeConnection()
+	 * @param Address Multicast group or unicast address of the peers, empty to not relay
+	 * @param Port UDP port the peers listen on
+	 * @param InterfaceAddress Address of the local interface to send multicast from, empty for the system default
+	 */
+	void SetRelayTarget(const FString& Address, int32 Port, const FString& InterfaceAddress);
+
+	/**
+	 * Choose whether tracker data arrives over UDP or over the TCP connection
+	 * Must be called before InitializeConnection()
+	 */
+	void SetTransportMode(EVRPNTransportMode InTransportMode);
+
+	/**
+	 * Set how incoming poses are converted into Unreal space
+	 * May be called at any time (game thread); applies from the next received datagram
+	 */
+	void SetFrameConversion(const FVRPNFrameConversion& Conversion) { FrameConverter.SetConversion(Conversion); }
+
+	/**
+	 * Set the noise filter of one sensor, or the default for all others
+	 * May be called at any time (game thread); filtering runs on the receive thread
+	 * @param SenderName Device name, None to match the sensor index on any device
+	 * @param SensorIndex Server-side sensor index, INDEX_NONE (with no device name) for the default
+	 */
+	void SetFilterSettings(FName SenderName, int32 SensorIndex, const FVRPNFilterSettings& Settings) { FilterBank.SetSettings(SenderName, SensorIndex, Settings); }
+
+	/**
+	 * Name the server gave a sender (tracker device), from its TCP descriptions
+	 * Safe to call from any thread
+	 * @return false if there is no TCP connection or the sender has not been described
+	 */
+	bool GetSenderName(int32 SenderId, FString& OutName) const;
+
+	/**
+	 * Resolve a sender (tracker device) name to the server's integer sender ID
+	 * Safe to call from any thread; resolve once when binding and route by ID afterwards
+	 * @return Sender ID, or INDEX_NONE if the server has not described a sender of that name
+	 */
+	int32 FindSenderId(FName SenderName) const { return SenderNames.FindId(SenderName); }
+
+	/** Changes whenever the server describes a new sender; re-resolve names only when it moves */
+	uint32 GetSenderNamesVersion() const { return SenderNames.GetVersion(); }
+
+	/** Locally bound UDP port, 0 if the socket is not open (safe from any thread, also while reconnecting) */
+	int32 GetLocalUDPPort() const { return BoundUDPPort.load(std::memory_order_relaxed); }
+
+	/**
+	 * Receive-side counters (datagrams, receive calls, bytes, processing cycles)
+	 * Datagrams / ReceiveCalls gives packets per syscall, ProcessCycles / Datagrams the CPU per packet
+	 * @return nullptr if the socket is not open
+	 */
+	const FVRPNReceiveCounters* GetReceiveCounters() const { return Receiver.IsValid() ? &Receiver->GetCounters() : nullptr; }
+
+	/**
+	 * Clock offset, drift and latency estimated from the server's timestamps
+	 * Lock-free; safe to call from any thread
+	 * @return false if no tracker sample has been received yet
+	 */
+	bool GetClockEstimate(FVRPNClockEstimate& OutEstimate) const { return ClockSync.GetEstimate(OutEstimate); }
+
+	/**
+	 * Replay a capture file instead of receiving from the network
+	 * Must be called before InitializeConnection(); the server address is then ignored
+	 * @param CapturePath Capture written by StartRecording()
+	 * @param PlaybackRate 1 = real time, N = N times faster, 0 = as fast as possible
+	 * @param bLoop Restart at the end of the capture
+	 */
+	void SetReplaySource(const FString& CapturePath, double PlaybackRate = 1.0, bool bLoop = false);
+
+	/**
+	 * Jump to a time in the replayed capture (no effect when receiving live)
+	 * @param Time Seconds from the start of the capture
+	 */
+	void SeekReplay(double Time);
+
+	/**
+	 * Start writing every received datagram to a capture file (game thread)
+	 * The receive thread only copies into preallocated chunks; a separate thread writes the file
+	 * @return false if a recording is already running or the file could not be created
+	 */
+	bool StartRecording(const FString& CapturePath);
+
+	/**
+	 * Stop recording (game thread)
+	 * Returns at once; the capture file is finalized on a worker once the receive thread has let go of it
+	 */
+	void StopRecording();
+
+	/** True while a capture file is being written */
+	bool IsRecording() const { return Recorder.IsValid(); }
+
+	/**
+	 * Configure the update queue between the receive thread and the game thread
+	 * Must be called before StartReceiving()
+	 * @param Capacity Maximum queued samples (rounded up to a power of two)
+	 * @param OverflowPolicy What to do when the game thread falls behind
+	 */
+	void SetUpdateQueueConfig(int32 Capacity, EVRPNQueueOverflowPolicy OverflowPolicy);
+
+	/**
+	 * Drain all queued pose updates, coalesced to the latest sample per sensor (game thread only)
+	 * Also refreshes the sensor snapshot
+	 * @return At most one update per sensor; valid until the next call
+	 */
+	TConstArrayView<FVRPNSensorUpdate> DrainTransformUpdates();
+
+	/**
+	 * Drain all queued pose updates, visiting every sample before coalescing (game thread only)
+	 * @param OnSample Called for every queued sample in arrival order (e.g. to feed a jitter buffer)
+	 * @return At most one update per sensor; valid until the next call
+	 */
+	TConstArrayView<FVRPNSensorUpdate> DrainTransformUpdates(TFunctionRef<void(const FVRPNSensorUpdate&)> OnSample);
+
+	/**
+	 * Number of samples discarded because the update queue was full
+	 */
+	uint64 GetNumDroppedUpdates() const { return NumDroppedUpdates.load(std::memory_order_relaxed); }
+
+	/**
+	 * Pipeline counters, queue depth and packet age (game thread)
+	 * Ages and rates are refreshed by DrainTransformUpdates() once per second
+	 */
+	void GetPipelineStats(FVRPNPipelineStats& OutStats) const;
+
+	/**
+	 * Loss, reorder and duplicate counts of one sensor
+	 * Safe to call from any thread
+	 * @param SensorId Dense sensor ID from the sensor table
+	 * @return false if the sensor has not reported yet
+	 */
+	bool GetSensorLinkStats(int32 SensorId, FVRPNSensorLinkStats& OutStats) const { return OrderGuard.GetSensorStats(SensorId, OutStats); }
+
+	/**
+	 * Fire the connection events the receive thread raised since the last call (game thread)
+	 * Events are latched instead of posted as game thread tasks, so none can outlive the manager.
+	 * A handler may release the owner's last reference to something else, but the caller must keep the manager alive.
 	 */
-	DECLARE_DELEGATE_OneParam(FOnTransformUpdated, const FVRPNTransformData&);
-	FOnTransformUpdated OnTransformUpdated;
+	void DispatchConnectionEvents();
 
 	/**
-	 * Delegate for connection events (called on game thread)
+	 * Delegate for connection events (called on game thread, from DispatchConnectionEvents())
 	 */
 	DECLARE_DELEGATE(FOnConnectionEstablished);
 	DECLARE_DELEGATE_OneParam(FOnConnectionLost, const FString&);
@@ -72,11 +379,14 @@ public:
 	virtual void Stop() override;
 
 private:
-	/** TCP socket for handshake (low priority) */
-	TSharedPtr<FSocket> TCPSocket;
+	/** TCP connection to the server (handshake and descriptions; all data in TCP-only mode) */
+	TUniquePtr<FVRPNControlChannel> ControlChannel;
 
-	/** UDP socket for data reception (primary) */
-	TSharedPtr<FSocket> UDPSocket;
+	/** UDP receive backend for data reception (primary) */
+	TUniquePtr<FVRPNDatagramReceiver> Receiver;
+
+	/** Preallocated buffers filled by each receive call (receive thread only) */
+	FVRPNDatagramBatch ReceiveBatch;
 
 	/** Server address */
 	TSharedPtr<FInternetAddr> ServerAddr;
@@ -88,17 +398,253 @@ private:
 	FThreadSafeBool bShouldStop;
 	FThreadSafeBool bIsConnected;
 
-	/** Last received transform data */
-	mutable FCriticalSection TransformDataCS;
-	FVRPNTransformData LastTransform;
-
 	/** Server address and port */
 	FString ServerAddress;
 	int32 ServerPort;
 
+	/** Address family of ServerAddr; a retarget must keep it, the UDP socket was created for it */
+	FName ServerProtocolType;
+
+	/** Port the UDP socket is bound to, updated whenever the receive thread reopens it */
+	std::atomic<int32> BoundUDPPort;
+
+	/** False after a reopen failed, until the next attempt succeeds (receive thread only) */
+	bool bReceiverOpen;
+
+	/** Liveness and backoff settings */
+	FVRPNReconnectSettings ReconnectSettings;
+
+	/** Local time of the newest datagram (receive thread only) */
+	double LastDataTime;
+
+	/** Earliest time of the next reconnect attempt and the delay after it (receive thread only) */
+	double NextReconnectTime;
+	double ReconnectBackoff;
+
+	/** Time the current outage's first reconnect started, 0 once a pose arrived (receive thread only) */
+	double FirstPoseWaitStart;
+
+	/** A connected link was just lost; the next attempt is due regardless of the TCP state (receive thread only) */
+	bool bLinkLost;
+
+	/** Server to switch to, handed from Retarget() to the receive thread */
+	FCriticalSection RetargetLock;
+	FString PendingServerAddress;
+	int32 PendingServerPort;
+	std::atomic<bool> bRetargetPending;
+
+	/** Connection event raised on the receive thread, fired by DispatchConnectionEvents() */
+	struct FConnectionEvent
+	{
+		bool bEstablished;
+		FString ErrorMessage;
+	};
+	FCriticalSection ConnectionEventLock;
+	TArray<FConnectionEvent> PendingConnectionEvents;
+
+	/** PendingConnectionEvents is not empty; lets quiet frames skip the lock */
+	std::atomic<bool> bConnectionEventsPending;
+
+	/** Local UDP port to bind (0 = ephemeral) */
+	int32 LocalUDPPort;
+
+	/** Use the batched receive backend where the platform has one */
+	bool bBatchedReceive;
+
+	/** UDP data with TCP control, or everything over TCP */
+	EVRPNTransportMode TransportMode;
+
+	/** Multicast group to listen to instead of a server (empty = server) and the interface to join on */
+	FString MulticastGroup;
+	FString MulticastInterface;
+
+	/** Where relayed poses are sent (empty = no relay) */
+	FString RelayAddress;
+	int32 RelayPort;
+	FString RelayInterface;
+
+	/** Relay fed by the receive thread, open while receiving with a relay target */
+	TUniquePtr<FVRPNRelay> Relay;
+
+	/** Next time the relay re-sends the sender names (receive thread only) */
+	double NextRelayNamesTime;
+
+	/** Seconds between name datagrams of the relay */
+	static constexpr double RelayNamesIntervalSeconds = 1.0;
+
+	/** Capture file to replay instead of opening a socket (empty = live) */
+	FString ReplayPath;
+	double ReplayRate;
+	bool bReplayLoop;
+
+	/** Replay backend when replaying (owned by Receiver) */
+	FVRPNCaptureReplayReceiver* ReplayReceiver;
+
+	/** Replay timeline the clock model and ordering state belong to (receive thread) */
+	uint32 ReplayTimelineVersion;
+
+	/** Capture writer owned by the game thread */
+	TUniquePtr<FVRPNCaptureWriter> Recorder;
+
+	/** Writer handed to the receive thread, picked up at its next loop iteration */
+	std::atomic<FVRPNCaptureWriter*> PendingRecorder;
+
+	/** Writer the receive thread is feeding (receive thread only) */
+	FVRPNCaptureWriter* ActiveRecorder;
+
 	/**
-	 * Perform TCP handshake (low priority - may be deferred)
-	 * @return true if handshake succeeded
+	 * Take the capture writer from the receive thread (game thread)
+	 * Detaches it right away if no producer feeds it, otherwise asks the receive thread to detach at its next iteration
+	 * @return The writer, ready for Finish(); null when not recording
+	 */
+	TUniquePtr<FVRPNCaptureWriter> TakeRecorder();
+
+	/** Datagrams pulled per receive call by the batched backend */
+	static constexpr int32 MaxDatagramsPerBatch = 32;
+
+	/** Largest datagram accepted (VRPN itself caps UDP messages at 1472 bytes; this leaves room for jumbo frames) */
+	static constexpr int32 MaxDatagramSize = 9216;
+
+	/** Requested kernel receive buffer size, deep enough to absorb bursts from 100+ bodies */
+	static constexpr int32 ReceiveBufferSize = 1024 * 1024;
+
+	/** Kernel receive buffer for the TCP socket when it only carries control traffic */
+	static constexpr int32 ControlReceiveBufferSize = 64 * 1024;
+
+	/** Maximum tracker messages decoded from one datagram (64KB / smallest tracker message) */
+	static constexpr int32 MaxSamplesPerDatagram = 1024;
+
+	/** Preallocated parse output, only touched by the receive thread */
+	TArray<FVRPNTrackerSample> ParsedSamples;
+
+	/** Preallocated velocity and acceleration reports of the datagram being processed (receive thread only) */
+	TArray<FVRPNTrackerDerivative> ParsedDerivatives;
+
+	/** Per-sample dense sensor ID, local timestamp and velocities of the datagram being processed (receive thread only) */
+	TArray<int32> SampleSensorIds;
+	TArray<double> SampleTimestamps;
+	TArray<FVector> SampleVelocities;
+	TArray<FVector> SampleAngularVelocities;
+
+	/** Sender names from the server's TCP descriptions, filled by the control channel */
+	FVRPNNameTable SenderNames;
+
+	/** Server-side type IDs of tracker position, velocity and acceleration messages (INDEX_NONE until described by the server over TCP) */
+	FVRPNSharedTrackerTypeIds TrackerTypeIds;
+
+	/** Maps server timestamps onto the local clock and estimates latency */
+	FVRPNClockSync ClockSync;
+
+	/** Drops reordered and duplicate samples before anything else sees them */
+	FVRPNOrderGuard OrderGuard;
+
+	/** Converts parsed samples into Unreal space before anything else sees them */
+	FVRPNFrameConverter FrameConverter;
+
+	/** Per-sensor noise filters with velocity estimates, run after the frame conversion */
+	FVRPNFilterBank FilterBank;
+
+	/** Velocities and accelerations reported by the server, preferred over the filter's estimates while recent */
+	FVRPNServerMotion ServerMotion;
+
+	/** How the receive thread waits for datagrams */
+	EVRPNReceiveWaitMode ReceiveWaitMode;
+
+	/** Longest a blocking wait lasts before re-checking bShouldStop */
+	static constexpr double StopCheckIntervalMs = 20.0;
+
+	/** Sensor capacity used until SetSensorCapacity() is called */
+	static constexpr int32 DefaultSensorCapacity = 512;
+
+	/** Pose history memory used until SetPoseHistoryBudget() is called */
+	static constexpr int64 DefaultPoseHistoryBudget = 4 * 1024 * 1024;
+
+	/** Update queue capacity used until SetUpdateQueueConfig() is called */
+	static constexpr int32 DefaultUpdateQueueCapacity = 1024;
+
+	/** Sensor registry and latest pose per sensor, written by the receive thread only */
+	FVRPNSensorTable SensorTable;
+
+	/** Recent poses per sensor for queries at a past time, written by the receive thread only */
+	FVRPNPoseHistory PoseHistory;
+
+	/** Memory for PoseHistory, applied whenever the sensor capacity changes */
+	int64 PoseHistoryBudget;
+
+	/** Game-thread copy of SensorTable, refreshed on drain */
+	FVRPNSensorSnapshot SensorSnapshot;
+
+	/** Latest pose of any sensor */
+	TVRPNSeqLock<FVRPNTransformData> LatestSlot;
+
+	/** Receive thread -> game thread pose updates */
+	TVRPNSpscQueue<FVRPNSensorUpdate> UpdateQueue;
+
+	/** Overflow handling for UpdateQueue */
+	EVRPNQueueOverflowPolicy QueueOverflowPolicy;
+
+	/** Sensors whose latest pose could not be queued (KeepLatestPerSensor), one bit per sensor */
+	TArray<std::atomic<uint32>> OverflowedSensors;
+
+	/** Samples discarded before reaching the game thread (queue, sensor table or parse buffer full) */
+	std::atomic<uint64> NumDroppedUpdates;
+
+	/** Receive-thread counters not kept by the receive backend */
+	FVRPNPipelineCounters PipelineCounters;
+
+	/** Bounds receive error logging while a socket keeps failing (receive thread only) */
+	FVRPNLogLimiter ReceiveErrorLog;
+
+	/** Packet age at drain over the current one-second window (game thread) */
+	FVRPNAgeHistogram AgeWindow;
+	double AgeWindowStart;
+
+	/** Results of the last complete window (game thread) */
+	float PacketsPerSecond;
+	float PacketAgeP50Ms;
+	float PacketAgeP99Ms;
+	float PacketAgeMaxMs;
+
+	/** Datagrams received when the current window started */
+	uint64 WindowStartPackets;
+
+	/** Totals at the previous drain, turned into per-frame stat counters (game thread) */
+	uint64 LastStatPackets;
+	uint64 LastStatBytes;
+	uint64 LastStatParseFailures;
+	uint64 LastStatDropped;
+	uint64 LastStatStale;
+
+	/** Samples waiting in the update queue when the last drain started */
+	int32 LastQueueDepth;
+
+	/** Game-thread drain output, reused every frame */
+	TArray<FVRPNSensorUpdate> DrainedUpdates;
+
+	/** Game-thread scratch: index into DrainedUpdates per sensor ID, INDEX_NONE if not yet present */
+	TArray<int32> CoalesceIndices;
+
+	/**
+	 * Queue a pose update for the game thread, applying the overflow policy
+	 * @param Update Update to queue
+	 */
+	void EnqueueUpdate(const FVRPNSensorUpdate& Update);
+
+	/**
+	 * Merge one update into the drain output, keeping only the latest per sensor
+	 */
+	void CoalesceUpdate(const FVRPNSensorUpdate& Update);
+
+	/**
+	 * Publish stat counters and roll the packet age window (game thread, end of each drain)
+	 * @param Now Time the drain started
+	 * @param NumSamples Samples visited by the drain
+	 */
+	void UpdatePipelineStats(double Now, int32 NumSamples);
+
+	/**
+	 * Start the TCP handshake for UDP mode; it completes on the control channel's own thread
+	 * @return true if the TCP socket was created
 	 */
 	bool PerformTCPHandshake();
 
@@ -108,11 +654,36 @@ private:
 	 */
 	bool SetupUDPSocket();
 
+	/**
+	 * Apply a pending retarget, detect silence and start reconnects when due (receive thread)
+	 * @param Now Current local time
+	 */
+	void SuperviseLink(double Now);
+
+	/**
+	 * Reopen the sockets (and the TCP handshake) and schedule the next attempt (receive thread)
+	 * @param Now Current local time
+	 */
+	void Reconnect(double Now);
+
+	/** Connect to the server handed over by Retarget() (receive thread) */
+	void ApplyRetarget(double Now);
+
+	/**
+	 * Mark the link lost and tell the game thread, once per outage (receive thread)
+	 * @param ErrorMessage Passed to OnConnectionLost
+	 */
+	void ReportLinkLost(const FString& ErrorMessage);
+
+	/** Latch a connection event for the game thread (receive thread) */
+	void QueueConnectionEvent(bool bEstablished, const FString& ErrorMessage);
+
 	/**
 	 * Process received UDP packet
 	 * @param Data Raw packet data
 	 * @param DataSize Size of packet
+	 * @param ReceiveTime Local time the packet arrived
 	 */
-	void ProcessUDPPacket(const uint8* Data, int32 DataSize);
+	void ProcessUDPPacket(const uint8* Data, int32 DataSize, double ReceiveTime);
 };
 
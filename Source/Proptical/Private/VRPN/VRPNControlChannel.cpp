@@ -0,0 +1,579 @@
+#include "VRPNControlChannel.h"
+#include "VRPNClockSync.h"
+#include "VRPNNameTable.h"
+#include "VRPNMessageParser.h"
+#include "VRPN/VRPNLog.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+namespace VRPNControl
+{
+	/** Protocol version we speak; only the major version has to match the server's */
+	static const ANSICHAR CookieMagic[] = "vrpn: ver. 07.35";
+
+	/** Leading part of the cookie that must match ("vrpn: ver. 07.") */
+	static constexpr int32 CookieMajorLength = 14;
+
+	static const TCHAR* TrackerPosQuatTypeName = TEXT("vrpn_Tracker Pos_Quat");
+	static const TCHAR* TrackerVelocityTypeName = TEXT("vrpn_Tracker Velocity");
+	static const TCHAR* TrackerAccelerationTypeName = TEXT("vrpn_Tracker Acceleration");
+	static const TCHAR* PingTypeName = TEXT("vrpn_Base ping_message");
+	static const TCHAR* PongTypeName = TEXT("vrpn_Base pong_message");
+
+	/**
+	 * Read the name out of a sender or type description
+	 * Payload: big-endian length (including the terminating NUL), then the name
+	 */
+	static bool ReadDescriptionName(const uint8* Payload, int32 PayloadSize, FString& OutName)
+	{
+		if (PayloadSize < 4)
+		{
+			return false;
+		}
+
+		const int32 NameLength = FMath::Min(VRPNWire::ReadInt32(Payload), PayloadSize - 4);
+		if (NameLength <= 0)
+		{
+			return false;
+		}
+
+		const ANSICHAR* Name = reinterpret_cast<const ANSICHAR*>(Payload + 4);
+		int32 Chars = 0;
+		while (Chars < NameLength && Name[Chars] != '\0')
+		{
+			++Chars;
+		}
+		OutName = FString::ConstructFromPtrSize(Name, Chars);
+		return true;
+	}
+}
+
+FVRPNControlChannel::FVRPNControlChannel(FVRPNClockSync& InClockSync, FVRPNSharedTrackerTypeIds& InTrackerTypeIds, FVRPNNameTable& InSenderNames)
+	: ClockSync(InClockSync)
+	, TrackerTypeIds(InTrackerTypeIds)
+	, SenderNames(InSenderNames)
+	, Socket(nullptr)
+	, Thread(nullptr)
+	, bStopThread(false)
+	, State(EVRPNControlState::Closed)
+	, LastError(SE_EWOULDBLOCK)
+	, LocalUDPPort(0)
+	, ConnectDeadline(0.0)
+	, PongTypeId(INDEX_NONE)
+	, bPingTargetDescribed(false)
+	, PingSendTime(0.0)
+	, NextPingTime(0.0)
+{
+	Reassembler.Initialize(StreamBufferSize);
+	SendBuffer.Reserve(4096);
+}
+
+FVRPNControlChannel::~FVRPNControlChannel()
+{
+	StopThread();
+	Close();
+}
+
+bool FVRPNControlChannel::Open(const FInternetAddr& ServerAddr, int32 InLocalUDPPort, int32 ReceiveBufferSize)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		return false;
+	}
+
+	Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("VRPN_TCP"), ServerAddr.GetProtocolType());
+	if (!Socket)
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Failed to create TCP socket"));
+		return false;
+	}
+
+	Socket->SetNonBlocking(true);
+	int32 ActualSize = 0;
+	Socket->SetReceiveBufferSize(ReceiveBufferSize, ActualSize);
+
+	LocalUDPPort = InLocalUDPPort;
+	ServerName = ServerAddr.ToString(true);
+	LastError.store(SE_EWOULDBLOCK, std::memory_order_relaxed);
+	Reassembler.Reset();
+	SendBuffer.Reset();
+	PongTypeId = INDEX_NONE;
+	bPingTargetDescribed = false;
+	PingSendTime = 0.0;
+
+	// Non-blocking connect: completion is picked up by Poll()
+	Socket->Connect(ServerAddr);
+	ConnectDeadline = FPlatformTime::Seconds() + ConnectTimeoutSeconds;
+	State = EVRPNControlState::Connecting;
+	return true;
+}
+
+void FVRPNControlChannel::Close()
+{
+	if (Socket)
+	{
+		if (GetState() == EVRPNControlState::Connected)
+		{
+			// Best effort; the server also notices the socket closing
+			QueueMessage(0, DisconnectMessageType, nullptr, 0);
+			Flush();
+		}
+
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+
+	if (GetState() != EVRPNControlState::Failed)
+	{
+		State = EVRPNControlState::Closed;
+	}
+}
+
+bool FVRPNControlChannel::StartThread()
+{
+	if (Thread != nullptr || Socket == nullptr)
+	{
+		return false;
+	}
+
+	bStopThread = false;
+	Thread = FRunnableThread::Create(this, TEXT("VRPNControlChannel"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FVRPNControlChannel::StopThread()
+{
+	if (Thread != nullptr)
+	{
+		bStopThread = true;
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FVRPNControlChannel::Run()
+{
+	// Wakes at least this often to send pings and notice Stop()
+	const FTimespan WaitTimeout = FTimespan::FromMilliseconds(100.0);
+
+	while (!bStopThread)
+	{
+		const EVRPNControlState CurrentState = GetState();
+		if (CurrentState == EVRPNControlState::Failed || CurrentState == EVRPNControlState::Closed)
+		{
+			break;
+		}
+
+		Wait(WaitTimeout);
+		Poll(nullptr);
+	}
+
+	return 0;
+}
+
+void FVRPNControlChannel::Stop()
+{
+	bStopThread = true;
+}
+
+bool FVRPNControlChannel::Wait(const FTimespan& Timeout)
+{
+	const EVRPNControlState CurrentState = GetState();
+	if (CurrentState == EVRPNControlState::Failed || CurrentState == EVRPNControlState::Closed || !Socket)
+	{
+		// Let the caller see the failure without spinning
+		FPlatformProcess::SleepNoStats(static_cast<float>(Timeout.GetTotalSeconds()));
+		return true;
+	}
+
+	// A full batch may have left complete messages behind
+	const uint8* Message = nullptr;
+	int32 PaddedLength = 0;
+	if (CurrentState == EVRPNControlState::Connected && Reassembler.NextMessage(Message, PaddedLength) == EVRPNStreamMessage::Complete)
+	{
+		return true;
+	}
+
+	const ESocketWaitConditions::Type Condition = CurrentState == EVRPNControlState::Connecting
+		? ESocketWaitConditions::WaitForWrite
+		: ESocketWaitConditions::WaitForRead;
+	return Socket->Wait(Condition, Timeout);
+}
+
+int32 FVRPNControlChannel::Poll(FVRPNDatagramBatch* DataOut)
+{
+	if (DataOut)
+	{
+		DataOut->Num = 0;
+	}
+
+	if (!Socket)
+	{
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	if (GetState() == EVRPNControlState::Connecting)
+	{
+		const ESocketConnectionState ConnectionState = Socket->GetConnectionState();
+		if (ConnectionState == SCS_ConnectionError)
+		{
+			Fail(SE_ECONNREFUSED, TEXT("connection refused"));
+			return 0;
+		}
+		if (ConnectionState != SCS_Connected)
+		{
+			if (Now > ConnectDeadline)
+			{
+				Fail(SE_ETIMEDOUT, TEXT("connection timed out"));
+			}
+			return 0;
+		}
+
+		// Control messages and pongs are tiny; never let Nagle hold them back
+		Socket->SetNoDelay(true);
+
+		// Both sides send their cookie first and check the other's before anything else
+		uint8 Cookie[CookieSize] = {};
+		FMemory::Memcpy(Cookie, VRPNControl::CookieMagic, sizeof(VRPNControl::CookieMagic) - 1);
+		Cookie[16] = ' ';
+		Cookie[17] = ' ';
+		Cookie[18] = '0'; // No remote logging
+		SendBuffer.Append(Cookie, CookieSize);
+		State = EVRPNControlState::AwaitingCookie;
+	}
+
+	Flush();
+	if (!ReceiveAvailable())
+	{
+		return 0;
+	}
+
+	if (GetState() == EVRPNControlState::AwaitingCookie)
+	{
+		if (Reassembler.NumBuffered() < CookieSize)
+		{
+			return 0;
+		}
+
+		if (FMemory::Memcmp(Reassembler.Peek(), VRPNControl::CookieMagic, VRPNControl::CookieMajorLength) != 0)
+		{
+			Fail(SE_EPROTONOSUPPORT, TEXT("server is not a compatible VRPN server (version cookie mismatch)"));
+			return 0;
+		}
+
+		Reassembler.Consume(CookieSize);
+		OnHandshakeComplete();
+	}
+
+	int32 NumEntries = 0;
+	int32 EntrySize = 0;
+	if (DataOut)
+	{
+		DataOut->ReceiveTime = Now;
+	}
+
+	while (GetState() == EVRPNControlState::Connected)
+	{
+		const uint8* Message = nullptr;
+		int32 PaddedLength = 0;
+		const EVRPNStreamMessage Next = Reassembler.NextMessage(Message, PaddedLength);
+		if (Next == EVRPNStreamMessage::Incomplete)
+		{
+			break;
+		}
+		if (Next == EVRPNStreamMessage::Corrupt)
+		{
+			Fail(SE_EINVAL, TEXT("malformed message on the TCP stream"));
+			break;
+		}
+
+		const int32 Length = VRPNWire::ReadInt32(Message);
+		const int32 TypeId = VRPNWire::ReadInt32(Message + 16);
+		if (TypeId < 0)
+		{
+			HandleSystemMessage(Message, Length, Now);
+		}
+		else if (TypeId == PongTypeId)
+		{
+			if (PingSendTime > 0.0)
+			{
+				ClockSync.AddRoundTrip(PingSendTime, Now);
+				PingSendTime = 0.0;
+			}
+		}
+		else if (DataOut && PaddedLength <= DataOut->GetMaxDatagramSize())
+		{
+			// Pack data messages back to back, as a server would pack a datagram
+			if (EntrySize + PaddedLength > DataOut->GetMaxDatagramSize())
+			{
+				DataOut->Sizes[NumEntries++] = EntrySize;
+				EntrySize = 0;
+				if (NumEntries == DataOut->GetMaxDatagrams())
+				{
+					// Batch full; the rest stays buffered for the next call
+					break;
+				}
+			}
+
+			FMemory::Memcpy(DataOut->GetBuffer(NumEntries) + EntrySize, Message, PaddedLength);
+			EntrySize += PaddedLength;
+		}
+
+		Reassembler.Consume(PaddedLength);
+	}
+
+	if (DataOut)
+	{
+		if (EntrySize > 0)
+		{
+			DataOut->Sizes[NumEntries++] = EntrySize;
+		}
+		DataOut->Num = NumEntries;
+	}
+
+	// Ping the first device the server described; its pong gives the round trip
+	if (GetState() == EVRPNControlState::Connected && bPingTargetDescribed && Now >= NextPingTime)
+	{
+		PingSendTime = Now;
+		NextPingTime = Now + PingIntervalSeconds;
+		QueueMessage(LocalPingSenderId, LocalPingTypeId, nullptr, 0);
+	}
+
+	Flush();
+	return NumEntries;
+}
+
+void FVRPNControlChannel::OnHandshakeComplete()
+{
+	State = EVRPNControlState::Connected;
+
+	if (LocalUDPPort > 0)
+	{
+		// Ask the server to send low-latency (tracker) messages to our UDP socket: the sender
+		// field carries the port, the payload our address as the server should see it
+		TSharedRef<FInternetAddr> LocalAddr = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+		Socket->GetAddress(*LocalAddr);
+		const FTCHARToUTF8 Address(*LocalAddr->ToString(false));
+		QueueMessage(LocalUDPPort, UDPDescriptionType, reinterpret_cast<const uint8*>(Address.Get()), Address.Length() + 1);
+	}
+
+	QueueDescription(TypeDescriptionType, LocalPingTypeId, VRPNControl::PingTypeName);
+
+	UE_LOG(LogVRPN, Log, TEXT("TCP control channel connected to %s (%s)"), *ServerName,
+		LocalUDPPort > 0 ? *FString::Printf(TEXT("tracker data on UDP port %d"), LocalUDPPort) : TEXT("TCP-only"));
+}
+
+void FVRPNControlChannel::HandleSystemMessage(const uint8* Message, int32 Length, double Now)
+{
+	const int32 Id = VRPNWire::ReadInt32(Message + 12);
+	const int32 TypeId = VRPNWire::ReadInt32(Message + 16);
+	const uint8* Payload = Message + FVRPNMessageParser::VRPN_HEADER_SIZE;
+	const int32 PayloadSize = Length - FVRPNMessageParser::VRPN_HEADER_SIZE;
+
+	switch (TypeId)
+	{
+	case SenderDescriptionType:
+	{
+		FString Name;
+		if (VRPNControl::ReadDescriptionName(Payload, PayloadSize, Name))
+		{
+			if (!bPingTargetDescribed)
+			{
+				// Pings are handled per device, so they are addressed to a sender the server knows
+				QueueDescription(SenderDescriptionType, LocalPingSenderId, Name);
+				bPingTargetDescribed = true;
+				NextPingTime = Now;
+			}
+
+			SenderNames.Add(Id, Name);
+		}
+		break;
+	}
+
+	case TypeDescriptionType:
+	{
+		FString Name;
+		if (VRPNControl::ReadDescriptionName(Payload, PayloadSize, Name))
+		{
+			if (Name == VRPNControl::TrackerPosQuatTypeName)
+			{
+				TrackerTypeIds.Position.store(Id, std::memory_order_relaxed);
+			}
+			else if (Name == VRPNControl::TrackerVelocityTypeName)
+			{
+				TrackerTypeIds.Velocity.store(Id, std::memory_order_relaxed);
+			}
+			else if (Name == VRPNControl::TrackerAccelerationTypeName)
+			{
+				TrackerTypeIds.Acceleration.store(Id, std::memory_order_relaxed);
+			}
+			else if (Name == VRPNControl::PongTypeName)
+			{
+				PongTypeId = Id;
+			}
+		}
+		break;
+	}
+
+	case DisconnectMessageType:
+		Fail(SE_ECONNRESET, TEXT("server closed the connection"));
+		break;
+
+	default:
+		// UDP and log descriptions from the server are not needed by a client
+		break;
+	}
+}
+
+bool FVRPNControlChannel::ReceiveAvailable()
+{
+	for (;;)
+	{
+		int32 FreeSpace = 0;
+		uint8* Dest = Reassembler.GetWriteSpace(FreeSpace);
+		if (FreeSpace == 0)
+		{
+			return true;
+		}
+
+		int32 BytesRead = 0;
+		if (!Socket->Recv(Dest, FreeSpace, BytesRead))
+		{
+			const ESocketErrors Error = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode();
+			Fail(Error == SE_NO_ERROR || Error == SE_EWOULDBLOCK ? SE_ECONNRESET : Error, TEXT("connection closed"));
+			return false;
+		}
+
+		if (BytesRead <= 0)
+		{
+			// Nothing more for now
+			return true;
+		}
+
+		Reassembler.CommitWrite(BytesRead);
+	}
+}
+
+void FVRPNControlChannel::QueueMessage(int32 SenderId, int32 TypeId, const uint8* Payload, int32 PayloadSize)
+{
+	const int32 Length = FVRPNMessageParser::VRPN_HEADER_SIZE + PayloadSize;
+	const int32 PaddedLength = VRPNWire::Align(Length, FVRPNMessageParser::VRPN_ALIGN);
+
+	const double Now = FPlatformTime::Seconds();
+	const double Seconds = FMath::FloorToDouble(Now);
+
+	const int32 Start = SendBuffer.AddZeroed(PaddedLength);
+	uint8* Dest = SendBuffer.GetData() + Start;
+	VRPNWire::WriteUInt32(Dest, static_cast<uint32>(Length));
+	VRPNWire::WriteUInt32(Dest + 4, static_cast<uint32>(static_cast<int64>(Seconds)));
+	VRPNWire::WriteUInt32(Dest + 8, static_cast<uint32>((Now - Seconds) * 1.0e6));
+	VRPNWire::WriteUInt32(Dest + 12, static_cast<uint32>(SenderId));
+	VRPNWire::WriteUInt32(Dest + 16, static_cast<uint32>(TypeId));
+	if (PayloadSize > 0)
+	{
+		FMemory::Memcpy(Dest + FVRPNMessageParser::VRPN_HEADER_SIZE, Payload, PayloadSize);
+	}
+}
+
+void FVRPNControlChannel::QueueDescription(int32 DescriptionType, int32 Id, const FString& Name)
+{
+	const FTCHARToUTF8 NameUtf8(*Name);
+	const int32 NameLength = NameUtf8.Length() + 1;
+
+	TArray<uint8, TInlineAllocator<128>> Payload;
+	Payload.SetNumUninitialized(4 + NameLength);
+	VRPNWire::WriteUInt32(Payload.GetData(), static_cast<uint32>(NameLength));
+	FMemory::Memcpy(Payload.GetData() + 4, NameUtf8.Get(), NameLength);
+
+	QueueMessage(Id, DescriptionType, Payload.GetData(), Payload.Num());
+}
+
+void FVRPNControlChannel::Flush()
+{
+	if (!Socket || SendBuffer.Num() == 0)
+	{
+		return;
+	}
+
+	int32 BytesSent = 0;
+	if (!Socket->Send(SendBuffer.GetData(), SendBuffer.Num(), BytesSent))
+	{
+		const ESocketErrors Error = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode();
+		if (Error != SE_EWOULDBLOCK)
+		{
+			Fail(Error, TEXT("send failed"));
+		}
+		return;
+	}
+
+	SendBuffer.RemoveAt(0, BytesSent, EAllowShrinking::No);
+}
+
+void FVRPNControlChannel::Fail(ESocketErrors Error, const TCHAR* Reason)
+{
+	UE_LOG(LogVRPN, Warning, TEXT("TCP connection to %s failed: %s (%d)%s"), *ServerName, Reason, (int32)Error,
+		LocalUDPPort > 0 ? TEXT("; still listening for UDP tracker data") : TEXT(""));
+
+	LastError.store(Error, std::memory_order_release);
+	State = EVRPNControlState::Failed;
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+FVRPNTcpStreamReceiver::FVRPNTcpStreamReceiver(FVRPNControlChannel& InChannel, const TSharedRef<FInternetAddr>& InServerAddr)
+	: Channel(InChannel)
+	, ServerAddr(InServerAddr)
+{
+}
+
+bool FVRPNTcpStreamReceiver::Open(int32 LocalPort, int32 ReceiveBufferSize)
+{
+	// No UDP port in the handshake: the server then sends everything over TCP
+	return Channel.Open(*ServerAddr, 0, ReceiveBufferSize);
+}
+
+void FVRPNTcpStreamReceiver::Close()
+{
+	Channel.Close();
+}
+
+bool FVRPNTcpStreamReceiver::Wait(const FTimespan& Timeout)
+{
+	return Channel.Wait(Timeout);
+}
+
+int32 FVRPNTcpStreamReceiver::ReceiveBatch(FVRPNDatagramBatch& Batch)
+{
+	const int32 NumEntries = Channel.Poll(&Batch);
+	if (NumEntries > 0)
+	{
+		int64 Bytes = 0;
+		for (int32 Index = 0; Index < NumEntries; ++Index)
+		{
+			Bytes += Batch.Sizes[Index];
+		}
+
+		Counters.ReceiveCalls.fetch_add(1, std::memory_order_relaxed);
+		Counters.Datagrams.fetch_add(NumEntries, std::memory_order_relaxed);
+		Counters.Bytes.fetch_add(Bytes, std::memory_order_relaxed);
+	}
+	return NumEntries;
+}
+
+ESocketErrors FVRPNTcpStreamReceiver::GetLastError() const
+{
+	return Channel.GetState() == EVRPNControlState::Failed ? Channel.GetLastError() : SE_EWOULDBLOCK;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "SocketTypes.h"
+#include "VRPNDatagramReceiver.h"
+#include "VRPNStreamReassembler.h"
+#include <atomic>
+
+class FSocket;
+class FInternetAddr;
+class FRunnableThread;
+class FVRPNClockSync;
+class FVRPNNameTable;
+struct FVRPNSharedTrackerTypeIds;
+
+/**
+ * Progress of the TCP connection to the server
+ */
+enum class EVRPNControlState : uint8
+{
+	Closed,
+	Connecting,
+	AwaitingCookie,
+	Connected,
+	Failed
+};
+
+/**
+ * VRPN TCP connection: version cookie exchange, UDP port negotiation, sender/type descriptions
+ * and ping/pong round trips
+ *
+ * Everything is non-blocking. Poll() advances the handshake, reads whatever the socket has into a
+ * stream reassembler and handles every complete message; it never waits. In UDP mode the channel
+ * runs Poll() on a low-priority thread of its own so control traffic never touches the UDP receive
+ * thread. In TCP-only mode FVRPNTcpStreamReceiver drives it from the receive thread instead, and
+ * tracker messages are copied out of the stream into the receive batch.
+ *
+ * Server type descriptions name the tracker position, velocity and acceleration message types,
+ * which are published to the receive thread through the TrackerTypeIds passed at construction.
+ * Sender descriptions go into the connection's name table. Pong replies to our pings feed the
+ * round trip of the connection's clock sync.
+ */
+class FVRPNControlChannel : public FRunnable
+{
+public:
+	/**
+	 * @param InClockSync Receives a round trip for every ping answered by the server
+	 * @param InTrackerTypeIds Set to the server's tracker type IDs as the server describes them
+	 * @param InSenderNames Receives the name of every sender the server describes
+	 */
+	FVRPNControlChannel(FVRPNClockSync& InClockSync, FVRPNSharedTrackerTypeIds& InTrackerTypeIds, FVRPNNameTable& InSenderNames);
+	virtual ~FVRPNControlChannel();
+
+	/**
+	 * Start connecting (returns immediately; the handshake completes in Poll())
+	 * @param ServerAddr Server address; VRPN servers accept TCP on the same port number as UDP
+	 * @param LocalUDPPort UDP port the server should send tracker data to, 0 to have everything sent over TCP
+	 * @param ReceiveBufferSize Requested kernel receive buffer size
+	 * @return false if the socket could not be created
+	 */
+	bool Open(const FInternetAddr& ServerAddr, int32 LocalUDPPort, int32 ReceiveBufferSize);
+
+	/** Tell the server we are leaving and close the socket */
+	void Close();
+
+	/** Run Poll() on a background thread until StopThread() or the connection fails */
+	bool StartThread();
+
+	/** Stop and join the background thread */
+	void StopThread();
+
+	/**
+	 * Block until Poll() has something to do or the timeout elapses
+	 * @return true if Poll() should be called
+	 */
+	bool Wait(const FTimespan& Timeout);
+
+	/**
+	 * Advance the handshake, read the socket and handle every complete message
+	 * @param DataOut Receives tracker and other data messages, packed back to back into the batch
+	 *        buffers like datagrams; nullptr to discard them
+	 * @return Number of batch entries filled
+	 */
+	int32 Poll(FVRPNDatagramBatch* DataOut);
+
+	EVRPNControlState GetState() const { return State.load(std::memory_order_relaxed); }
+
+	/** Error that failed the connection (SE_EWOULDBLOCK while healthy) */
+	ESocketErrors GetLastError() const { return LastError.load(std::memory_order_acquire); }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	/** VRPN system message types (negative type IDs) */
+	static constexpr int32 SenderDescriptionType = -1;
+	static constexpr int32 TypeDescriptionType = -2;
+	static constexpr int32 UDPDescriptionType = -3;
+	static constexpr int32 LogDescriptionType = -4;
+	static constexpr int32 DisconnectMessageType = -5;
+
+private:
+	/** Connection established and cookies matched: negotiate UDP and describe our ping message */
+	void OnHandshakeComplete();
+
+	/** Handle a negative-type message */
+	void HandleSystemMessage(const uint8* Message, int32 Length, double Now);
+
+	/** Read everything the socket has into the reassembler; false if the connection failed */
+	bool ReceiveAvailable();
+
+	/** Append a message to the send buffer */
+	void QueueMessage(int32 SenderId, int32 TypeId, const uint8* Payload, int32 PayloadSize);
+
+	/** Append a sender or type description (length-prefixed, NUL-terminated name) */
+	void QueueDescription(int32 DescriptionType, int32 Id, const FString& Name);
+
+	/** Send as much of the send buffer as the socket takes */
+	void Flush();
+
+	/** Close the socket and remember why */
+	void Fail(ESocketErrors Error, const TCHAR* Reason);
+
+	FVRPNClockSync& ClockSync;
+	FVRPNSharedTrackerTypeIds& TrackerTypeIds;
+	FVRPNNameTable& SenderNames;
+
+	FSocket* Socket;
+	FRunnableThread* Thread;
+	std::atomic<bool> bStopThread;
+	std::atomic<EVRPNControlState> State;
+
+	/** Written by the channel thread before it publishes the Failed state, read from any thread */
+	std::atomic<ESocketErrors> LastError;
+	FString ServerName;
+
+	/** UDP port sent to the server in the UDP description (0 = TCP-only) */
+	int32 LocalUDPPort;
+
+	/** Give up on connecting after this time */
+	double ConnectDeadline;
+
+	FVRPNStreamReassembler Reassembler;
+
+	/** Outgoing bytes not yet taken by the socket */
+	TArray<uint8> SendBuffer;
+
+	/** Server type ID of pong replies (INDEX_NONE until described) */
+	int32 PongTypeId;
+
+	/** A sender description for the ping target has been sent */
+	bool bPingTargetDescribed;
+
+	/** Time the outstanding ping was sent, 0 if none */
+	double PingSendTime;
+	double NextPingTime;
+
+	/** Our own IDs in the messages we send (described to the server before use) */
+	static constexpr int32 LocalPingSenderId = 0;
+	static constexpr int32 LocalPingTypeId = 0;
+
+	/** Bytes in a VRPN connection cookie ("vrpn: ver. 07.35" + log mode, padded) */
+	static constexpr int32 CookieSize = 24;
+
+	static constexpr double ConnectTimeoutSeconds = 3.0;
+	static constexpr double PingIntervalSeconds = 1.0;
+
+	/** Largest message accepted on the stream */
+	static constexpr int32 StreamBufferSize = 64 * 1024;
+};
+
+/**
+ * Receive backend for TCP-only mode: tracker messages come out of the control channel's stream
+ * The channel is owned by the connection manager and must outlive this receiver.
+ */
+class FVRPNTcpStreamReceiver : public FVRPNDatagramReceiver
+{
+public:
+	FVRPNTcpStreamReceiver(FVRPNControlChannel& InChannel, const TSharedRef<FInternetAddr>& InServerAddr);
+
+	virtual bool Open(int32 LocalPort, int32 ReceiveBufferSize) override;
+	virtual void Close() override;
+	virtual bool Wait(const FTimespan& Timeout) override;
+	virtual int32 ReceiveBatch(FVRPNDatagramBatch& Batch) override;
+	virtual ESocketErrors GetLastError() const override;
+	virtual int32 GetLocalPort() const override { return 0; }
+	virtual const TCHAR* GetName() const override { return TEXT("TCP stream"); }
+
+private:
+	FVRPNControlChannel& Channel;
+	TSharedRef<FInternetAddr> ServerAddr;
+};
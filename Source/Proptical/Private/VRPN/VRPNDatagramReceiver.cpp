@@ -0,0 +1,398 @@
+#include "VRPNDatagramReceiver.h"
+#include "VRPN/VRPNLog.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HAL/PlatformTime.h"
+
+#if PLATFORM_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/**
+ * Portable backend: one RecvFrom per datagram on an FSocket
+ */
+class FVRPNSocketReceiver : public FVRPNDatagramReceiver
+{
+public:
+	explicit FVRPNSocketReceiver(const FName& InProtocolType)
+		: ProtocolType(InProtocolType)
+		, Socket(nullptr)
+		, LastError(SE_NO_ERROR)
+	{
+	}
+
+	virtual ~FVRPNSocketReceiver()
+	{
+		Close();
+	}
+
+	virtual bool Open(int32 LocalPort, int32 ReceiveBufferSize) override
+	{
+		ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+		if (!SocketSubsystem)
+		{
+			return false;
+		}
+
+		Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("VRPN_UDP"), ProtocolType);
+		if (!Socket)
+		{
+			return false;
+		}
+
+		Socket->SetNonBlocking(true);
+
+		int32 ActualSize = 0;
+		Socket->SetReceiveBufferSize(ReceiveBufferSize, ActualSize);
+
+		if (!MulticastGroup.IsEmpty())
+		{
+			// Every render node on the host binds the same group port
+			Socket->SetReuseAddr(true);
+		}
+
+		TSharedRef<FInternetAddr> LocalAddr = SocketSubsystem->CreateInternetAddr(ProtocolType);
+		LocalAddr->SetAnyAddress();
+		LocalAddr->SetPort(LocalPort);
+		if (!Socket->Bind(*LocalAddr))
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Failed to bind UDP port %d"), LocalPort);
+			Close();
+			return false;
+		}
+
+		if (IsMulticastAddress(MulticastGroup))
+		{
+			bool bGroupValid = false;
+			TSharedRef<FInternetAddr> GroupAddr = SocketSubsystem->CreateInternetAddr(ProtocolType);
+			GroupAddr->SetIp(*MulticastGroup, bGroupValid);
+
+			bool bInterfaceValid = true;
+			TSharedRef<FInternetAddr> InterfaceAddr = SocketSubsystem->CreateInternetAddr(ProtocolType);
+			if (MulticastInterface.IsEmpty())
+			{
+				InterfaceAddr->SetAnyAddress();
+			}
+			else
+			{
+				InterfaceAddr->SetIp(*MulticastInterface, bInterfaceValid);
+			}
+
+			if (!bGroupValid || !bInterfaceValid || !Socket->JoinMulticastGroup(*GroupAddr, *InterfaceAddr))
+			{
+				UE_LOG(LogVRPN, Error, TEXT("Failed to join multicast group %s on interface %s"), *MulticastGroup,
+					MulticastInterface.IsEmpty() ? TEXT("(default)") : *MulticastInterface);
+				Close();
+				return false;
+			}
+		}
+
+		// Created once and reused for every receive
+		FromAddr = SocketSubsystem->CreateInternetAddr(ProtocolType);
+		return true;
+	}
+
+	virtual void Close() override
+	{
+		if (Socket)
+		{
+			Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+			Socket = nullptr;
+		}
+	}
+
+	virtual bool Wait(const FTimespan& Timeout) override
+	{
+		return Socket && Socket->Wait(ESocketWaitConditions::WaitForRead, Timeout);
+	}
+
+	virtual int32 ReceiveBatch(FVRPNDatagramBatch& Batch) override
+	{
+		Batch.Num = 0;
+		if (!Socket)
+		{
+			return 0;
+		}
+
+		Batch.ReceiveTime = FPlatformTime::Seconds();
+		const int32 MaxDatagramSize = Batch.GetMaxDatagramSize();
+		uint64 NumCalls = 0;
+		uint64 NumBytes = 0;
+		uint64 NumTruncated = 0;
+		while (Batch.Num < Batch.GetMaxDatagrams())
+		{
+			int32 BytesRead = 0;
+			if (!Socket->RecvFrom(Batch.GetBuffer(Batch.Num), MaxDatagramSize, BytesRead, *FromAddr))
+			{
+				LastError = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode();
+				break;
+			}
+
+			// One system call per datagram here, so the counters match recvmmsg calls that returned data
+			++NumCalls;
+			if (BytesRead > 0)
+			{
+				// RecvFrom does not report truncation; a datagram that fills the buffer may have been cut off
+				NumTruncated += BytesRead >= MaxDatagramSize ? 1 : 0;
+				NumBytes += BytesRead;
+				Batch.Sizes[Batch.Num++] = BytesRead;
+			}
+		}
+
+		if (NumCalls > 0)
+		{
+			Counters.ReceiveCalls.fetch_add(NumCalls, std::memory_order_relaxed);
+			Counters.Bytes.fetch_add(NumBytes, std::memory_order_relaxed);
+			Counters.Truncated.fetch_add(NumTruncated, std::memory_order_relaxed);
+			Counters.Datagrams.fetch_add(Batch.Num, std::memory_order_relaxed);
+		}
+		return Batch.Num;
+	}
+
+	virtual ESocketErrors GetLastError() const override
+	{
+		return LastError;
+	}
+
+	virtual int32 GetLocalPort() const override
+	{
+		return Socket ? Socket->GetPortNo() : 0;
+	}
+
+	virtual const TCHAR* GetName() const override
+	{
+		return TEXT("FSocket");
+	}
+
+private:
+	FName ProtocolType;
+	FSocket* Socket;
+	TSharedPtr<FInternetAddr> FromAddr;
+	ESocketErrors LastError;
+};
+
+#if PLATFORM_LINUX
+
+/**
+ * Linux backend: recvmmsg pulls up to a whole batch of datagrams per system call
+ */
+class FVRPNRecvMMsgReceiver : public FVRPNDatagramReceiver
+{
+public:
+	FVRPNRecvMMsgReceiver()
+		: SocketFd(-1)
+		, LastError(SE_NO_ERROR)
+		, BoundBatch(nullptr)
+	{
+	}
+
+	virtual ~FVRPNRecvMMsgReceiver()
+	{
+		Close();
+	}
+
+	virtual bool Open(int32 LocalPort, int32 ReceiveBufferSize) override
+	{
+		SocketFd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (SocketFd < 0)
+		{
+			return false;
+		}
+
+		int BufferSize = ReceiveBufferSize;
+		::setsockopt(SocketFd, SOL_SOCKET, SO_RCVBUF, &BufferSize, sizeof(BufferSize));
+
+		if (!MulticastGroup.IsEmpty())
+		{
+			// Every render node on the host binds the same group port
+			int ReuseAddr = 1;
+			::setsockopt(SocketFd, SOL_SOCKET, SO_REUSEADDR, &ReuseAddr, sizeof(ReuseAddr));
+		}
+
+		sockaddr_in LocalAddr = {};
+		LocalAddr.sin_family = AF_INET;
+		LocalAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+		LocalAddr.sin_port = htons(static_cast<uint16>(LocalPort));
+		if (::bind(SocketFd, reinterpret_cast<sockaddr*>(&LocalAddr), sizeof(LocalAddr)) != 0)
+		{
+			UE_LOG(LogVRPN, Error, TEXT("Failed to bind UDP port %d (errno %d)"), LocalPort, errno);
+			Close();
+			return false;
+		}
+
+		if (IsMulticastAddress(MulticastGroup))
+		{
+			ip_mreq Membership = {};
+			Membership.imr_interface.s_addr = htonl(INADDR_ANY);
+			const bool bGroupValid = ::inet_pton(AF_INET, TCHAR_TO_ANSI(*MulticastGroup), &Membership.imr_multiaddr) == 1;
+			const bool bInterfaceValid = MulticastInterface.IsEmpty()
+				|| ::inet_pton(AF_INET, TCHAR_TO_ANSI(*MulticastInterface), &Membership.imr_interface) == 1;
+			if (!bGroupValid || !bInterfaceValid
+				|| ::setsockopt(SocketFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Membership, sizeof(Membership)) != 0)
+			{
+				UE_LOG(LogVRPN, Error, TEXT("Failed to join multicast group %s on interface %s (errno %d)"), *MulticastGroup,
+					MulticastInterface.IsEmpty() ? TEXT("(default)") : *MulticastInterface, errno);
+				Close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	virtual void Close() override
+	{
+		if (SocketFd >= 0)
+		{
+			::close(SocketFd);
+			SocketFd = -1;
+		}
+	}
+
+	virtual bool Wait(const FTimespan& Timeout) override
+	{
+		pollfd PollFd = {};
+		PollFd.fd = SocketFd;
+		PollFd.events = POLLIN;
+		return SocketFd >= 0 && ::poll(&PollFd, 1, static_cast<int>(Timeout.GetTotalMilliseconds())) > 0;
+	}
+
+	virtual int32 ReceiveBatch(FVRPNDatagramBatch& Batch) override
+	{
+		Batch.Num = 0;
+		if (SocketFd < 0)
+		{
+			return 0;
+		}
+
+		BindBatch(Batch);
+
+		Batch.ReceiveTime = FPlatformTime::Seconds();
+		const int Received = ::recvmmsg(SocketFd, Headers.GetData(), Headers.Num(), MSG_DONTWAIT, nullptr);
+		if (Received < 0)
+		{
+			// Same error codes as the FSocket backend, so the link supervision sees refused and unreachable alike
+			const int32 ErrorCode = errno;
+			LastError = (ErrorCode == EAGAIN || ErrorCode == EWOULDBLOCK)
+				? SE_EWOULDBLOCK
+				: ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->TranslateErrorCode(ErrorCode);
+			return 0;
+		}
+		if (Received == 0)
+		{
+			LastError = SE_EWOULDBLOCK;
+			return 0;
+		}
+
+		uint64 NumBytes = 0;
+		for (int Index = 0; Index < Received; ++Index)
+		{
+			Batch.Sizes[Index] = static_cast<int32>(Headers[Index].msg_len);
+			NumBytes += Headers[Index].msg_len;
+			if (Headers[Index].msg_hdr.msg_flags & MSG_TRUNC)
+			{
+				Counters.Truncated.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		Batch.Num = Received;
+		Counters.ReceiveCalls.fetch_add(1, std::memory_order_relaxed);
+		Counters.Datagrams.fetch_add(Received, std::memory_order_relaxed);
+		Counters.Bytes.fetch_add(NumBytes, std::memory_order_relaxed);
+		return Received;
+	}
+
+	virtual ESocketErrors GetLastError() const override
+	{
+		return LastError;
+	}
+
+	virtual int32 GetLocalPort() const override
+	{
+		sockaddr_in LocalAddr = {};
+		socklen_t AddrLen = sizeof(LocalAddr);
+		if (SocketFd < 0 || ::getsockname(SocketFd, reinterpret_cast<sockaddr*>(&LocalAddr), &AddrLen) != 0)
+		{
+			return 0;
+		}
+		return ntohs(LocalAddr.sin_port);
+	}
+
+	virtual const TCHAR* GetName() const override
+	{
+		return TEXT("recvmmsg");
+	}
+
+private:
+	/** Point the message headers at the batch buffers (only redone if the batch changes) */
+	void BindBatch(FVRPNDatagramBatch& Batch)
+	{
+		if (BoundBatch == &Batch && Headers.Num() == Batch.GetMaxDatagrams())
+		{
+			// recvmmsg overwrites msg_namelen; restore it so the source address fits
+			for (mmsghdr& Header : Headers)
+			{
+				Header.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+			}
+			return;
+		}
+
+		const int32 Count = Batch.GetMaxDatagrams();
+		Headers.SetNumZeroed(Count);
+		IoVecs.SetNumZeroed(Count);
+		SourceAddrs.SetNumZeroed(Count);
+
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			IoVecs[Index].iov_base = Batch.GetBuffer(Index);
+			IoVecs[Index].iov_len = Batch.GetMaxDatagramSize();
+			Headers[Index].msg_hdr.msg_iov = &IoVecs[Index];
+			Headers[Index].msg_hdr.msg_iovlen = 1;
+			Headers[Index].msg_hdr.msg_name = &SourceAddrs[Index];
+			Headers[Index].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+		}
+		BoundBatch = &Batch;
+	}
+
+	int SocketFd;
+	ESocketErrors LastError;
+
+	/** Message headers, I/O vectors and source addresses, allocated once per batch and reused */
+	FVRPNDatagramBatch* BoundBatch;
+	TArray<mmsghdr> Headers;
+	TArray<iovec> IoVecs;
+	TArray<sockaddr_storage> SourceAddrs;
+};
+
+#endif // PLATFORM_LINUX
+
+bool FVRPNDatagramReceiver::IsMulticastAddress(const FString& Address)
+{
+	// 224.0.0.0/4; only the first octet decides
+	FString FirstOctet;
+	if (!Address.Split(TEXT("."), &FirstOctet, nullptr) || !FirstOctet.IsNumeric())
+	{
+		return false;
+	}
+	const int32 Value = FCString::Atoi(*FirstOctet);
+	return Value >= 224 && Value <= 239;
+}
+
+TUniquePtr<FVRPNDatagramReceiver> FVRPNDatagramReceiver::Create(bool bPreferBatched, const FName& ProtocolType)
+{
+#if PLATFORM_LINUX
+	if (bPreferBatched && ProtocolType == FNetworkProtocolTypes::IPv4)
+	{
+		return MakeUnique<FVRPNRecvMMsgReceiver>();
+	}
+#endif
+
+	return MakeUnique<FVRPNSocketReceiver>(ProtocolType);
+}
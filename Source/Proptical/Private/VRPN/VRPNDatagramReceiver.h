@@ -0,0 +1,149 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SocketTypes.h"
+#include <atomic>
+
+/**
+ * Preallocated pool of datagram buffers filled by a single receive call
+ */
+struct FVRPNDatagramBatch
+{
+	/** Datagrams received by the last call */
+	int32 Num = 0;
+
+	/** Size of each received datagram */
+	TArray<int32> Sizes;
+
+	/** Local receive time of the batch (FPlatformTime::Seconds) */
+	double ReceiveTime = 0.0;
+
+	/**
+	 * Allocate the pool (never called on the receive thread's hot path)
+	 * @param InMaxDatagrams Datagrams per receive call
+	 * @param InMaxDatagramSize Largest datagram accepted; longer ones are truncated
+	 */
+	void Initialize(int32 InMaxDatagrams, int32 InMaxDatagramSize)
+	{
+		MaxDatagrams = InMaxDatagrams;
+		MaxDatagramSize = InMaxDatagramSize;
+		Storage.SetNumUninitialized(MaxDatagrams * MaxDatagramSize);
+		Sizes.Init(0, MaxDatagrams);
+		Num = 0;
+	}
+
+	/** Buffer for the datagram at Index */
+	uint8* GetBuffer(int32 Index) { return Storage.GetData() + Index * MaxDatagramSize; }
+	const uint8* GetBuffer(int32 Index) const { return Storage.GetData() + Index * MaxDatagramSize; }
+
+	int32 GetMaxDatagrams() const { return MaxDatagrams; }
+	int32 GetMaxDatagramSize() const { return MaxDatagramSize; }
+
+private:
+	int32 MaxDatagrams = 0;
+	int32 MaxDatagramSize = 0;
+	TArray<uint8> Storage;
+};
+
+/**
+ * Receive-side counters, written by the receive thread and readable from any thread
+ */
+struct FVRPNReceiveCounters
+{
+	/** Receive system calls that returned data (one per datagram on the FSocket backend) */
+	std::atomic<uint64> ReceiveCalls{ 0 };
+
+	/** Datagrams received */
+	std::atomic<uint64> Datagrams{ 0 };
+
+	/** Payload bytes received */
+	std::atomic<uint64> Bytes{ 0 };
+
+	/** Datagrams longer than the batch buffers (truncated); the FSocket backend counts every datagram that fills its buffer */
+	std::atomic<uint64> Truncated{ 0 };
+
+	/** Records rejected before parsing (a corrupt capture record) */
+	std::atomic<uint64> Malformed{ 0 };
+
+	/** CPU cycles spent parsing and dispatching received datagrams */
+	std::atomic<uint64> ProcessCycles{ 0 };
+};
+
+/**
+ * UDP receive backend owned by FVRPNConnectionManager's receive thread
+ *
+ * The default backend wraps an FSocket and receives one datagram per call. On Linux a
+ * recvmmsg backend pulls a whole batch of datagrams per system call into the preallocated
+ * batch buffers. Neither backend allocates per datagram.
+ */
+class FVRPNDatagramReceiver
+{
+public:
+	virtual ~FVRPNDatagramReceiver() {}
+
+	/**
+	 * Create the best available backend
+	 * @param bPreferBatched Use the batched backend where the platform supports it
+	 * @param ProtocolType Socket protocol of the server address (IPv4/IPv6)
+	 */
+	static TUniquePtr<FVRPNDatagramReceiver> Create(bool bPreferBatched, const FName& ProtocolType);
+
+	/**
+	 * Share the port with other sockets and join a multicast group when the socket is opened (call before Open)
+	 * The port is bound with SO_REUSEADDR so several processes on one host can listen to the same group.
+	 * A unicast or any-address group only shares the port, which lets a relay be consumed over loopback.
+	 * @param InGroupAddress IPv4 group address (224.0.0.0 - 239.255.255.255)
+	 * @param InInterfaceAddress Address of the local interface to join on, empty for the system default
+	 */
+	void SetMulticastGroup(const FString& InGroupAddress, const FString& InInterfaceAddress)
+	{
+		MulticastGroup = InGroupAddress;
+		MulticastInterface = InInterfaceAddress;
+	}
+
+	/** True if Address is an IPv4 multicast address */
+	static bool IsMulticastAddress(const FString& Address);
+
+	/**
+	 * Create and bind the socket
+	 * @param LocalPort Local UDP port (0 = ephemeral)
+	 * @param ReceiveBufferSize Requested kernel receive buffer size
+	 * @return true if the socket is bound and ready
+	 */
+	virtual bool Open(int32 LocalPort, int32 ReceiveBufferSize) = 0;
+
+	/** Close the socket */
+	virtual void Close() = 0;
+
+	/**
+	 * Block until a datagram is ready or the timeout elapses
+	 * @return true if data is ready
+	 */
+	virtual bool Wait(const FTimespan& Timeout) = 0;
+
+	/**
+	 * Receive as many ready datagrams as fit in the batch, without blocking
+	 * @return Number of datagrams received (also stored in Batch.Num); 0 if none were ready or on error
+	 */
+	virtual int32 ReceiveBatch(FVRPNDatagramBatch& Batch) = 0;
+
+	/** Error of the last failed receive (SE_EWOULDBLOCK if simply nothing was ready) */
+	virtual ESocketErrors GetLastError() const = 0;
+
+	/** Locally bound UDP port, 0 if not open */
+	virtual int32 GetLocalPort() const = 0;
+
+	/** Backend name for logging */
+	virtual const TCHAR* GetName() const = 0;
+
+	/** Counters maintained by ReceiveBatch and the connection's receive loop */
+	FVRPNReceiveCounters& GetCounters() { return Counters; }
+	const FVRPNReceiveCounters& GetCounters() const { return Counters; }
+
+protected:
+	FVRPNReceiveCounters Counters;
+
+	/** Group to join on Open (empty = plain unicast socket) and the interface to join it on */
+	FString MulticastGroup;
+	FString MulticastInterface;
+};
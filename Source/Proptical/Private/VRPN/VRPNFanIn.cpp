@@ -0,0 +1,354 @@
+#include "VRPNFanIn.h"
+#include "VRPN/VRPNClient.h"
+#include "VRPN/VRPNSubsystem.h"
+
+FVRPNFanIn::FVRPNFanIn(const FString& InKey, int32 Capacity, double InStaleTimeout)
+	: Key(InKey)
+	, StaleTimeout(InStaleTimeout)
+	, bSubscribersDirty(true)
+	, LastPumpFrame(MAX_uint64)
+{
+	SensorTable.Initialize(Capacity);
+	const int32 NumBodies = SensorTable.Capacity();
+
+	ActiveSources.Init(INDEX_NONE, NumBodies);
+	ActiveSensorIds.Init(INDEX_NONE, NumBodies);
+	BodySourceCounts.Init(0, NumBodies);
+	FrameUpdateIndices.Init(INDEX_NONE, NumBodies);
+	FrameUpdates.Reset(NumBodies);
+}
+
+int32 FVRPNFanIn::AddSource(const TSharedPtr<FVRPNSharedConnection>& Connection, const FVRPNFanInSource& Source)
+{
+	FSource& NewSource = Sources.AddDefaulted_GetRef();
+	NewSource.Connection = Connection;
+	NewSource.Priority = Source.Priority;
+	for (const TPair<FString, int32>& BodyPriority : Source.BodyPriorities)
+	{
+		NewSource.BodyPriorities.Add(FName(*BodyPriority.Key), BodyPriority.Value);
+	}
+
+	// Per body and source storage depends on the source count, so it is sized before anything is merged
+	const int32 NumSlots = SensorTable.Capacity() * Sources.Num();
+	SourceTimes.Init(0.0, NumSlots);
+	SourcePriorities.Init(0, NumSlots);
+	return Sources.Num() - 1;
+}
+
+int32 FVRPNFanIn::ResolveBody(int32 SourceIndex, int32 SensorId)
+{
+	FSource& Source = Sources[SourceIndex];
+
+	// A newly described sender may rename sensors that were merged under no name
+	const uint32 NamesVersion = Source.Connection->GetManager().GetSenderNamesVersion();
+	if (NamesVersion != Source.NamesVersion)
+	{
+		Source.NamesVersion = NamesVersion;
+		RemapBodies(SourceIndex);
+	}
+
+	if (Source.BodyIds.IsValidIndex(SensorId) && Source.BodyIds[SensorId] != INDEX_NONE)
+	{
+		return Source.BodyIds[SensorId];
+	}
+
+	const int32 BodyId = FindOrAddBody(SourceIndex, SensorId);
+	if (BodyId == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	if (SensorId >= Source.BodyIds.Num())
+	{
+		Source.BodyIds.Reserve(Source.Connection->GetManager().GetSensorTable().Capacity());
+		while (Source.BodyIds.Num() <= SensorId)
+		{
+			Source.BodyIds.Add(INDEX_NONE);
+		}
+	}
+	Source.BodyIds[SensorId] = BodyId;
+	++BodySourceCounts[BodyId];
+
+	if (!SubscribersByBody.IsValidIndex(BodyId))
+	{
+		bSubscribersDirty = true;
+	}
+	return BodyId;
+}
+
+int32 FVRPNFanIn::FindOrAddBody(int32 SourceIndex, int32 SensorId)
+{
+	const FSource& Source = Sources[SourceIndex];
+	const FVRPNConnectionManager& Manager = Source.Connection->GetManager();
+
+	// Sender IDs are numbered per server, so bodies are identified by device name across sources
+	const FVRPNSensorTable& SourceTable = Manager.GetSensorTable();
+	FString SenderName;
+	const FName DeviceName = Manager.GetSenderName(SourceTable.GetSenderId(SensorId), SenderName) ? FName(*SenderName) : NAME_None;
+
+	const int32* ExistingDeviceId = DeviceIds.Find(DeviceName);
+	const int32 DeviceId = ExistingDeviceId ? *ExistingDeviceId : DeviceIds.Add(DeviceName, DeviceIds.Num());
+
+	const int32 BodyId = SensorTable.FindOrAdd(DeviceId, SourceTable.GetSensorIndex(SensorId));
+	if (BodyId != INDEX_NONE)
+	{
+		const int32* BodyPriority = Source.BodyPriorities.Find(DeviceName);
+		SourcePriorities[BodyId * Sources.Num() + SourceIndex] = BodyPriority ? *BodyPriority : Source.Priority;
+	}
+	return BodyId;
+}
+
+void FVRPNFanIn::RemapBodies(int32 SourceIndex)
+{
+	FSource& Source = Sources[SourceIndex];
+	const int32 NumSources = Sources.Num();
+
+	// Only sensors that change name move; the body they leave no longer hears from this source, so one physical
+	// sensor never feeds two bodies
+	for (int32 SensorId = 0; SensorId < Source.BodyIds.Num(); ++SensorId)
+	{
+		const int32 OldBodyId = Source.BodyIds[SensorId];
+		if (OldBodyId == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const int32 NewBodyId = FindOrAddBody(SourceIndex, SensorId);
+		if (NewBodyId == OldBodyId)
+		{
+			continue;
+		}
+
+		Source.BodyIds[SensorId] = NewBodyId;
+		if (NewBodyId != INDEX_NONE)
+		{
+			++BodySourceCounts[NewBodyId];
+		}
+
+		SourceTimes[OldBodyId * NumSources + SourceIndex] = 0.0;
+		if (ActiveSources[OldBodyId] == SourceIndex && ActiveSensorIds[OldBodyId] == SensorId)
+		{
+			ActiveSources[OldBodyId] = INDEX_NONE;
+			ActiveSensorIds[OldBodyId] = INDEX_NONE;
+		}
+		if (--BodySourceCounts[OldBodyId] == 0)
+		{
+			UE_LOG(LogVRPN, Log, TEXT("%s: body %d retired, its sensor is now body %d"), *Key, OldBodyId, NewBodyId);
+		}
+		bSubscribersDirty = true;
+	}
+}
+
+void FVRPNFanIn::MergeSample(int32 SourceIndex, const FVRPNSensorUpdate& Sample)
+{
+	const int32 BodyId = ResolveBody(SourceIndex, Sample.SensorId);
+	if (BodyId == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 NumSources = Sources.Num();
+	const int32 Slot = BodyId * NumSources + SourceIndex;
+	const double SampleTime = Sample.Transform.Timestamp;
+	SourceTimes[Slot] = SampleTime;
+
+	// Timestamps are measurement times on the local clock, so they compare across servers
+	int32& ActiveSource = ActiveSources[BodyId];
+	if (ActiveSource != SourceIndex)
+	{
+		if (ActiveSource != INDEX_NONE)
+		{
+			const int32 ActiveSlot = BodyId * NumSources + ActiveSource;
+			const bool bActiveStale = SampleTime - SourceTimes[ActiveSlot] > StaleTimeout;
+			if (!bActiveStale && SourcePriorities[Slot] <= SourcePriorities[ActiveSlot])
+			{
+				return;
+			}
+
+			UE_LOG(LogVRPN, Log, TEXT("%s: body %d switched to %s (%s)"), *Key, BodyId, *Sources[SourceIndex].Connection->GetKey(),
+				bActiveStale ? TEXT("active source went stale") : TEXT("higher priority"));
+		}
+		ActiveSource = SourceIndex;
+	}
+	ActiveSensorIds[BodyId] = Sample.SensorId;
+
+	const FVRPNTransformData& Transform = Sample.Transform;
+	SensorTable.Write(BodyId, Transform);
+	LastTransform = Transform;
+
+	const FVRPNSensorUpdate Merged{ BodyId, Transform, Sample.ReceiveTime };
+	if (bSubscribersDirty)
+	{
+		RebuildSubscribers();
+	}
+	if (SubscribersByBody.IsValidIndex(BodyId))
+	{
+		for (UVRPNClient* Subscriber : SubscribersByBody[BodyId])
+		{
+			if (Subscriber)
+			{
+				Subscriber->HandleSample(Merged);
+			}
+		}
+	}
+
+	int32& UpdateIndex = FrameUpdateIndices[BodyId];
+	if (UpdateIndex == INDEX_NONE)
+	{
+		UpdateIndex = FrameUpdates.Add(Merged);
+	}
+	else
+	{
+		FrameUpdates[UpdateIndex] = Merged;
+	}
+}
+
+void FVRPNFanIn::FinishFrame()
+{
+	SensorTable.CopyTo(SensorSnapshot);
+	if (bSubscribersDirty)
+	{
+		RebuildSubscribers();
+	}
+
+	for (const FVRPNSensorUpdate& Update : FrameUpdates)
+	{
+		FrameUpdateIndices[Update.SensorId] = INDEX_NONE;
+	}
+
+	// Handlers may disconnect (which nulls their routing entries), so entries are re-read by index
+	for (const FVRPNSensorUpdate& Update : FrameUpdates)
+	{
+		if (SubscribersByBody.IsValidIndex(Update.SensorId))
+		{
+			for (int32 Index = 0; Index < SubscribersByBody[Update.SensorId].Num(); ++Index)
+			{
+				if (UVRPNClient* Subscriber = SubscribersByBody[Update.SensorId][Index])
+				{
+					Subscriber->HandleTransformUpdated(Update.Transform);
+				}
+			}
+		}
+
+		for (int32 Index = 0; Index < AllBodySubscribers.Num(); ++Index)
+		{
+			if (UVRPNClient* Subscriber = AllBodySubscribers[Index])
+			{
+				Subscriber->HandleTransformUpdated(Update.Transform);
+			}
+		}
+	}
+	FrameUpdates.Reset();
+}
+
+bool FVRPNFanIn::IsConnected() const
+{
+	for (const FSource& Source : Sources)
+	{
+		if (Source.Connection->GetManager().IsConnected())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int32 FVRPNFanIn::FindBody(FName DeviceName, int32 SensorIndex) const
+{
+	if (!DeviceName.IsNone())
+	{
+		const int32* DeviceId = DeviceIds.Find(DeviceName);
+		const int32 BodyId = DeviceId ? SensorTable.Find(*DeviceId, SensorIndex) : INDEX_NONE;
+		return IsBodyRetired(BodyId) ? INDEX_NONE : BodyId;
+	}
+
+	// Same resolution as FVRPNConnectionManager::FindSensorByIndex: first device reporting that index
+	const int32 NumBodies = SensorTable.Num();
+	for (int32 BodyId = 0; BodyId < NumBodies; ++BodyId)
+	{
+		if (SensorTable.GetSensorIndex(BodyId) == SensorIndex && !IsBodyRetired(BodyId))
+		{
+			return BodyId;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FVRPNSharedConnection* FVRPNFanIn::GetActiveSource(int32 BodyId, int32& OutSensorId) const
+{
+	OutSensorId = INDEX_NONE;
+	if (!ActiveSources.IsValidIndex(BodyId) || ActiveSources[BodyId] == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	OutSensorId = ActiveSensorIds[BodyId];
+	return Sources[ActiveSources[BodyId]].Connection.Get();
+}
+
+TArray<FVRPNSharedConnection*> FVRPNFanIn::GetSourceConnections() const
+{
+	TArray<FVRPNSharedConnection*> Connections;
+	Connections.Reserve(Sources.Num());
+	for (const FSource& Source : Sources)
+	{
+		Connections.Add(Source.Connection.Get());
+	}
+	return Connections;
+}
+
+void FVRPNFanIn::HandleSourceEstablished(int32 SourceIndex)
+{
+	// Copied and re-checked: a handler may disconnect other subscribers, or release this fan-in
+	const TSharedRef<FVRPNFanIn> Pinned = AsShared();
+	for (UVRPNClient* Subscriber : TArray<UVRPNClient*>(Subscribers))
+	{
+		if (Subscribers.Contains(Subscriber))
+		{
+			Subscriber->HandleConnectionEstablished();
+		}
+	}
+}
+
+void FVRPNFanIn::HandleSourceLost(int32 SourceIndex, const FString& ErrorMessage)
+{
+	const FString Message = FString::Printf(TEXT("%s: %s"), *Sources[SourceIndex].Connection->GetKey(), *ErrorMessage);
+	const TSharedRef<FVRPNFanIn> Pinned = AsShared();
+	for (UVRPNClient* Subscriber : TArray<UVRPNClient*>(Subscribers))
+	{
+		if (Subscribers.Contains(Subscriber))
+		{
+			Subscriber->HandleConnectionLost(Message);
+		}
+	}
+}
+
+void FVRPNFanIn::RebuildSubscribers()
+{
+	const int32 NumBodies = SensorTable.Num();
+
+	SubscribersByBody.SetNum(NumBodies);
+	for (TArray<UVRPNClient*>& BodySubscribers : SubscribersByBody)
+	{
+		BodySubscribers.Reset();
+	}
+	AllBodySubscribers.Reset();
+
+	for (UVRPNClient* Subscriber : Subscribers)
+	{
+		const int32 SensorIndex = Subscriber->GetTrackedSensorIndex();
+		if (SensorIndex == INDEX_NONE)
+		{
+			AllBodySubscribers.Add(Subscriber);
+			continue;
+		}
+
+		const int32 BodyId = FindBody(Subscriber->TrackedSenderName, SensorIndex);
+		if (BodyId != INDEX_NONE && BodyId < NumBodies)
+		{
+			SubscribersByBody[BodyId].Add(Subscriber);
+		}
+	}
+
+	bSubscribersDirty = false;
+}
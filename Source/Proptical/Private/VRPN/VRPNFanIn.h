@@ -0,0 +1,161 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTypes.h"
+#include "VRPN/VRPNSensorSnapshot.h"
+#include "VRPNSensorTable.h"
+#include "VRPNConnectionManager.h"
+
+class FVRPNSharedConnection;
+class UVRPNClient;
+
+/**
+ * Pose source merging several servers into one sensor table (game thread only)
+ *
+ * Each server is an ordinary shared connection, so its datagrams are parsed, converted, filtered
+ * and stored once no matter how many components or fan-ins use it. The fan-in hooks into the
+ * drain of every source and merges the drained samples into a sensor table of its own, keyed by
+ * body (device name and sensor index) since sender IDs are numbered per server.
+ *
+ * Every body has one active source. A sample from another source takes over when that source has
+ * a higher priority for the body, or when the active source's newest sample of the body is older
+ * than the stale timeout. So the primary is used whenever it delivers, and a backup fills in
+ * within one stale timeout of the primary stopping.
+ */
+class FVRPNFanIn : public TSharedFromThis<FVRPNFanIn>
+{
+public:
+	/**
+	 * @param InKey Key the subsystem shares this fan-in by
+	 * @param Capacity Maximum number of merged bodies
+	 * @param InStaleTimeout Seconds without a sample after which a body's active source is replaced
+	 */
+	FVRPNFanIn(const FString& InKey, int32 Capacity, double InStaleTimeout);
+
+	/**
+	 * Add a server (before the first merge); sources are numbered in the order they are added
+	 * @param Connection Shared connection to the server
+	 * @param Source Priorities of the server
+	 * @return Source index
+	 */
+	int32 AddSource(const TSharedPtr<FVRPNSharedConnection>& Connection, const FVRPNFanInSource& Source);
+
+	/**
+	 * Merge one sample drained from a source (called for every sample while the source is pumped)
+	 * @param SourceIndex Source the sample was drained from
+	 * @param Sample Sample with the source's dense sensor ID
+	 */
+	void MergeSample(int32 SourceIndex, const FVRPNSensorUpdate& Sample);
+
+	/** Refresh the snapshot and fire the frame's update events (after every source was pumped) */
+	void FinishFrame();
+
+	/** Key the subsystem shares this fan-in by */
+	const FString& GetKey() const { return Key; }
+
+	/** True while any source is connected */
+	bool IsConnected() const;
+
+	/**
+	 * Find a merged body
+	 * @param DeviceName Device name, None to match the sensor index on any device
+	 * @param SensorIndex Sensor index within the device
+	 * @return Dense body ID in the merged sensor table, or INDEX_NONE if no source has reported it yet
+	 */
+	int32 FindBody(FName DeviceName, int32 SensorIndex) const;
+
+	/**
+	 * True once no source feeds a body any more, because its sensors were renamed to another body
+	 * A retired body keeps its last pose in the table but is never found or merged into again
+	 */
+	bool IsBodyRetired(int32 BodyId) const { return BodySourceCounts.IsValidIndex(BodyId) && BodySourceCounts[BodyId] == 0; }
+
+	/** Merged pose of every body */
+	const FVRPNSensorTable& GetSensorTable() const { return SensorTable; }
+
+	/** Game-thread copy of the merged table, refreshed by FinishFrame() */
+	const FVRPNSensorSnapshot& GetSensorSnapshot() const { return SensorSnapshot; }
+
+	/** Latest merged pose of any body */
+	const FVRPNTransformData& GetLastTransform() const { return LastTransform; }
+
+	/**
+	 * Source a body currently comes from
+	 * @param BodyId Dense body ID
+	 * @param OutSensorId Receives the body's dense sensor ID on that source's connection
+	 * @return nullptr if the body has no active source
+	 */
+	FVRPNSharedConnection* GetActiveSource(int32 BodyId, int32& OutSensorId) const;
+
+	/** Connections of every source, in source order */
+	TArray<FVRPNSharedConnection*> GetSourceConnections() const;
+
+	/** Forward a source's connection events to the subscribers */
+	void HandleSourceEstablished(int32 SourceIndex);
+	void HandleSourceLost(int32 SourceIndex, const FString& ErrorMessage);
+
+private:
+	friend class UVRPNSubsystem;
+
+	struct FSource
+	{
+		TSharedPtr<FVRPNSharedConnection> Connection;
+		int32 Priority = 0;
+		TMap<FName, int32> BodyPriorities;
+
+		/** Merged body ID per dense sensor ID of the source's connection (INDEX_NONE until resolved) */
+		TArray<int32> BodyIds;
+
+		/** Sender names version BodyIds were resolved against */
+		uint32 NamesVersion = 0;
+	};
+
+	/** Map a source sensor to its merged body, registering the body on first sight */
+	int32 ResolveBody(int32 SourceIndex, int32 SensorId);
+
+	/** Find or register the body a source sensor belongs to under its current device name */
+	int32 FindOrAddBody(int32 SourceIndex, int32 SensorId);
+
+	/** Move a source's resolved sensors to the bodies their current device names select, retiring bodies left unfed */
+	void RemapBodies(int32 SourceIndex);
+
+	/** Map every body to the subscribers that track it */
+	void RebuildSubscribers();
+
+	FString Key;
+	double StaleTimeout;
+
+	TArray<FSource> Sources;
+
+	/** Merged device ID per device name; a body's sender ID in the merged table is its device ID */
+	TMap<FName, int32> DeviceIds;
+
+	/** Merged pose per body; written by the game thread only, readable from any thread */
+	FVRPNSensorTable SensorTable;
+	FVRPNSensorSnapshot SensorSnapshot;
+	FVRPNTransformData LastTransform;
+
+	/** Per body: active source and that source's sensor ID */
+	TArray<int32> ActiveSources;
+	TArray<int32> ActiveSensorIds;
+
+	/** Per body: source sensors resolved to it; 0 once a registered body is retired */
+	TArray<int32> BodySourceCounts;
+
+	/** Per body and source (BodyId * NumSources + SourceIndex): newest sample time and priority */
+	TArray<double> SourceTimes;
+	TArray<int32> SourcePriorities;
+
+	/** Components subscribed to the fan-in; each unsubscribes on EndPlay, destroy or BeginDestroy */
+	TArray<UVRPNClient*> Subscribers;
+	TArray<TArray<UVRPNClient*>> SubscribersByBody;
+	TArray<UVRPNClient*> AllBodySubscribers;
+	bool bSubscribersDirty;
+
+	/** Newest merged sample per body since the last FinishFrame(), and each body's index into it */
+	TArray<FVRPNSensorUpdate> FrameUpdates;
+	TArray<int32> FrameUpdateIndices;
+
+	/** Frame the sources were last pumped on */
+	uint64 LastPumpFrame;
+};
@@ -0,0 +1,317 @@
+#include "VRPNFilterBank.h"
+#include "VRPNNameTable.h"
+#include "Math/VectorRegister.h"
+#include "Misc/ScopeLock.h"
+
+namespace VRPNFilter
+{
+	/** Smoothing factor of a first-order low-pass with the given cutoff, for one step of DeltaTime */
+	static double Alpha(double Cutoff, double DeltaTime)
+	{
+		const double Tau = 1.0 / (UE_TWO_PI * Cutoff);
+		return 1.0 / (1.0 + Tau / DeltaTime);
+	}
+}
+
+FVRPNFilterBank::FVRPNFilterBank(const FVRPNNameTable& InSenderNames)
+	: SettingsVersion(1)
+	, SenderNames(InSenderNames)
+	, ActiveVersion(0)
+	, ActiveNamesVersion(0)
+	, bAnyNamedSettings(false)
+	, ResolveEpoch(1)
+	, bAnyFilter(false)
+{
+}
+
+void FVRPNFilterBank::Initialize(int32 Capacity)
+{
+	const int32 NewCapacity = FMath::Max(Capacity, 1);
+
+	Params.Init(FParams(), NewCapacity);
+	ParamsVersions.Init(0, NewCapacity);
+	LastTimes.Init(0.0, NewCapacity);
+	Positions.Init(FVector::ZeroVector, NewCapacity);
+	Velocities.Init(FVector::ZeroVector, NewCapacity);
+	Rotations.Init(FQuat::Identity, NewCapacity);
+	AngularVelocities.Init(FVector::ZeroVector, NewCapacity);
+	Covariances.Init(FCovariance{ 0.0, 0.0, 0.0 }, NewCapacity);
+	RotationCovariances.Init(FCovariance{ 0.0, 0.0, 0.0 }, NewCapacity);
+
+	// Resolve every sensor again against the current settings
+	ActiveVersion = 0;
+	++ResolveEpoch;
+}
+
+void FVRPNFilterBank::SetSettings(FName SenderName, int32 SensorIndex, const FVRPNFilterSettings& Settings)
+{
+	FScopeLock Lock(&SettingsLock);
+	if (SenderName.IsNone() && SensorIndex == INDEX_NONE)
+	{
+		DefaultSettings = Settings;
+	}
+	else
+	{
+		SensorSettings.Add(FSettingsKey(SenderName, SensorIndex), Settings);
+	}
+	SettingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+FVRPNFilterBank::FParams FVRPNFilterBank::MakeParams(const FVRPNFilterSettings& Settings)
+{
+	FParams Result;
+	Result.Type = Settings.Type;
+	Result.MinCutoff = FMath::Max(Settings.MinCutoff, 0.01f);
+	Result.Beta = FMath::Max(Settings.Beta, 0.0f);
+	Result.DerivativeCutoff = FMath::Max(Settings.DerivativeCutoff, 0.01f);
+	Result.RotationMinCutoff = FMath::Max(Settings.RotationMinCutoff, 0.01f);
+	Result.RotationBeta = FMath::Max(Settings.RotationBeta, 0.0f);
+	Result.ProcessVariance = FMath::Square(double(Settings.ProcessNoise));
+	Result.MeasurementVariance = FMath::Square(FMath::Max(double(Settings.MeasurementNoise), 0.001));
+	Result.RotationProcessVariance = FMath::Square(FMath::DegreesToRadians(double(Settings.RotationProcessNoise)));
+	Result.RotationMeasurementVariance = FMath::Square(FMath::DegreesToRadians(FMath::Max(double(Settings.RotationMeasurementNoise), 0.001)));
+	return Result;
+}
+
+void FVRPNFilterBank::RefreshSettings()
+{
+	// A new device may match settings given by name
+	if (bAnyNamedSettings)
+	{
+		const uint32 NamesVersion = SenderNames.GetVersion();
+		if (NamesVersion != ActiveNamesVersion)
+		{
+			ActiveNamesVersion = NamesVersion;
+			++ResolveEpoch;
+		}
+	}
+
+	const uint32 Version = SettingsVersion.load(std::memory_order_acquire);
+	if (Version == ActiveVersion)
+	{
+		return;
+	}
+
+	// Only taken when the game thread changed something, never on the steady-state path
+	FScopeLock Lock(&SettingsLock);
+	ActiveDefault = MakeParams(DefaultSettings);
+	bAnyFilter = ActiveDefault.Type != EVRPNFilterType::None;
+	bAnyNamedSettings = false;
+
+	ActiveSensorParams.Reset();
+	for (const TPair<FSettingsKey, FVRPNFilterSettings>& Pair : SensorSettings)
+	{
+		ActiveSensorParams.Add(Pair.Key, MakeParams(Pair.Value));
+		bAnyFilter |= Pair.Value.Type != EVRPNFilterType::None;
+		bAnyNamedSettings |= !Pair.Key.Key.IsNone();
+	}
+	ActiveVersion = SettingsVersion.load(std::memory_order_relaxed);
+	ActiveNamesVersion = SenderNames.GetVersion();
+	++ResolveEpoch;
+}
+
+const FVRPNFilterBank::FParams& FVRPNFilterBank::ResolveParams(int32 SenderId, int32 SensorIndex) const
+{
+	if (bAnyNamedSettings)
+	{
+		FString Name;
+		if (SenderNames.GetName(SenderId, Name))
+		{
+			if (const FParams* Found = ActiveSensorParams.Find(FSettingsKey(FName(*Name), SensorIndex)))
+			{
+				return *Found;
+			}
+		}
+	}
+
+	const FParams* Found = ActiveSensorParams.Find(FSettingsKey(NAME_None, SensorIndex));
+	return Found ? *Found : ActiveDefault;
+}
+
+void FVRPNFilterBank::ResetState(int32 SensorId, const FVRPNTrackerSample& Sample, const FParams& SensorParams)
+{
+	Positions[SensorId] = Sample.Position;
+	Velocities[SensorId] = FVector::ZeroVector;
+	Rotations[SensorId] = Sample.Rotation;
+	AngularVelocities[SensorId] = FVector::ZeroVector;
+
+	// Position known to measurement accuracy, velocity unknown
+	Covariances[SensorId] = FCovariance{ SensorParams.MeasurementVariance, 0.0, SensorParams.ProcessVariance };
+	RotationCovariances[SensorId] = FCovariance{ SensorParams.RotationMeasurementVariance, 0.0, SensorParams.RotationProcessVariance };
+}
+
+void FVRPNFilterBank::KalmanStep(FCovariance& P, double ProcessVariance, double MeasurementVariance, double DeltaTime, double& OutValueGain, double& OutRateGain)
+{
+	// Predict with constant rate, its change as white noise
+	const double Q = ProcessVariance;
+	const double DeltaTime2 = DeltaTime * DeltaTime;
+	const double P00 = P.P00 + DeltaTime * (2.0 * P.P01 + DeltaTime * P.P11) + Q * DeltaTime2 * DeltaTime2 * 0.25;
+	const double P01 = P.P01 + DeltaTime * P.P11 + Q * DeltaTime2 * DeltaTime * 0.5;
+	const double P11 = P.P11 + Q * DeltaTime2;
+
+	// Correct with the measurement
+	const double Innovation = 1.0 / (P00 + MeasurementVariance);
+	OutValueGain = P00 * Innovation;
+	OutRateGain = P01 * Innovation;
+
+	P.P00 = (1.0 - OutValueGain) * P00;
+	P.P01 = (1.0 - OutValueGain) * P01;
+	P.P11 = P11 - OutRateGain * P01;
+}
+
+void FVRPNFilterBank::FilterBatch(TArrayView<FVRPNTrackerSample> Samples, TConstArrayView<int32> SensorIds, TConstArrayView<double> Timestamps,
+	TArrayView<FVector> OutVelocities, TArrayView<FVector> OutAngularVelocities)
+{
+	RefreshSettings();
+
+	if (!bAnyFilter)
+	{
+		for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+		{
+			OutVelocities[SampleIndex] = FVector::ZeroVector;
+			OutAngularVelocities[SampleIndex] = FVector::ZeroVector;
+		}
+		return;
+	}
+
+	for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+	{
+		OutVelocities[SampleIndex] = FVector::ZeroVector;
+		OutAngularVelocities[SampleIndex] = FVector::ZeroVector;
+
+		const int32 SensorId = SensorIds[SampleIndex];
+		if (SensorId == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FVRPNTrackerSample& Sample = Samples[SampleIndex];
+		if (ParamsVersions[SensorId] != ResolveEpoch)
+		{
+			const FParams& NewParams = ResolveParams(Sample.SenderId, Sample.SensorIndex);
+			if (NewParams.Type != Params[SensorId].Type)
+			{
+				LastTimes[SensorId] = 0.0;
+			}
+			Params[SensorId] = NewParams;
+			ParamsVersions[SensorId] = ResolveEpoch;
+		}
+
+		const FParams& SensorParams = Params[SensorId];
+		if (SensorParams.Type == EVRPNFilterType::None)
+		{
+			continue;
+		}
+
+		const double Timestamp = Timestamps[SampleIndex];
+		const double DeltaTime = Timestamp - LastTimes[SensorId];
+		if (LastTimes[SensorId] <= 0.0 || DeltaTime > MaxGapSeconds)
+		{
+			ResetState(SensorId, Sample, SensorParams);
+			LastTimes[SensorId] = Timestamp;
+			continue;
+		}
+
+		if (DeltaTime > 0.0)
+		{
+			FilterPosition(SensorId, SensorParams, DeltaTime, Sample.Position);
+			FilterRotation(SensorId, SensorParams, DeltaTime, Sample.Rotation);
+			LastTimes[SensorId] = Timestamp;
+		}
+		else
+		{
+			// Duplicate or reordered measurement: it cannot move the state backwards, report the current estimate
+			Sample.Position = Positions[SensorId];
+			Sample.Rotation = Rotations[SensorId];
+		}
+
+		OutVelocities[SampleIndex] = Velocities[SensorId];
+		OutAngularVelocities[SampleIndex] = AngularVelocities[SensorId];
+	}
+}
+
+void FVRPNFilterBank::FilterPosition(int32 SensorId, const FParams& SensorParams, double DeltaTime, FVector& InOutPosition)
+{
+	const VectorRegister4Double Measured = VectorLoadFloat3(&InOutPosition.X);
+	const VectorRegister4Double Previous = VectorLoadFloat3(&Positions[SensorId].X);
+	const VectorRegister4Double PreviousVelocity = VectorLoadFloat3(&Velocities[SensorId].X);
+	VectorRegister4Double Position;
+	VectorRegister4Double Velocity;
+
+	if (SensorParams.Type == EVRPNFilterType::Kalman)
+	{
+		// Acceleration as white noise; the gains are the same for all three axes
+		double PositionGain;
+		double VelocityGain;
+		KalmanStep(Covariances[SensorId], SensorParams.ProcessVariance, SensorParams.MeasurementVariance, DeltaTime, PositionGain, VelocityGain);
+
+		const VectorRegister4Double Predicted = VectorMultiplyAdd(PreviousVelocity, VectorSetFloat1(DeltaTime), Previous);
+		const VectorRegister4Double Residual = VectorSubtract(Measured, Predicted);
+		Position = VectorMultiplyAdd(Residual, VectorSetFloat1(PositionGain), Predicted);
+		Velocity = VectorMultiplyAdd(Residual, VectorSetFloat1(VelocityGain), PreviousVelocity);
+	}
+	else
+	{
+		// One Euro: smooth the speed, then low-pass the position with a cutoff that rises with it
+		const VectorRegister4Double RawVelocity = VectorMultiply(VectorSubtract(Measured, Previous), VectorSetFloat1(1.0 / DeltaTime));
+		const double DerivativeAlpha = VRPNFilter::Alpha(SensorParams.DerivativeCutoff, DeltaTime);
+		Velocity = VectorMultiplyAdd(VectorSubtract(RawVelocity, PreviousVelocity), VectorSetFloat1(DerivativeAlpha), PreviousVelocity);
+
+		const double Speed = FMath::Sqrt(VectorGetComponent(VectorDot3(Velocity, Velocity), 0));
+		const double PositionAlpha = VRPNFilter::Alpha(SensorParams.MinCutoff + SensorParams.Beta * Speed, DeltaTime);
+		Position = VectorMultiplyAdd(VectorSubtract(Measured, Previous), VectorSetFloat1(PositionAlpha), Previous);
+	}
+
+	VectorStoreFloat3(Position, &Positions[SensorId].X);
+	VectorStoreFloat3(Velocity, &Velocities[SensorId].X);
+	InOutPosition = Positions[SensorId];
+}
+
+void FVRPNFilterBank::FilterRotation(int32 SensorId, const FParams& SensorParams, double DeltaTime, FQuat& InOutRotation)
+{
+	const FQuat& Previous = Rotations[SensorId];
+
+	// Same hemisphere as the previous estimate, so the delta is the short way round
+	FQuat Measured = InOutRotation;
+	if ((Measured | Previous) < 0.0)
+	{
+		Measured = Measured * -1.0;
+	}
+
+	if (SensorParams.Type == EVRPNFilterType::Kalman)
+	{
+		// Predict with constant angular velocity, then correct along the rotation vector of the residual; for the
+		// small residuals between samples its three components behave like independent axes
+		double RotationGain;
+		double AngularVelocityGain;
+		KalmanStep(RotationCovariances[SensorId], SensorParams.RotationProcessVariance, SensorParams.RotationMeasurementVariance, DeltaTime,
+			RotationGain, AngularVelocityGain);
+
+		const FVector PreviousAngularVelocity = AngularVelocities[SensorId];
+		const FQuat Predicted = (FQuat::MakeFromRotationVector(PreviousAngularVelocity * DeltaTime) * Previous).GetNormalized();
+		FQuat Residual = Measured * Predicted.Inverse();
+		if (Residual.W < 0.0)
+		{
+			Residual = Residual * -1.0;
+		}
+		const FVector ResidualVector = Residual.ToRotationVector();
+
+		Rotations[SensorId] = (FQuat::MakeFromRotationVector(ResidualVector * RotationGain) * Predicted).GetNormalized();
+		AngularVelocities[SensorId] = PreviousAngularVelocity + ResidualVector * AngularVelocityGain;
+		InOutRotation = Rotations[SensorId];
+		return;
+	}
+
+	FVector Axis;
+	double Angle;
+	(Measured * Previous.Inverse()).ToAxisAndAngle(Axis, Angle);
+	const FVector RawAngularVelocity = Axis * (Angle / DeltaTime);
+
+	const double DerivativeAlpha = VRPNFilter::Alpha(SensorParams.DerivativeCutoff, DeltaTime);
+	const FVector AngularVelocity = FMath::Lerp(AngularVelocities[SensorId], RawAngularVelocity, DerivativeAlpha);
+
+	const double RotationAlpha = VRPNFilter::Alpha(SensorParams.RotationMinCutoff + SensorParams.RotationBeta * AngularVelocity.Size(), DeltaTime);
+	Rotations[SensorId] = FQuat::Slerp(Previous, Measured, RotationAlpha).GetNormalized();
+	AngularVelocities[SensorId] = AngularVelocity;
+	InOutRotation = Rotations[SensorId];
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "VRPN/VRPNTypes.h"
+#include "VRPNMessageParser.h"
+#include <atomic>
+
+class FVRPNNameTable;
+
+/**
+ * Noise filters for every sensor of a connection, run on the receive thread
+ *
+ * Filter state lives in structure-of-arrays storage indexed by dense sensor ID and is touched by
+ * the receive thread only. Each datagram's samples go through one pass, one sample at a time in
+ * arrival order since a sensor's consecutive samples depend on each other. Position is filtered
+ * with all three axes in one SIMD register; rotation gets the same filter type, on angular speed
+ * (One Euro) or as a constant angular velocity model on the rotation error (Kalman). The pass
+ * yields linear and angular velocity for prediction. Everything downstream, the game thread
+ * included, only ever sees the filtered pose.
+ *
+ * Settings are per device name and sensor index with a connection-wide default. The game thread
+ * may change them at any time; the receive thread picks up a new version at its next datagram.
+ * Each sensor resolves its settings once (again only when settings change or the server
+ * describes new devices), so the per-sample path never looks at a name.
+ */
+class FVRPNFilterBank
+{
+public:
+	/** @param InSenderNames Device names of the connection, to match settings given per device */
+	explicit FVRPNFilterBank(const FVRPNNameTable& InSenderNames);
+
+	/**
+	 * Allocate filter state for a fixed number of sensors (call before the receive thread starts)
+	 * @param Capacity Capacity of the connection's sensor table
+	 */
+	void Initialize(int32 Capacity);
+
+	/**
+	 * Set the filter of one sensor, or the default of sensors without their own (game thread)
+	 * @param SenderName Device name, None for the sensor index of any device
+	 * @param SensorIndex Server-side sensor index, INDEX_NONE (with no device name) for the default
+	 * @param Settings Filter type and parameters
+	 */
+	void SetSettings(FName SenderName, int32 SensorIndex, const FVRPNFilterSettings& Settings);
+
+	/**
+	 * Filter one datagram's samples in place (receive thread only)
+	 * @param Samples Samples in Unreal space
+	 * @param SensorIds Dense sensor ID per sample, INDEX_NONE for samples that are not published
+	 * @param Timestamps Measurement time per sample on the local clock
+	 * @param OutVelocities Receives the linear velocity per sample (zero when unfiltered)
+	 * @param OutAngularVelocities Receives the angular velocity per sample (zero when unfiltered)
+	 */
+	void FilterBatch(TArrayView<FVRPNTrackerSample> Samples, TConstArrayView<int32> SensorIds, TConstArrayView<double> Timestamps,
+		TArrayView<FVector> OutVelocities, TArrayView<FVector> OutAngularVelocities);
+
+private:
+	/** Parameters of one sensor in the form the update uses */
+	struct FParams
+	{
+		EVRPNFilterType Type = EVRPNFilterType::None;
+		double MinCutoff = 1.0;
+		double Beta = 0.0;
+		double DerivativeCutoff = 1.0;
+		double RotationMinCutoff = 1.0;
+		double RotationBeta = 0.0;
+		double ProcessVariance = 0.0;
+		double MeasurementVariance = 1.0;
+		double RotationProcessVariance = 0.0;
+		double RotationMeasurementVariance = 1.0;
+	};
+
+	/** Kalman error covariance of one axis; all three axes share it (same noise, same updates) */
+	struct FCovariance
+	{
+		double P00;
+		double P01;
+		double P11;
+	};
+
+	/**
+	 * Constant-velocity Kalman step of one axis's covariance: predict over DeltaTime, then correct with a measurement
+	 * @param OutValueGain Gain applied to the residual for the value
+	 * @param OutRateGain Gain applied to the residual for its rate of change
+	 */
+	static void KalmanStep(FCovariance& P, double ProcessVariance, double MeasurementVariance, double DeltaTime, double& OutValueGain, double& OutRateGain);
+
+	static FParams MakeParams(const FVRPNFilterSettings& Settings);
+
+	/** Settings key: device name (None = any) and sensor index */
+	using FSettingsKey = TPair<FName, int32>;
+
+	/** Copy settings published since the last batch and notice new device names (receive thread) */
+	void RefreshSettings();
+
+	/** Parameters that apply to a sensor (receive thread) */
+	const FParams& ResolveParams(int32 SenderId, int32 SensorIndex) const;
+
+	/** Start a sensor's state over from a measurement */
+	void ResetState(int32 SensorId, const FVRPNTrackerSample& Sample, const FParams& SensorParams);
+
+	/** One Euro or Kalman step of a sensor's position; returns the filtered position */
+	void FilterPosition(int32 SensorId, const FParams& SensorParams, double DeltaTime, FVector& InOutPosition);
+
+	/** One Euro or Kalman step of a sensor's rotation; returns the filtered rotation */
+	void FilterRotation(int32 SensorId, const FParams& SensorParams, double DeltaTime, FQuat& InOutRotation);
+
+	/** Settings written by the game thread, guarded by SettingsLock */
+	FCriticalSection SettingsLock;
+	FVRPNFilterSettings DefaultSettings;
+	TMap<FSettingsKey, FVRPNFilterSettings> SensorSettings;
+
+	/** Bumped on every SetSettings(); the receive thread compares it once per datagram */
+	std::atomic<uint32> SettingsVersion;
+
+	const FVRPNNameTable& SenderNames;
+
+	/** Receive thread copy of the settings */
+	uint32 ActiveVersion;
+	uint32 ActiveNamesVersion;
+	FParams ActiveDefault;
+	TMap<FSettingsKey, FParams> ActiveSensorParams;
+
+	/** Any settings given per device name; otherwise resolving never needs the name table */
+	bool bAnyNamedSettings;
+
+	/** Advanced whenever settings or device names change; sensors resolve again when theirs is older */
+	uint32 ResolveEpoch;
+
+	/** Any sensor filtered at all; when false a batch only clears the velocities */
+	bool bAnyFilter;
+
+	/** Per-sensor parameters and the epoch they were resolved in */
+	TArray<FParams> Params;
+	TArray<uint32> ParamsVersions;
+
+	/** Per-sensor filter state */
+	TArray<double> LastTimes;
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FQuat> Rotations;
+	TArray<FVector> AngularVelocities;
+	TArray<FCovariance> Covariances;
+	TArray<FCovariance> RotationCovariances;
+
+	/** A sensor silent for longer than this restarts from its next measurement */
+	static constexpr double MaxGapSeconds = 0.5;
+};
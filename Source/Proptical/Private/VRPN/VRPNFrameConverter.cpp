@@ -0,0 +1,162 @@
+#include "VRPNFrameConverter.h"
+#include "VRPN/VRPNLog.h"
+
+namespace VRPNFrame
+{
+	/** Source component index and sign of a signed axis */
+	static void DecodeAxis(EVRPNAxis Axis, int32& OutIndex, double& OutSign)
+	{
+		OutIndex = static_cast<int32>(Axis) / 2;
+		OutSign = (static_cast<int32>(Axis) % 2) == 0 ? 1.0 : -1.0;
+	}
+
+	/** Axis mapping (Unreal X, Y, Z from source axes) of a preset */
+	static void GetPresetAxes(EVRPNSourceAxes Preset, EVRPNAxis& OutForward, EVRPNAxis& OutRight, EVRPNAxis& OutUp)
+	{
+		switch (Preset)
+		{
+		case EVRPNSourceAxes::RightHandedYUp:
+			OutForward = EVRPNAxis::NegativeZ;
+			OutRight = EVRPNAxis::PositiveX;
+			OutUp = EVRPNAxis::PositiveY;
+			break;
+
+		case EVRPNSourceAxes::RightHandedZUp:
+		default:
+			OutForward = EVRPNAxis::PositiveX;
+			OutRight = EVRPNAxis::NegativeY;
+			OutUp = EVRPNAxis::PositiveZ;
+			break;
+		}
+	}
+}
+
+FVRPNFrameConverter::FVRPNFrameConverter()
+	: ActiveVersion(0)
+{
+	Active = BuildKernel(FVRPNFrameConversion());
+}
+
+FVRPNFrameKernel FVRPNFrameConverter::BuildKernel(const FVRPNFrameConversion& Conversion)
+{
+	FVRPNFrameKernel Kernel;
+	Kernel.bIdentity = !Conversion.bEnabled;
+
+	EVRPNAxis Axes[3] = { Conversion.ForwardAxis, Conversion.RightAxis, Conversion.UpAxis };
+	if (Conversion.SourceAxes != EVRPNSourceAxes::Custom)
+	{
+		VRPNFrame::GetPresetAxes(Conversion.SourceAxes, Axes[0], Axes[1], Axes[2]);
+	}
+
+	// Signed permutation: Unreal axis Row takes source component Index with Sign
+	double Axis[3][3] = {};
+	uint32 UsedComponents = 0;
+	for (int32 Row = 0; Row < 3; ++Row)
+	{
+		int32 Index = 0;
+		double Sign = 1.0;
+		VRPNFrame::DecodeAxis(Axes[Row], Index, Sign);
+		Axis[Row][Index] = Sign;
+		UsedComponents |= 1u << Index;
+	}
+
+	if (UsedComponents != 0b111)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Frame conversion maps one source axis to several Unreal axes; using the Z-up preset instead"));
+		FVRPNFrameConversion Fallback = Conversion;
+		Fallback.SourceAxes = EVRPNSourceAxes::RightHandedZUp;
+		return BuildKernel(Fallback);
+	}
+
+	const double Determinant =
+		Axis[0][0] * (Axis[1][1] * Axis[2][2] - Axis[1][2] * Axis[2][1]) -
+		Axis[0][1] * (Axis[1][0] * Axis[2][2] - Axis[1][2] * Axis[2][0]) +
+		Axis[0][2] * (Axis[1][0] * Axis[2][1] - Axis[1][1] * Axis[2][0]);
+
+	const FQuat CalibrationRotation = Conversion.CalibrationOffset.GetRotation().GetNormalized();
+	const FVector CalibrationTranslation = Conversion.CalibrationOffset.GetTranslation();
+	const double Scale = Conversion.UnitScale;
+
+	for (int32 Column = 0; Column < 3; ++Column)
+	{
+		const FVector AxisColumn(Axis[0][Column], Axis[1][Column], Axis[2][Column]);
+		const FVector PositionColumn = CalibrationRotation.RotateVector(AxisColumn) * Scale;
+		Kernel.PositionColumns[Column] = VectorSet(PositionColumn.X, PositionColumn.Y, PositionColumn.Z, 0.0);
+
+		// A reflection reverses the sense of rotation, which negates the quaternion's vector part
+		const FVector RotationColumn = AxisColumn * Determinant;
+		Kernel.RotationColumns[Column] = VectorSet(RotationColumn.X, RotationColumn.Y, RotationColumn.Z, 0.0);
+	}
+	Kernel.RotationColumns[3] = VectorSet(0.0, 0.0, 0.0, 1.0);
+
+	Kernel.Translation = VectorSet(CalibrationTranslation.X, CalibrationTranslation.Y, CalibrationTranslation.Z, 0.0);
+	Kernel.CalibrationRotation = VectorSet(CalibrationRotation.X, CalibrationRotation.Y, CalibrationRotation.Z, CalibrationRotation.W);
+	return Kernel;
+}
+
+void FVRPNFrameConverter::SetConversion(const FVRPNFrameConversion& Conversion)
+{
+	Published.Write(BuildKernel(Conversion));
+}
+
+void FVRPNFrameConverter::ConvertBatch(TArrayView<FVRPNTrackerSample> Samples)
+{
+	const uint32 Version = Published.GetWriteCount();
+	if (Version != ActiveVersion)
+	{
+		Published.Read(Active);
+		ActiveVersion = Version;
+	}
+
+	if (Active.bIdentity)
+	{
+		return;
+	}
+
+	const FVRPNFrameKernel& Kernel = Active;
+	for (FVRPNTrackerSample& Sample : Samples)
+	{
+		// Position: P' = Columns * P + T, one multiply-add per source component
+		const VectorRegister4Double Position = VectorLoadFloat3(&Sample.Position.X);
+		VectorRegister4Double OutPosition = VectorMultiplyAdd(Kernel.PositionColumns[0], VectorReplicate(Position, 0), Kernel.Translation);
+		OutPosition = VectorMultiplyAdd(Kernel.PositionColumns[1], VectorReplicate(Position, 1), OutPosition);
+		OutPosition = VectorMultiplyAdd(Kernel.PositionColumns[2], VectorReplicate(Position, 2), OutPosition);
+		VectorStoreFloat3(OutPosition, &Sample.Position.X);
+
+		// Rotation: remap the axis components, keep W, then apply the calibration rotation
+		const VectorRegister4Double Rotation = VectorLoad(&Sample.Rotation.X);
+		VectorRegister4Double OutRotation = VectorMultiply(Kernel.RotationColumns[3], VectorReplicate(Rotation, 3));
+		OutRotation = VectorMultiplyAdd(Kernel.RotationColumns[0], VectorReplicate(Rotation, 0), OutRotation);
+		OutRotation = VectorMultiplyAdd(Kernel.RotationColumns[1], VectorReplicate(Rotation, 1), OutRotation);
+		OutRotation = VectorMultiplyAdd(Kernel.RotationColumns[2], VectorReplicate(Rotation, 2), OutRotation);
+		OutRotation = VectorQuaternionMultiply2(Kernel.CalibrationRotation, OutRotation);
+		VectorStore(OutRotation, &Sample.Rotation.X);
+	}
+}
+
+void FVRPNFrameConverter::ConvertDerivatives(TArrayView<FVRPNTrackerDerivative> Derivatives) const
+{
+	if (Active.bIdentity)
+	{
+		return;
+	}
+
+	const FVRPNFrameKernel& Kernel = Active;
+	for (FVRPNTrackerDerivative& Derivative : Derivatives)
+	{
+		// Linear rate: P' = Columns * P, the position transform without its translation
+		const VectorRegister4Double Linear = VectorLoadFloat3(&Derivative.Linear.X);
+		VectorRegister4Double OutLinear = VectorMultiply(Kernel.PositionColumns[0], VectorReplicate(Linear, 0));
+		OutLinear = VectorMultiplyAdd(Kernel.PositionColumns[1], VectorReplicate(Linear, 1), OutLinear);
+		OutLinear = VectorMultiplyAdd(Kernel.PositionColumns[2], VectorReplicate(Linear, 2), OutLinear);
+		VectorStoreFloat3(OutLinear, &Derivative.Linear.X);
+
+		// Angular rate is an axis: remapped like a quaternion's vector part (unscaled), then calibration-rotated
+		const VectorRegister4Double Angular = VectorLoadFloat3_W0(&Derivative.Angular.X);
+		VectorRegister4Double OutAngular = VectorMultiply(Kernel.RotationColumns[0], VectorReplicate(Angular, 0));
+		OutAngular = VectorMultiplyAdd(Kernel.RotationColumns[1], VectorReplicate(Angular, 1), OutAngular);
+		OutAngular = VectorMultiplyAdd(Kernel.RotationColumns[2], VectorReplicate(Angular, 2), OutAngular);
+		OutAngular = VectorQuaternionRotateVector(Kernel.CalibrationRotation, OutAngular);
+		VectorStoreFloat3(OutAngular, &Derivative.Angular.X);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+#include "VRPN/VRPNTypes.h"
+#include "VRPNMessageParser.h"
+#include "VRPNSeqLock.h"
+
+/**
+ * Precomputed constants of a frame conversion, in SIMD registers
+ *
+ * Axis remap, handedness flip, unit scale and calibration rotation are folded into one 3x3 matrix
+ * for positions. Rotations go through the signed axis permutation (negated when it flips
+ * handedness) followed by the calibration rotation.
+ */
+struct FVRPNFrameKernel
+{
+	/** Columns of Scale * CalibrationRotation * AxisMatrix (W lane unused) */
+	VectorRegister4Double PositionColumns[3];
+
+	/** Calibration translation (W lane unused) */
+	VectorRegister4Double Translation;
+
+	/** Columns of the quaternion remap: X, Y, Z map through det(AxisMatrix) * AxisMatrix, W is kept */
+	VectorRegister4Double RotationColumns[4];
+
+	/** Calibration rotation (X, Y, Z, W) */
+	VectorRegister4Double CalibrationRotation;
+
+	/** Conversion disabled: samples are left untouched */
+	bool bIdentity;
+};
+
+/**
+ * Converts tracker samples into Unreal space on the receive thread
+ *
+ * The game thread publishes new settings through a sequence lock at any time; the receive thread
+ * picks them up at its next datagram, so calibration can be adjusted live without stopping the
+ * connection.
+ */
+class FVRPNFrameConverter
+{
+public:
+	FVRPNFrameConverter();
+
+	/**
+	 * Publish new settings (game thread)
+	 * Takes effect from the next datagram the receive thread processes
+	 */
+	void SetConversion(const FVRPNFrameConversion& Conversion);
+
+	/**
+	 * Convert positions and rotations in place (receive thread only)
+	 * @param Samples Samples decoded from one datagram
+	 */
+	void ConvertBatch(TArrayView<FVRPNTrackerSample> Samples);
+
+	/**
+	 * Convert velocity and acceleration reports in place (receive thread only, after ConvertBatch() of the same datagram)
+	 * Rates are directions, so they take the axis remap, unit scale and calibration rotation but no translation
+	 * @param Derivatives Reports decoded from one datagram
+	 */
+	void ConvertDerivatives(TArrayView<FVRPNTrackerDerivative> Derivatives) const;
+
+	/**
+	 * Build the kernel constants for a conversion
+	 * Invalid custom axis mappings (an axis used twice) fall back to the Z-up preset
+	 */
+	static FVRPNFrameKernel BuildKernel(const FVRPNFrameConversion& Conversion);
+
+private:
+	/** Settings published by the game thread */
+	TVRPNSeqLock<FVRPNFrameKernel> Published;
+
+	/** Receive thread copy, refreshed when the publish count changes */
+	FVRPNFrameKernel Active;
+	uint32 ActiveVersion;
+};
@@ -0,0 +1,113 @@
+#include "VRPNJitterBuffer.h"
+
+FVRPNJitterBuffer::FVRPNJitterBuffer(int32 InCapacity)
+	: Head(0)
+	, Count(0)
+	, LastArrivalTime(0.0)
+	, ArrivalInterval(0.0)
+	, ArrivalJitter(0.0)
+{
+	Entries.SetNumZeroed(FMath::Max(InCapacity, 2));
+}
+
+void FVRPNJitterBuffer::Reset()
+{
+	Head = 0;
+	Count = 0;
+	LastArrivalTime = 0.0;
+	ArrivalInterval = 0.0;
+	ArrivalJitter = 0.0;
+}
+
+void FVRPNJitterBuffer::Push(double SampleTime, double ArrivalTime, const FVector& Position, const FQuat& Rotation)
+{
+	if (Count > 0 && SampleTime <= GetNewestTime())
+	{
+		return;
+	}
+
+	if (Count > 0)
+	{
+		// Exponential averages with a 1/16 gain, as RTP does for interarrival jitter
+		const double Interval = ArrivalTime - LastArrivalTime;
+		ArrivalInterval = (ArrivalInterval == 0.0) ? Interval : ArrivalInterval + (Interval - ArrivalInterval) / 16.0;
+		ArrivalJitter += (FMath::Abs(Interval - ArrivalInterval) - ArrivalJitter) / 16.0;
+	}
+	LastArrivalTime = ArrivalTime;
+
+	Entries[Head] = FEntry{ SampleTime, Position, Rotation };
+	Head = (Head + 1) % Entries.Num();
+	Count = FMath::Min(Count + 1, Entries.Num());
+}
+
+EVRPNJitterSample FVRPNJitterBuffer::Sample(double Time, double MaxExtrapolation, FVector& OutPosition, FQuat& OutRotation) const
+{
+	if (Count == 0)
+	{
+		return EVRPNJitterSample::Empty;
+	}
+
+	const FEntry& Newest = At(Count - 1);
+	if (Time >= Newest.Time)
+	{
+		OutPosition = Newest.Position;
+		OutRotation = Newest.Rotation;
+		if (Count < 2 || MaxExtrapolation <= 0.0)
+		{
+			return EVRPNJitterSample::Held;
+		}
+
+		// Data is late: keep moving at the last observed velocity, but only for a bounded time
+		const FEntry& Previous = At(Count - 2);
+		const double Interval = Newest.Time - Previous.Time;
+		if (Interval <= UE_SMALL_NUMBER)
+		{
+			return EVRPNJitterSample::Held;
+		}
+
+		const double Ahead = FMath::Min(Time - Newest.Time, MaxExtrapolation);
+		const double Alpha = Ahead / Interval;
+		OutPosition = Newest.Position + (Newest.Position - Previous.Position) * Alpha;
+
+		FQuat Delta = Newest.Rotation * Previous.Rotation.Inverse();
+		if (Delta.W < 0.0)
+		{
+			// Same rotation, shortest arc
+			Delta *= -1.0;
+		}
+		OutRotation = (FQuat(Delta.GetRotationAxis(), Delta.GetAngle() * Alpha) * Newest.Rotation).GetNormalized();
+
+		return (Time - Newest.Time <= MaxExtrapolation) ? EVRPNJitterSample::Extrapolated : EVRPNJitterSample::Held;
+	}
+
+	const FEntry& Oldest = At(0);
+	if (Time <= Oldest.Time)
+	{
+		OutPosition = Oldest.Position;
+		OutRotation = Oldest.Rotation;
+		return EVRPNJitterSample::Held;
+	}
+
+	// Binary search for the first sample after Time; it and its predecessor bracket Time
+	int32 Low = 1;
+	int32 High = Count - 1;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (At(Mid).Time > Time)
+		{
+			High = Mid;
+		}
+		else
+		{
+			Low = Mid + 1;
+		}
+	}
+
+	const FEntry& After = At(Low);
+	const FEntry& Before = At(Low - 1);
+	const double Alpha = (Time - Before.Time) / (After.Time - Before.Time);
+	OutPosition = FMath::Lerp(Before.Position, After.Position, Alpha);
+	OutRotation = FQuat::Slerp(Before.Rotation, After.Rotation, Alpha);
+	return EVRPNJitterSample::Interpolated;
+}
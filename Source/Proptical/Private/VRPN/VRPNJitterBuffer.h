@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Outcome of sampling a jitter buffer
+ */
+enum class EVRPNJitterSample : uint8
+{
+	/** No samples yet */
+	Empty,
+
+	/** Interpolated between the two samples bracketing the requested time */
+	Interpolated,
+
+	/** Requested time is past the newest sample; projected forward from the last two samples */
+	Extrapolated,
+
+	/** Requested time is outside what can be interpolated or extrapolated; nearest sample returned */
+	Held
+};
+
+/**
+ * Per-sensor pose history with timestamp-driven playout
+ *
+ * Samples are kept in a fixed-size ring ordered by time. Sample() returns the pose at an
+ * arbitrary time by interpolating between the bracketing samples, or by extrapolating at
+ * constant velocity for a bounded time when the requested time is past the newest sample.
+ * The buffer also tracks the mean arrival interval and arrival jitter so the caller can pick
+ * the smallest playout delay the network allows.
+ */
+class FVRPNJitterBuffer
+{
+public:
+	/**
+	 * @param InCapacity Number of samples kept
+	 */
+	explicit FVRPNJitterBuffer(int32 InCapacity = 64);
+
+	/** Drop all samples and arrival statistics */
+	void Reset();
+
+	/**
+	 * Add a sample; samples not newer than the newest one are ignored
+	 * @param SampleTime Time the pose was valid (playout timeline)
+	 * @param ArrivalTime Local time the sample arrived (used for jitter estimation)
+	 */
+	void Push(double SampleTime, double ArrivalTime, const FVector& Position, const FQuat& Rotation);
+
+	/**
+	 * Get the pose at a given time
+	 * @param Time Time to sample on the playout timeline
+	 * @param MaxExtrapolation Longest time to project past the newest sample (seconds)
+	 * @return How the pose was obtained
+	 */
+	EVRPNJitterSample Sample(double Time, double MaxExtrapolation, FVector& OutPosition, FQuat& OutRotation) const;
+
+	/** Number of samples held */
+	int32 Num() const { return Count; }
+
+	/** Time of the newest sample (0 if empty) */
+	double GetNewestTime() const { return Count > 0 ? At(Count - 1).Time : 0.0; }
+
+	/** Smoothed interval between sample arrivals (seconds) */
+	double GetArrivalInterval() const { return ArrivalInterval; }
+
+	/** Smoothed mean deviation of the arrival interval (seconds, RFC 3550 style) */
+	double GetArrivalJitter() const { return ArrivalJitter; }
+
+private:
+	struct FEntry
+	{
+		double Time;
+		FVector Position;
+		FQuat Rotation;
+	};
+
+	/** Entry by age: 0 is the oldest, Count - 1 the newest */
+	const FEntry& At(int32 Index) const { return Entries[(Head + Entries.Num() - Count + Index) % Entries.Num()]; }
+
+	/** Ring storage */
+	TArray<FEntry> Entries;
+
+	/** Next slot to write */
+	int32 Head;
+
+	/** Number of valid entries */
+	int32 Count;
+
+	/** Arrival time of the newest sample */
+	double LastArrivalTime;
+
+	/** Arrival statistics */
+	double ArrivalInterval;
+	double ArrivalJitter;
+};
@@ -0,0 +1,122 @@
+#include "VRPNLateUpdate.h"
+#include "VRPNConnectionManager.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "RenderingThread.h"
+#include "SceneView.h"
+
+FVRPNLateUpdateExtension::FVRPNLateUpdateExtension(const FAutoRegister& AutoRegister)
+	: FSceneViewExtensionBase(AutoRegister)
+	, bHasViewDelta(false)
+	, bActive(false)
+{
+}
+
+void FVRPNLateUpdateExtension::Setup(USceneComponent* Component, const TSharedPtr<FVRPNConnectionManager>& Manager, int32 SensorId, double MeasuredTimestamp, const FPrediction* Prediction)
+{
+	check(IsInGameThread());
+
+	FFrameState State;
+	State.Manager = Manager;
+	State.SensorId = SensorId;
+	State.GameRelative = Component->GetRelativeTransform();
+	State.MeasuredTimestamp = MeasuredTimestamp;
+	State.bPredict = Prediction != nullptr;
+	if (Prediction)
+	{
+		State.Prediction = *Prediction;
+	}
+	State.ViewActor = Component->GetOwner();
+
+	// The late pose replaces the relative transform, so the delta is taken in the parent's space
+	if (const USceneComponent* Parent = Component->GetAttachParent())
+	{
+		State.ParentToWorld = Parent->GetSocketTransform(Component->GetAttachSocketName());
+	}
+
+	LateUpdate.Setup(State.ParentToWorld, Component, false);
+	bActive.store(true, std::memory_order_relaxed);
+
+	ENQUEUE_RENDER_COMMAND(VRPNLateUpdateSetup)(
+		[Self = StaticCastSharedRef<FVRPNLateUpdateExtension>(AsShared()), State = MoveTemp(State)](FRHICommandListImmediate&) mutable
+		{
+			Self->RenderState = MoveTemp(State);
+		});
+}
+
+void FVRPNLateUpdateExtension::Release()
+{
+	check(IsInGameThread());
+
+	bActive.store(false, std::memory_order_relaxed);
+
+	// Called after unsubscribing: a connection without subscribers was already stopped on the game thread, so
+	// dropping the last reference on the render thread never waits for the receive thread
+	ENQUEUE_RENDER_COMMAND(VRPNLateUpdateRelease)(
+		[Self = StaticCastSharedRef<FVRPNLateUpdateExtension>(AsShared())](FRHICommandListImmediate&)
+		{
+			Self->RenderState = FFrameState();
+		});
+}
+
+bool FVRPNLateUpdateExtension::IsActiveThisFrame_Internal(const FSceneViewExtensionContext& Context) const
+{
+	return bActive.load(std::memory_order_relaxed);
+}
+
+void FVRPNLateUpdateExtension::PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily)
+{
+	bHasViewDelta = false;
+	if (!RenderState.Manager.IsValid() || LateUpdate.GetSkipLateUpdate_RenderThread())
+	{
+		return;
+	}
+
+	FVector Position;
+	FQuat Rotation;
+	double Timestamp;
+	if (!RenderState.Manager->GetSensorTable().ReadPose(RenderState.SensorId, Position, Rotation, Timestamp)
+		|| Timestamp <= RenderState.MeasuredTimestamp)
+	{
+		return;
+	}
+
+	if (RenderState.bPredict)
+	{
+		// Same projection as the game thread, from a newer sample: the span to display time is shorter
+		const FPrediction& Prediction = RenderState.Prediction;
+		FVRPNTransformData Late = Prediction.Rates;
+		Late.Position = Position;
+		Late.Rotation = Rotation;
+		Late.Timestamp = Timestamp;
+		const FVRPNTransformData Predicted = Late.Extrapolate(FMath::Clamp(Prediction.DisplayTime - Timestamp, 0.0, Prediction.MaxSeconds));
+		Position = Predicted.Position;
+		Rotation = Predicted.Rotation;
+	}
+
+	const FTransform NewRelative(Rotation, Position, RenderState.GameRelative.GetScale3D());
+	LateUpdate.Apply_RenderThread(InViewFamily.Scene, RenderState.GameRelative, NewRelative);
+
+	// World-space motion since the game thread, for views looking through the tracked actor
+	const FTransform OldWorld = RenderState.GameRelative * RenderState.ParentToWorld;
+	const FTransform NewWorld = NewRelative * RenderState.ParentToWorld;
+	ViewDelta = OldWorld.Inverse() * NewWorld;
+	bHasViewDelta = true;
+}
+
+void FVRPNLateUpdateExtension::PreRenderView_RenderThread(FRDGBuilder& GraphBuilder, FSceneView& InView)
+{
+	if (!bHasViewDelta || InView.ViewActor == nullptr || InView.ViewActor != RenderState.ViewActor)
+	{
+		return;
+	}
+
+	InView.ViewLocation = ViewDelta.TransformPosition(InView.ViewLocation);
+	InView.ViewRotation = FRotator(ViewDelta.GetRotation() * InView.ViewRotation.Quaternion());
+	InView.UpdateViewMatrix();
+}
+
+void FVRPNLateUpdateExtension::PostRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily)
+{
+	LateUpdate.PostRender_RenderThread();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneViewExtension.h"
+#include "LateUpdateManager.h"
+#include "VRPN/VRPNTransformData.h"
+#include <atomic>
+
+class FVRPNConnectionManager;
+class USceneComponent;
+
+/**
+ * Render-thread late update of a tracked component, like the XR motion controller late update
+ *
+ * The game thread applies a pose to a scene component in its tick, a whole frame before that frame
+ * is rendered. Just before the renderer finalizes view and primitive transforms, this extension
+ * reads the sensor's newest pose straight from the connection's lock-free sensor table and moves
+ * the component's primitive proxies by the difference. Views whose view target is the tracked
+ * actor (a tracked camera) are moved by the same difference.
+ */
+class FVRPNLateUpdateExtension : public FSceneViewExtensionBase
+{
+public:
+	FVRPNLateUpdateExtension(const FAutoRegister& AutoRegister);
+
+	/** How the game thread predicted the pose it applied; late samples are carried to the same display time */
+	struct FPrediction
+	{
+		/** Velocities and accelerations of the sample the game thread predicted from */
+		FVRPNTransformData Rates;
+
+		/** Local time the frame is expected on screen */
+		double DisplayTime = 0.0;
+
+		/** Longest projection in seconds */
+		double MaxSeconds = 0.0;
+	};
+
+	/**
+	 * Record the pose the game thread applied this frame (game thread, after moving the component)
+	 * @param Component Component that was moved; its primitives and attached children get the late delta
+	 * @param Manager Connection to re-sample on the render thread
+	 * @param SensorId Dense sensor ID of the tracked sensor
+	 * @param MeasuredTimestamp Measurement time of the newest sample behind the applied pose; only newer samples are applied on top of it
+	 * @param Prediction Set when the applied pose was predicted, nullptr for a measured pose
+	 */
+	void Setup(USceneComponent* Component, const TSharedPtr<FVRPNConnectionManager>& Manager, int32 SensorId, double MeasuredTimestamp, const FPrediction* Prediction = nullptr);
+
+	/**
+	 * Skip the late update for the frames until the next Setup() (game thread)
+	 * For poses that are not the newest sample, such as one played out of a jitter buffer
+	 */
+	void Suspend() { bActive.store(false, std::memory_order_relaxed); }
+
+	/** Stop late-updating and release the connection on the render thread (game thread) */
+	void Release();
+
+	// ISceneViewExtension interface
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override {}
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override;
+	virtual void PreRenderView_RenderThread(FRDGBuilder& GraphBuilder, FSceneView& InView) override;
+	virtual void PostRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override;
+
+protected:
+	virtual bool IsActiveThisFrame_Internal(const FSceneViewExtensionContext& Context) const override;
+
+private:
+	/** What the game thread did this frame, handed to the render thread with each Setup() */
+	struct FFrameState
+	{
+		TSharedPtr<FVRPNConnectionManager> Manager;
+		int32 SensorId = INDEX_NONE;
+		FTransform ParentToWorld;
+		FTransform GameRelative;
+		double MeasuredTimestamp = 0.0;
+		bool bPredict = false;
+		FPrediction Prediction;
+
+		/** Owner of the tracked component, only compared against view actors */
+		const AActor* ViewActor = nullptr;
+	};
+
+	/** Primitive proxies to move (double-buffered between game and render thread) */
+	FLateUpdateManager LateUpdate;
+
+	/** Render-thread copy of the game thread's frame */
+	FFrameState RenderState;
+
+	/** Game-to-world delta found for the view family being rendered (render thread only) */
+	FTransform ViewDelta;
+	bool bHasViewDelta;
+
+	/** Cleared by Release() so no further frames pay for the extension */
+	std::atomic<bool> bActive;
+};
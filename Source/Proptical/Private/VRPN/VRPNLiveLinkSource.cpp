@@ -0,0 +1,246 @@
+#include "VRPNLiveLinkSource.h"
+#include "VRPNConnectionManager.h"
+#include "ILiveLinkClient.h"
+#include "LiveLinkTypes.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Features/IModularFeatures.h"
+
+#define LOCTEXT_NAMESPACE "VRPNLiveLinkSource"
+
+FVRPNLiveLinkSource::FVRPNLiveLinkSource(const FString& InServerName)
+	: Client(nullptr)
+	, MachineName(FText::FromString(InServerName))
+	, bIsValid(true)
+{
+}
+
+TSharedPtr<FVRPNLiveLinkSource> FVRPNLiveLinkSource::Create(const FString& ServerName)
+{
+	IModularFeatures& ModularFeatures = IModularFeatures::Get();
+	if (!ModularFeatures.IsModularFeatureAvailable(ILiveLinkClient::ModularFeatureName))
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Live Link is not available; enable the Live Link plugin to publish skeletons"));
+		return nullptr;
+	}
+
+	// AddSource hands the client back through ReceiveClient
+	ILiveLinkClient& LiveLinkClient = ModularFeatures.GetModularFeature<ILiveLinkClient>(ILiveLinkClient::ModularFeatureName);
+	TSharedPtr<FVRPNLiveLinkSource> Source = MakeShared<FVRPNLiveLinkSource>(ServerName);
+	LiveLinkClient.AddSource(Source);
+	return Source;
+}
+
+void FVRPNLiveLinkSource::SetSkeletons(TConstArrayView<FVRPNSkeletonBinding> Bindings)
+{
+	if (Client)
+	{
+		for (const FVRPNResolvedSkeleton& Skeleton : Skeletons)
+		{
+			Client->RemoveSubject_AnyThread(FLiveLinkSubjectKey(SourceGuid, Skeleton.SubjectName));
+		}
+	}
+	Skeletons.Reset();
+
+	for (const FVRPNSkeletonBinding& Binding : Bindings)
+	{
+		if (Binding.SubjectName.IsNone() || Binding.Segments.Num() == 0)
+		{
+			UE_LOG(LogVRPN, Warning, TEXT("Skipping skeleton binding without a subject name or segments"));
+			continue;
+		}
+
+		FVRPNResolvedSkeleton& Skeleton = Skeletons.AddDefaulted_GetRef();
+		Skeleton.SubjectName = Binding.SubjectName;
+		Skeleton.DeviceName = Binding.DeviceName.IsEmpty() ? NAME_None : FName(*Binding.DeviceName);
+
+		const int32 NumBones = Binding.Segments.Num();
+		Skeleton.BoneNames.Reserve(NumBones);
+		Skeleton.SensorIndices.Reserve(NumBones);
+		for (const FVRPNSkeletonSegment& Segment : Binding.Segments)
+		{
+			Skeleton.BoneNames.Add(Segment.BoneName);
+			Skeleton.SensorIndices.Add(Segment.SensorIndex);
+		}
+
+		// Parents are looked up by name here, once; frames only use the indices
+		Skeleton.BoneParents.Reserve(NumBones);
+		for (const FVRPNSkeletonSegment& Segment : Binding.Segments)
+		{
+			int32 ParentIndex = INDEX_NONE;
+			if (!Segment.ParentBoneName.IsNone())
+			{
+				ParentIndex = Skeleton.BoneNames.IndexOfByKey(Segment.ParentBoneName);
+				if (ParentIndex == INDEX_NONE)
+				{
+					UE_LOG(LogVRPN, Warning, TEXT("Skeleton %s: parent bone %s of %s is not a segment; treating %s as a root"),
+						*Binding.SubjectName.ToString(), *Segment.ParentBoneName.ToString(), *Segment.BoneName.ToString(), *Segment.BoneName.ToString());
+				}
+			}
+			Skeleton.BoneParents.Add(ParentIndex);
+		}
+
+		Skeleton.SensorIds.Init(INDEX_NONE, NumBones);
+		Skeleton.NumUnresolved = NumBones;
+		Skeleton.ResolvedSensorCount = 0;
+
+		PushStaticData(Skeleton);
+	}
+}
+
+void FVRPNLiveLinkSource::PushStaticData(const FVRPNResolvedSkeleton& Skeleton)
+{
+	if (!Client)
+	{
+		return;
+	}
+
+	FLiveLinkStaticDataStruct StaticData(FLiveLinkSkeletonStaticData::StaticStruct());
+	FLiveLinkSkeletonStaticData& SkeletonData = *StaticData.Cast<FLiveLinkSkeletonStaticData>();
+	SkeletonData.SetBoneNames(Skeleton.BoneNames);
+	SkeletonData.SetBoneParents(Skeleton.BoneParents);
+
+	Client->PushSubjectStaticData_AnyThread(FLiveLinkSubjectKey(SourceGuid, Skeleton.SubjectName), ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticData));
+}
+
+void FVRPNLiveLinkSource::ResolveSensors(FVRPNResolvedSkeleton& Skeleton, const FVRPNConnectionManager& Manager) const
+{
+	// Named devices match by sender ID; until the server describes the name nothing can match
+	if (!Skeleton.DeviceName.IsNone())
+	{
+		Skeleton.DeviceSenderId = Manager.FindSenderId(Skeleton.DeviceName);
+		if (Skeleton.DeviceSenderId == INDEX_NONE)
+		{
+			return;
+		}
+	}
+
+	const FVRPNSensorSnapshot& Snapshot = Manager.GetSensorSnapshot();
+	for (int32 BoneIndex = 0; BoneIndex < Skeleton.SensorIds.Num(); ++BoneIndex)
+	{
+		if (Skeleton.SensorIds[BoneIndex] != INDEX_NONE)
+		{
+			continue;
+		}
+
+		for (int32 SensorId = 0; SensorId < Snapshot.Num(); ++SensorId)
+		{
+			if (Snapshot.SensorIndices[SensorId] == Skeleton.SensorIndices[BoneIndex]
+				&& (Skeleton.DeviceName.IsNone() || Snapshot.SenderIds[SensorId] == Skeleton.DeviceSenderId))
+			{
+				Skeleton.SensorIds[BoneIndex] = SensorId;
+				--Skeleton.NumUnresolved;
+				break;
+			}
+		}
+	}
+}
+
+void FVRPNLiveLinkSource::PublishFrame(const FVRPNConnectionManager& Manager)
+{
+	if (!Client)
+	{
+		return;
+	}
+
+	const FVRPNSensorSnapshot& Snapshot = Manager.GetSensorSnapshot();
+	for (FVRPNResolvedSkeleton& Skeleton : Skeletons)
+	{
+		// Sensors and names only ever get added, so resolving again is only worth it once either has grown
+		const uint32 NamesVersion = Manager.GetSenderNamesVersion();
+		if (Skeleton.NumUnresolved > 0 && (Skeleton.ResolvedSensorCount != Snapshot.Num() || Skeleton.ResolvedNamesVersion != NamesVersion))
+		{
+			Skeleton.ResolvedSensorCount = Snapshot.Num();
+			Skeleton.ResolvedNamesVersion = NamesVersion;
+			ResolveSensors(Skeleton, Manager);
+		}
+
+		if (Skeleton.NumUnresolved > 0)
+		{
+			continue;
+		}
+
+		// Gather the world-space segments straight out of the snapshot arrays
+		const int32 NumBones = Skeleton.SensorIds.Num();
+		WorldScratch.SetNumUninitialized(NumBones, EAllowShrinking::No);
+		double NewestTime = 0.0;
+		for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+		{
+			const int32 SensorId = Skeleton.SensorIds[BoneIndex];
+			WorldScratch[BoneIndex] = FTransform(Snapshot.Rotations[SensorId], Snapshot.Positions[SensorId]);
+			NewestTime = FMath::Max(NewestTime, Snapshot.Timestamps[SensorId]);
+		}
+
+		if (NewestTime <= Skeleton.LastPublishedTime)
+		{
+			continue;
+		}
+		Skeleton.LastPublishedTime = NewestTime;
+
+		// Live Link animation frames are parent-relative
+		FLiveLinkFrameDataStruct FrameData(FLiveLinkAnimationFrameData::StaticStruct());
+		FLiveLinkAnimationFrameData& Animation = *FrameData.Cast<FLiveLinkAnimationFrameData>();
+		Animation.WorldTime = FLiveLinkWorldTime(NewestTime);
+		Animation.Transforms.SetNumUninitialized(NumBones);
+		for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+		{
+			const int32 ParentIndex = Skeleton.BoneParents[BoneIndex];
+			Animation.Transforms[BoneIndex] = ParentIndex == INDEX_NONE
+				? WorldScratch[BoneIndex]
+				: WorldScratch[BoneIndex].GetRelativeTransform(WorldScratch[ParentIndex]);
+		}
+
+		Client->PushSubjectFrameData_AnyThread(FLiveLinkSubjectKey(SourceGuid, Skeleton.SubjectName), MoveTemp(FrameData));
+	}
+}
+
+void FVRPNLiveLinkSource::Shutdown()
+{
+	if (Client)
+	{
+		// Live Link calls RequestSourceShutdown, which forgets the client
+		Client->RemoveSource(SourceGuid);
+	}
+	Client = nullptr;
+	Skeletons.Reset();
+}
+
+void FVRPNLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
+{
+	Client = InClient;
+	SourceGuid = InSourceGuid;
+}
+
+bool FVRPNLiveLinkSource::IsSourceStillValid() const
+{
+	return bIsValid.load(std::memory_order_relaxed);
+}
+
+bool FVRPNLiveLinkSource::RequestSourceShutdown()
+{
+	bIsValid.store(false, std::memory_order_relaxed);
+	Client = nullptr;
+	return true;
+}
+
+FText FVRPNLiveLinkSource::GetSourceType() const
+{
+	return LOCTEXT("SourceType", "VRPN");
+}
+
+FText FVRPNLiveLinkSource::GetSourceMachineName() const
+{
+	return MachineName;
+}
+
+FText FVRPNLiveLinkSource::GetSourceStatus() const
+{
+	int32 NumActive = 0;
+	for (const FVRPNResolvedSkeleton& Skeleton : Skeletons)
+	{
+		NumActive += Skeleton.NumUnresolved == 0 ? 1 : 0;
+	}
+	return FText::Format(LOCTEXT("SourceStatus", "{0} of {1} skeletons tracking"), NumActive, Skeletons.Num());
+}
+
+#undef LOCTEXT_NAMESPACE
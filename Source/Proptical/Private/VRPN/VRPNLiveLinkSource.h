@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ILiveLinkSource.h"
+#include "VRPN/VRPNTypes.h"
+#include <atomic>
+
+class ILiveLinkClient;
+class FVRPNConnectionManager;
+
+/**
+ * A skeleton binding resolved against a connection: per-bone parent index and dense sensor ID
+ */
+struct FVRPNResolvedSkeleton
+{
+	FName SubjectName;
+
+	/** Device carrying the segments (None = any) and its sender ID once the server has described it */
+	FName DeviceName;
+	int32 DeviceSenderId = INDEX_NONE;
+
+	/** Bone names and parent bone indices (INDEX_NONE for roots) as published in the static data */
+	TArray<FName> BoneNames;
+	TArray<int32> BoneParents;
+
+	/** Server-side sensor index per bone */
+	TArray<int32> SensorIndices;
+
+	/** Dense sensor ID per bone, INDEX_NONE until the sensor has reported */
+	TArray<int32> SensorIds;
+
+	/** Bones whose sensor has not been found yet */
+	int32 NumUnresolved = 0;
+
+	/** Snapshot size and sender names version at the last resolve attempt; resolving is retried only when either moves */
+	int32 ResolvedSensorCount = 0;
+	uint32 ResolvedNamesVersion = 0;
+
+	/** Newest segment timestamp published, to skip frames without new data */
+	double LastPublishedTime = 0.0;
+};
+
+/**
+ * Live Link source publishing VRPN skeletons
+ *
+ * Each binding becomes an animation subject. The sensors of a binding are resolved to dense sensor
+ * IDs once, then every frame the whole skeleton is gathered from the connection's sensor snapshot
+ * and pushed as one frame. The Live Link Pose node writes that frame into the pose in a single
+ * pass on the animation worker thread, so no per-bone event ever reaches Blueprint.
+ */
+class FVRPNLiveLinkSource : public ILiveLinkSource
+{
+public:
+	explicit FVRPNLiveLinkSource(const FString& InServerName);
+
+	/**
+	 * Create a source and add it to the Live Link client (game thread)
+	 * @param ServerName Shown as the source's machine name in the Live Link panel
+	 * @return nullptr if the Live Link plugin is not loaded
+	 */
+	static TSharedPtr<FVRPNLiveLinkSource> Create(const FString& ServerName);
+
+	/** Replace the published skeletons and send their static data */
+	void SetSkeletons(TConstArrayView<FVRPNSkeletonBinding> Bindings);
+
+	/**
+	 * Push one frame per skeleton from the connection's sensor snapshot (game thread, after the connection was pumped)
+	 * Skeletons are published once every segment has reported, and only when a segment has new data.
+	 */
+	void PublishFrame(const FVRPNConnectionManager& Manager);
+
+	/** Remove the source (and its subjects) from Live Link */
+	void Shutdown();
+
+	// ILiveLinkSource interface
+	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
+	virtual bool IsSourceStillValid() const override;
+	virtual bool RequestSourceShutdown() override;
+	virtual FText GetSourceType() const override;
+	virtual FText GetSourceMachineName() const override;
+	virtual FText GetSourceStatus() const override;
+
+private:
+	/** Find the dense sensor IDs of bones that have not been resolved yet */
+	void ResolveSensors(FVRPNResolvedSkeleton& Skeleton, const FVRPNConnectionManager& Manager) const;
+
+	/** Send bone names and parents of a skeleton */
+	void PushStaticData(const FVRPNResolvedSkeleton& Skeleton);
+
+	ILiveLinkClient* Client;
+	FGuid SourceGuid;
+	FText MachineName;
+
+	TArray<FVRPNResolvedSkeleton> Skeletons;
+
+	/** World-space bone transforms of the skeleton being published (reused across frames) */
+	TArray<FTransform> WorldScratch;
+
+	/** Cleared when Live Link asks the source to shut down */
+	std::atomic<bool> bIsValid;
+};
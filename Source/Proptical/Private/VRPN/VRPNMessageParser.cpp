@@ -1,24 +1,132 @@
 #include "VRPNMessageParser.h"
+#include "VRPNWire.h"
 #include "HAL/Platform.h"
 
-bool FVRPNMessageParser::ParseTrackerMessage(const uint8* Data, int32 DataSize, FVRPNTransformData& OutTransform, FString& OutRigidBodyName)
+bool FVRPNMessageParser::ParseTrackerMessage(const uint8* Data, int32 DataSize, FVRPNTrackerSample& OutSample)
 {
 	if (!ValidateMessageHeader(Data, DataSize))
 	{
 		return false;
 	}
 
-	// TODO: Implement VRPN Tracker message parsing
-	// VRPN Tracker message format (simplified):
-	// - Header (message type, sender, etc.)
-	// - Rigid body name (string)
-	// - Position (3 floats: X, Y, Z)
-	// - Rotation quaternion (4 floats: W, X, Y, Z)
-	// - Timestamp (double)
-	
-	// For now, return false to indicate parsing not yet implemented
-	// This will be implemented once we have VRPN protocol specification details
-	return false;
+	const int32 PayloadSize = VRPNWire::ReadInt32(Data) - VRPN_HEADER_SIZE;
+	if (!ParseTrackerPayload(Data + VRPN_HEADER_SIZE, PayloadSize, OutSample))
+	{
+		return false;
+	}
+
+	OutSample.ServerTime = double(VRPNWire::ReadInt32(Data + 4)) + double(VRPNWire::ReadInt32(Data + 8)) * 1.0e-6;
+	OutSample.SenderId = VRPNWire::ReadInt32(Data + 12);
+	return true;
+}
+
+FVRPNParseResult FVRPNMessageParser::ParseDatagram(const uint8* Data, int32 DataSize, int32 TrackerTypeId, TArrayView<FVRPNTrackerSample> OutSamples)
+{
+	FVRPNTrackerTypeIds TypeIds;
+	TypeIds.Position = TrackerTypeId;
+	return ParseDatagram(Data, DataSize, TypeIds, OutSamples, TArrayView<FVRPNTrackerDerivative>());
+}
+
+FVRPNParseResult FVRPNMessageParser::ParseDatagram(const uint8* Data, int32 DataSize, const FVRPNTrackerTypeIds& TypeIds,
+	TArrayView<FVRPNTrackerSample> OutSamples, TArrayView<FVRPNTrackerDerivative> OutDerivatives)
+{
+	FVRPNParseResult Result;
+	int32 Offset = 0;
+
+	// Several messages may be packed back to back into one datagram; walk all of them
+	while (Offset < DataSize)
+	{
+		const uint8* Message = Data + Offset;
+		const int32 Remaining = DataSize - Offset;
+
+		if (!ValidateMessageHeader(Message, Remaining))
+		{
+			Result.bMalformed = true;
+			break;
+		}
+
+		const int32 MessageLength = VRPNWire::ReadInt32(Message);
+		const int32 PayloadSize = MessageLength - VRPN_HEADER_SIZE;
+		const int32 TypeId = VRPNWire::ReadInt32(Message + 16);
+		++Result.NumMessages;
+
+		// Type IDs are assigned by the server; until its type descriptions are known, accept any
+		// non-system message whose payload has the exact tracker position size
+		const bool bIsTracker = (TypeIds.Position != INDEX_NONE)
+			? (TypeId == TypeIds.Position)
+			: (TypeId >= 0 && PayloadSize == VRPN_TRACKER_POS_QUAT_SIZE);
+
+		// Velocity and acceleration payloads have the same size, so they are told apart by described type only
+		const bool bIsVelocity = TypeIds.Velocity != INDEX_NONE && TypeId == TypeIds.Velocity;
+		const bool bIsAcceleration = TypeIds.Acceleration != INDEX_NONE && TypeId == TypeIds.Acceleration;
+
+		if (bIsTracker)
+		{
+			if (Result.NumSamples < OutSamples.Num())
+			{
+				FVRPNTrackerSample& Sample = OutSamples[Result.NumSamples];
+				if (ParseTrackerPayload(Message + VRPN_HEADER_SIZE, PayloadSize, Sample))
+				{
+					Sample.ServerTime = double(VRPNWire::ReadInt32(Message + 4)) + double(VRPNWire::ReadInt32(Message + 8)) * 1.0e-6;
+					Sample.SenderId = VRPNWire::ReadInt32(Message + 12);
+					++Result.NumSamples;
+				}
+			}
+			else
+			{
+				++Result.NumDropped;
+			}
+		}
+		else if ((bIsVelocity || bIsAcceleration) && Result.NumDerivatives < OutDerivatives.Num())
+		{
+			FVRPNTrackerDerivative& Derivative = OutDerivatives[Result.NumDerivatives];
+			if (ParseDerivativePayload(Message + VRPN_HEADER_SIZE, PayloadSize, Derivative))
+			{
+				Derivative.bAcceleration = bIsAcceleration;
+				Derivative.ServerTime = double(VRPNWire::ReadInt32(Message + 4)) + double(VRPNWire::ReadInt32(Message + 8)) * 1.0e-6;
+				Derivative.SenderId = VRPNWire::ReadInt32(Message + 12);
+				++Result.NumDerivatives;
+			}
+		}
+
+		// The sender pads every message to the alignment; tolerate a missing pad on the last one
+		Offset += FMath::Min(VRPNWire::Align(MessageLength, VRPN_ALIGN), Remaining);
+	}
+
+	return Result;
+}
+
+int32 FVRPNMessageParser::WriteTrackerMessage(uint8* Dest, int32 DestSize, int32 SenderId, int32 TypeId, double ServerTime, int32 SensorIndex, const FVector& Position, const FQuat& Rotation)
+{
+	const int32 MessageLength = VRPN_HEADER_SIZE + VRPN_TRACKER_POS_QUAT_SIZE;
+	const int32 PaddedLength = VRPNWire::Align(MessageLength, VRPN_ALIGN);
+	if (Dest == nullptr || DestSize < PaddedLength)
+	{
+		return 0;
+	}
+
+	const double Seconds = FMath::FloorToDouble(ServerTime);
+	const int32 Microseconds = FMath::Clamp(static_cast<int32>((ServerTime - Seconds) * 1.0e6), 0, 999999);
+
+	FMemory::Memzero(Dest, PaddedLength);
+	VRPNWire::WriteUInt32(Dest, static_cast<uint32>(MessageLength));
+	VRPNWire::WriteUInt32(Dest + 4, static_cast<uint32>(static_cast<int64>(Seconds)));
+	VRPNWire::WriteUInt32(Dest + 8, static_cast<uint32>(Microseconds));
+	VRPNWire::WriteUInt32(Dest + 12, static_cast<uint32>(SenderId));
+	VRPNWire::WriteUInt32(Dest + 16, static_cast<uint32>(TypeId));
+
+	uint8* Payload = Dest + VRPN_HEADER_SIZE;
+	VRPNWire::WriteUInt32(Payload, static_cast<uint32>(SensorIndex));
+	uint8* Values = Payload + 8;
+	VRPNWire::WriteDouble(Values, Position.X);
+	VRPNWire::WriteDouble(Values + 8, Position.Y);
+	VRPNWire::WriteDouble(Values + 16, Position.Z);
+	VRPNWire::WriteDouble(Values + 24, Rotation.X);
+	VRPNWire::WriteDouble(Values + 32, Rotation.Y);
+	VRPNWire::WriteDouble(Values + 40, Rotation.Z);
+	VRPNWire::WriteDouble(Values + 48, Rotation.W);
+
+	return PaddedLength;
 }
 
 bool FVRPNMessageParser::ValidateMessageHeader(const uint8* Data, int32 DataSize)
@@ -28,9 +136,76 @@ bool FVRPNMessageParser::ValidateMessageHeader(const uint8* Data, int32 DataSize
 		return false;
 	}
 
-	// TODO: Validate VRPN message header format
-	// Check for VRPN magic number or message type identifier
-	
+	// Length covers the header and the unpadded payload, and must fit in what we received
+	const int32 MessageLength = VRPNWire::ReadInt32(Data);
+	if (MessageLength < VRPN_HEADER_SIZE || MessageLength > DataSize)
+	{
+		return false;
+	}
+
+	// Microseconds must be a proper fraction of a second
+	const int32 Microseconds = VRPNWire::ReadInt32(Data + 8);
+	return Microseconds >= 0 && Microseconds < 1000000;
+}
+
+bool FVRPNMessageParser::ParseTrackerPayload(const uint8* Payload, int32 PayloadSize, FVRPNTrackerSample& OutSample)
+{
+	if (PayloadSize < VRPN_TRACKER_POS_QUAT_SIZE)
+	{
+		return false;
+	}
+
+	// Sensor index is followed by 4 bytes of padding so the doubles are 8-byte aligned
+	OutSample.SensorIndex = VRPNWire::ReadInt32(Payload);
+
+	const uint8* Values = Payload + 8;
+	OutSample.Position = FVector(
+		VRPNWire::ReadDouble(Values),
+		VRPNWire::ReadDouble(Values + 8),
+		VRPNWire::ReadDouble(Values + 16));
+
+	OutSample.Rotation = FQuat(
+		VRPNWire::ReadDouble(Values + 24),
+		VRPNWire::ReadDouble(Values + 32),
+		VRPNWire::ReadDouble(Values + 40),
+		VRPNWire::ReadDouble(Values + 48));
+
 	return true;
 }
 
+bool FVRPNMessageParser::ParseDerivativePayload(const uint8* Payload, int32 PayloadSize, FVRPNTrackerDerivative& OutDerivative)
+{
+	if (PayloadSize < VRPN_TRACKER_DERIVATIVE_SIZE)
+	{
+		return false;
+	}
+
+	OutDerivative.SensorIndex = VRPNWire::ReadInt32(Payload);
+
+	const uint8* Values = Payload + 8;
+	OutDerivative.Linear = FVector(
+		VRPNWire::ReadDouble(Values),
+		VRPNWire::ReadDouble(Values + 8),
+		VRPNWire::ReadDouble(Values + 16));
+
+	const FQuat Rotation(
+		VRPNWire::ReadDouble(Values + 24),
+		VRPNWire::ReadDouble(Values + 32),
+		VRPNWire::ReadDouble(Values + 40),
+		VRPNWire::ReadDouble(Values + 48));
+	const double DeltaTime = VRPNWire::ReadDouble(Values + 56);
+
+	// The rotation happens over DeltaTime; servers without a rotational rate send identity (and often dt = 0)
+	OutDerivative.Angular = FVector::ZeroVector;
+	if (DeltaTime > 0.0 && Rotation.SizeSquared() > UE_SMALL_NUMBER)
+	{
+		FQuat Normalized = Rotation.GetNormalized();
+		if (Normalized.W < 0.0)
+		{
+			Normalized = Normalized * -1.0;
+		}
+		OutDerivative.Angular = Normalized.ToRotationVector() / DeltaTime;
+	}
+
+	return true;
+}
@@ -2,23 +2,171 @@
 
 #include "CoreMinimal.h"
 #include "VRPN/VRPNTransformData.h"
+#include <atomic>
+
+/**
+ * Single tracker report decoded from a VRPN message
+ * Plain data only (no heap-owning members) so it can live in preallocated arrays on the receive thread
+ */
+struct FVRPNTrackerSample
+{
+	/** Sender ID from the message header (server-side numbering) */
+	int32 SenderId;
+
+	/** Sensor index within the sender */
+	int32 SensorIndex;
+
+	/** Position as sent by the server (X, Y, Z) */
+	FVector Position;
+
+	/** Rotation quaternion as sent by the server (X, Y, Z, W) */
+	FQuat Rotation;
+
+	/** Server timestamp from the message header, in seconds */
+	double ServerTime;
+};
+
+/**
+ * Single tracker velocity or acceleration report decoded from a VRPN message
+ * Plain data only, like FVRPNTrackerSample
+ */
+struct FVRPNTrackerDerivative
+{
+	/** Sender ID from the message header (server-side numbering) */
+	int32 SenderId;
+
+	/** Sensor index within the sender */
+	int32 SensorIndex;
+
+	/** False for a velocity report, true for an acceleration report */
+	bool bAcceleration;
+
+	/** Linear velocity (units per second) or acceleration (units per second squared) as sent by the server */
+	FVector Linear;
+
+	/** The server's rotation quaternion over its dt, decoded to axis * angle / dt */
+	FVector Angular;
+
+	/** Server timestamp from the message header, in seconds */
+	double ServerTime;
+};
+
+/**
+ * Server-side type IDs of the tracker messages for one datagram walk (INDEX_NONE = not described yet)
+ */
+struct FVRPNTrackerTypeIds
+{
+	int32 Position = INDEX_NONE;
+	int32 Velocity = INDEX_NONE;
+	int32 Acceleration = INDEX_NONE;
+};
+
+/**
+ * Tracker type IDs published by the control channel as the server describes them, read by the receive thread
+ */
+struct FVRPNSharedTrackerTypeIds
+{
+	std::atomic<int32> Position{ INDEX_NONE };
+	std::atomic<int32> Velocity{ INDEX_NONE };
+	std::atomic<int32> Acceleration{ INDEX_NONE };
+
+	/** Current IDs */
+	FVRPNTrackerTypeIds Load() const
+	{
+		FVRPNTrackerTypeIds TypeIds;
+		TypeIds.Position = Position.load(std::memory_order_relaxed);
+		TypeIds.Velocity = Velocity.load(std::memory_order_relaxed);
+		TypeIds.Acceleration = Acceleration.load(std::memory_order_relaxed);
+		return TypeIds;
+	}
+
+	/** Forget every ID (before a new connection describes its types) */
+	void Reset()
+	{
+		Position.store(INDEX_NONE, std::memory_order_relaxed);
+		Velocity.store(INDEX_NONE, std::memory_order_relaxed);
+		Acceleration.store(INDEX_NONE, std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Summary of a single datagram walk
+ */
+struct FVRPNParseResult
+{
+	/** Number of VRPN messages found in the datagram (of any type) */
+	int32 NumMessages = 0;
+
+	/** Number of tracker samples written to the output storage */
+	int32 NumSamples = 0;
+
+	/** Number of tracker samples that did not fit in the output storage */
+	int32 NumDropped = 0;
+
+	/** Number of velocity and acceleration reports written to the derivative output storage */
+	int32 NumDerivatives = 0;
+
+	/** True if the walk stopped early on a malformed message */
+	bool bMalformed = false;
+};
 
 /**
  * Parses VRPN protocol messages
  * Implements minimal VRPN protocol subset focused on Tracker messages
+ *
+ * Wire format (all fields big-endian, messages aligned to 8 bytes):
+ * - Header: total length (header + unpadded payload), timestamp seconds, timestamp microseconds,
+ *   sender ID, message type ID, 4 bytes of padding
+ * - Tracker position payload: sensor (int32), padding (int32), position (3 doubles), quaternion (4 doubles: X, Y, Z, W)
+ * - Tracker velocity and acceleration payloads: sensor (int32), padding (int32), linear rate (3 doubles),
+ *   rotation quaternion (4 doubles: X, Y, Z, W) and the seconds that rotation takes (double)
+ *
+ * All parsing reads directly out of the receive buffer and never allocates.
  */
 class FVRPNMessageParser
 {
 public:
 	/**
-	 * Parse a VRPN Tracker message from raw UDP data
+	 * Parse a single VRPN Tracker position message from raw data
+	 * @param Data Start of the message (header included)
+	 * @param DataSize Number of bytes available from Data
+	 * @param OutSample Output sample if parsing succeeds
+	 * @return true if message was a well-formed tracker position message, false otherwise
+	 */
+	static bool ParseTrackerMessage(const uint8* Data, int32 DataSize, FVRPNTrackerSample& OutSample);
+
+	/**
+	 * Walk every VRPN message packed into one datagram and decode all tracker position messages
+	 * @param Data Raw UDP packet data
+	 * @param DataSize Size of the data buffer
+	 * @param TrackerTypeId Server-side type ID of tracker position messages, or INDEX_NONE if not yet known
+	 *        (any non-system message with a tracker-sized payload is then treated as a tracker message)
+	 * @param OutSamples Caller-provided storage; samples beyond its size are counted as dropped
+	 * @return Summary of the walk
+	 */
+	static FVRPNParseResult ParseDatagram(const uint8* Data, int32 DataSize, int32 TrackerTypeId, TArrayView<FVRPNTrackerSample> OutSamples);
+
+	/**
+	 * Walk every VRPN message packed into one datagram and decode tracker position, velocity and acceleration messages
+	 * Velocity and acceleration messages are only recognized once the server has described their types
 	 * @param Data Raw UDP packet data
 	 * @param DataSize Size of the data buffer
-	 * @param OutTransform Output transform data if parsing succeeds
-	 * @param OutRigidBodyName Output rigid body name if present in message
-	 * @return true if message was successfully parsed, false otherwise
+	 * @param TypeIds Server-side type IDs of the tracker messages
+	 * @param OutSamples Caller-provided storage for position reports; samples beyond its size are counted as dropped
+	 * @param OutDerivatives Caller-provided storage for velocity and acceleration reports; reports beyond its size are skipped
+	 * @return Summary of the walk
 	 */
-	static bool ParseTrackerMessage(const uint8* Data, int32 DataSize, FVRPNTransformData& OutTransform, FString& OutRigidBodyName);
+	static FVRPNParseResult ParseDatagram(const uint8* Data, int32 DataSize, const FVRPNTrackerTypeIds& TypeIds,
+		TArrayView<FVRPNTrackerSample> OutSamples, TArrayView<FVRPNTrackerDerivative> OutDerivatives);
+
+	/**
+	 * Encode a tracker position message (used by the synthetic test server)
+	 * @param Dest Output buffer
+	 * @param DestSize Bytes available in Dest
+	 * @param ServerTime Timestamp in seconds
+	 * @return Bytes written including alignment padding, 0 if Dest is too small
+	 */
+	static int32 WriteTrackerMessage(uint8* Dest, int32 DestSize, int32 SenderId, int32 TypeId, double ServerTime, int32 SensorIndex, const FVector& Position, const FQuat& Rotation);
 
 	/**
 	 * Validate VRPN message header
@@ -28,11 +176,40 @@ public:
 	 */
 	static bool ValidateMessageHeader(const uint8* Data, int32 DataSize);
 
+	/** Size of the VRPN message header, including alignment padding */
+	static constexpr int32 VRPN_HEADER_SIZE = 24;
+
+	/** Alignment of every message within a datagram */
+	static constexpr int32 VRPN_ALIGN = 8;
+
+	/** Size of a tracker position payload (sensor + padding + 3 doubles + 4 doubles) */
+	static constexpr int32 VRPN_TRACKER_POS_QUAT_SIZE = 64;
+
+	/** Size of a tracker velocity or acceleration payload (sensor + padding + 3 doubles + 4 doubles + dt) */
+	static constexpr int32 VRPN_TRACKER_DERIVATIVE_SIZE = 72;
+
 private:
 	/** VRPN message type constants */
 	static constexpr int32 VRPN_MESSAGE_TYPE_TRACKER = 0;
-	
+
 	/** Minimum message size for a valid VRPN message */
-	static constexpr int32 VRPN_MIN_MESSAGE_SIZE = 16;
-};
+	static constexpr int32 VRPN_MIN_MESSAGE_SIZE = VRPN_HEADER_SIZE;
+
+	/**
+	 * Decode a tracker position payload
+	 * @param Payload Start of the payload (after the header)
+	 * @param PayloadSize Unpadded payload size from the header
+	 * @param OutSample Output sample; only sensor, position and rotation are written
+	 * @return true if the payload is large enough to hold a tracker report
+	 */
+	static bool ParseTrackerPayload(const uint8* Payload, int32 PayloadSize, FVRPNTrackerSample& OutSample);
 
+	/**
+	 * Decode a tracker velocity or acceleration payload
+	 * @param Payload Start of the payload (after the header)
+	 * @param PayloadSize Unpadded payload size from the header
+	 * @param OutDerivative Output report; only sensor, linear and angular rates are written
+	 * @return true if the payload is large enough to hold the report
+	 */
+	static bool ParseDerivativePayload(const uint8* Payload, int32 PayloadSize, FVRPNTrackerDerivative& OutDerivative);
+};
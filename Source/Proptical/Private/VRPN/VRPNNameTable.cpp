@@ -0,0 +1,41 @@
+#include "VRPNNameTable.h"
+#include "Misc/ScopeLock.h"
+
+FVRPNNameTable::FVRPNNameTable()
+	: Version(0)
+{
+}
+
+void FVRPNNameTable::Add(int32 SenderId, const FString& Name)
+{
+	FScopeLock ScopeLock(&Lock);
+	Names.Add(SenderId, Name);
+	Ids.Add(FName(*Name), SenderId);
+	Version.fetch_add(1, std::memory_order_release);
+}
+
+void FVRPNNameTable::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Names.Reset();
+	Ids.Reset();
+	Version.fetch_add(1, std::memory_order_release);
+}
+
+bool FVRPNNameTable::GetName(int32 SenderId, FString& OutName) const
+{
+	FScopeLock ScopeLock(&Lock);
+	if (const FString* Name = Names.Find(SenderId))
+	{
+		OutName = *Name;
+		return true;
+	}
+	return false;
+}
+
+int32 FVRPNNameTable::FindId(FName Name) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32* Id = Ids.Find(Name);
+	return Id ? *Id : INDEX_NONE;
+}
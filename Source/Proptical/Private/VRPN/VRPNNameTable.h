@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
+
+/**
+ * Interned sender (device) names of one connection
+ *
+ * VRPN describes each sender once over TCP and afterwards only sends its integer ID. The control
+ * channel records every description here; consumers resolve a name to its ID when they bind and
+ * route by integer from then on. The version changes whenever a name is added or the table is
+ * reset, so bindings only need to be resolved again when it moves.
+ */
+class FVRPNNameTable
+{
+public:
+	FVRPNNameTable();
+
+	/** Record a sender description (control channel thread) */
+	void Add(int32 SenderId, const FString& Name);
+
+	/** Forget every name, e.g. when connecting again (server IDs are per connection) */
+	void Reset();
+
+	/**
+	 * Name of a sender
+	 * @return false if the server has not described that sender
+	 */
+	bool GetName(int32 SenderId, FString& OutName) const;
+
+	/**
+	 * ID of a named sender
+	 * @return Server-side sender ID, or INDEX_NONE if no sender of that name has been described
+	 */
+	int32 FindId(FName Name) const;
+
+	/** Changes whenever a name is added or the table is reset */
+	uint32 GetVersion() const { return Version.load(std::memory_order_acquire); }
+
+private:
+	mutable FCriticalSection Lock;
+	TMap<int32, FString> Names;
+	TMap<FName, int32> Ids;
+	std::atomic<uint32> Version;
+};
@@ -0,0 +1,126 @@
+#include "VRPNOrderGuard.h"
+
+FVRPNOrderGuard::FVRPNOrderGuard()
+	: TotalLost(0)
+	, TotalReordered(0)
+	, TotalDuplicated(0)
+{
+}
+
+void FVRPNOrderGuard::Initialize(int32 Capacity)
+{
+	const int32 NewCapacity = FMath::Max(Capacity, 1);
+
+	HighWaterTimes.SetNum(NewCapacity);
+	Intervals.SetNum(NewCapacity);
+	Accepted.SetNum(NewCapacity);
+	Lost.SetNum(NewCapacity);
+	Reordered.SetNum(NewCapacity);
+	Duplicated.SetNum(NewCapacity);
+	Reset();
+}
+
+void FVRPNOrderGuard::Reset()
+{
+	for (int32 SensorId = 0; SensorId < HighWaterTimes.Num(); ++SensorId)
+	{
+		HighWaterTimes[SensorId] = 0.0;
+		Intervals[SensorId] = 0.0;
+		Accepted[SensorId].store(0, std::memory_order_relaxed);
+		Lost[SensorId].store(0, std::memory_order_relaxed);
+		Reordered[SensorId].store(0, std::memory_order_relaxed);
+		Duplicated[SensorId].store(0, std::memory_order_relaxed);
+	}
+
+	TotalLost.store(0, std::memory_order_relaxed);
+	TotalReordered.store(0, std::memory_order_relaxed);
+	TotalDuplicated.store(0, std::memory_order_relaxed);
+}
+
+bool FVRPNOrderGuard::Accept(int32 SensorId, double ServerTime)
+{
+	// Single writer: plain load/store pairs are enough for the counters
+	auto Bump = [](std::atomic<uint64>& Counter, uint64 Amount)
+	{
+		Counter.store(Counter.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+	};
+
+	double& HighWater = HighWaterTimes[SensorId];
+	double& Interval = Intervals[SensorId];
+
+	if (Accepted[SensorId].load(std::memory_order_relaxed) > 0)
+	{
+		const double Step = ServerTime - HighWater;
+		if (Step == 0.0)
+		{
+			Bump(Duplicated[SensorId], 1);
+			Bump(TotalDuplicated, 1);
+			return false;
+		}
+
+		if (Step < 0.0)
+		{
+			if (Step > -TimelineResetSeconds)
+			{
+				Bump(Reordered[SensorId], 1);
+				Bump(TotalReordered, 1);
+				return false;
+			}
+
+			// Far behind: the server's clock started over, so follow it instead of rejecting everything
+			Interval = 0.0;
+		}
+		else if (Interval <= 0.0)
+		{
+			Interval = Step;
+		}
+		else if (Step < Interval * GapFactor)
+		{
+			Interval += (Step - Interval) * IntervalSmoothing;
+		}
+		else if (Step < MaxGapSeconds)
+		{
+			// Server timestamps are measurement times, so a gap of N intervals is N - 1 missing reports
+			const int32 NumMissing = FMath::RoundToInt32(Step / Interval) - 1;
+			if (NumMissing > 0)
+			{
+				Bump(Lost[SensorId], NumMissing);
+				Bump(TotalLost, NumMissing);
+			}
+		}
+	}
+
+	HighWater = ServerTime;
+	Bump(Accepted[SensorId], 1);
+	return true;
+}
+
+bool FVRPNOrderGuard::GetSensorStats(int32 SensorId, FVRPNSensorLinkStats& OutStats) const
+{
+	OutStats = FVRPNSensorLinkStats();
+	if (!Accepted.IsValidIndex(SensorId))
+	{
+		return false;
+	}
+
+	const uint64 NumAccepted = Accepted[SensorId].load(std::memory_order_relaxed);
+	if (NumAccepted == 0)
+	{
+		return false;
+	}
+
+	const uint64 NumLost = Lost[SensorId].load(std::memory_order_relaxed);
+	const uint64 NumReordered = Reordered[SensorId].load(std::memory_order_relaxed);
+	const uint64 NumDuplicated = Duplicated[SensorId].load(std::memory_order_relaxed);
+	const double Arrived = double(NumAccepted + NumReordered + NumDuplicated);
+
+	OutStats.bValid = true;
+	OutStats.SamplesAccepted = static_cast<int64>(NumAccepted);
+	OutStats.SamplesLost = static_cast<int64>(NumLost);
+	OutStats.SamplesReordered = static_cast<int64>(NumReordered);
+	OutStats.SamplesDuplicated = static_cast<int64>(NumDuplicated);
+	OutStats.LossRate = static_cast<float>(double(NumLost) / double(NumAccepted + NumLost));
+	OutStats.ReorderRate = static_cast<float>(double(NumReordered) / Arrived);
+	OutStats.DuplicateRate = static_cast<float>(double(NumDuplicated) / Arrived);
+	return true;
+}
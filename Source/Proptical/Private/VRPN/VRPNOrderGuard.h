@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTypes.h"
+#include <atomic>
+
+/**
+ * Rejects stale and duplicate samples and accounts for loss, per sensor
+ *
+ * UDP may reorder and duplicate datagrams. Each sensor keeps a high-water mark on the server
+ * timestamp of the newest sample accepted; anything at or below it is discarded before it can
+ * reach the filters, the sensor table or the game thread, so a late datagram never moves a
+ * body backwards. VRPN messages carry no sequence number, so loss is estimated from gaps in
+ * the server timestamps against the sensor's own report interval.
+ *
+ * State is indexed by dense sensor ID and written by the receive thread only. Counters are
+ * relaxed atomics and can be read from any thread.
+ */
+class FVRPNOrderGuard
+{
+public:
+	FVRPNOrderGuard();
+
+	/**
+	 * Allocate state for a fixed number of sensors (call before the receive thread starts)
+	 * @param Capacity Capacity of the connection's sensor table
+	 */
+	void Initialize(int32 Capacity);
+
+	/** Forget every sensor's history and counters (receive thread, or before it starts) */
+	void Reset();
+
+	/**
+	 * Check a sample against its sensor's newest accepted server timestamp (receive thread only)
+	 * @param SensorId Dense sensor ID
+	 * @param ServerTime Server timestamp of the sample
+	 * @return false if the sample is a duplicate or older than one already accepted
+	 */
+	bool Accept(int32 SensorId, double ServerTime);
+
+	/**
+	 * Counters and rates of one sensor
+	 * @return false if the sensor has not reported yet
+	 */
+	bool GetSensorStats(int32 SensorId, FVRPNSensorLinkStats& OutStats) const;
+
+	/** Samples estimated lost, on every sensor */
+	uint64 GetTotalLost() const { return TotalLost.load(std::memory_order_relaxed); }
+
+	/** Samples rejected for arriving after a newer one, on every sensor */
+	uint64 GetTotalReordered() const { return TotalReordered.load(std::memory_order_relaxed); }
+
+	/** Samples rejected for repeating the newest timestamp, on every sensor */
+	uint64 GetTotalDuplicated() const { return TotalDuplicated.load(std::memory_order_relaxed); }
+
+private:
+	/** Newest accepted server timestamp and smoothed report interval per sensor (receive thread only) */
+	TArray<double> HighWaterTimes;
+	TArray<double> Intervals;
+
+	/** Per-sensor counters */
+	TArray<std::atomic<uint64>> Accepted;
+	TArray<std::atomic<uint64>> Lost;
+	TArray<std::atomic<uint64>> Reordered;
+	TArray<std::atomic<uint64>> Duplicated;
+
+	/** Sums over every sensor */
+	std::atomic<uint64> TotalLost;
+	std::atomic<uint64> TotalReordered;
+	std::atomic<uint64> TotalDuplicated;
+
+	/** A sample this far behind the high-water mark means the server timeline restarted (server restart, replay loop) */
+	static constexpr double TimelineResetSeconds = 1.0;
+
+	/** Gaps longer than this are an outage (body occluded, server paused) rather than lost samples */
+	static constexpr double MaxGapSeconds = 0.5;
+
+	/** A step longer than this many report intervals is a gap */
+	static constexpr double GapFactor = 1.5;
+
+	/** Weight of each new step in the smoothed report interval */
+	static constexpr double IntervalSmoothing = 0.05;
+};
@@ -0,0 +1,175 @@
+#include "VRPNPoseHistory.h"
+#include "VRPN/VRPNLog.h"
+
+FVRPNPoseHistory::FVRPNPoseHistory()
+	: Depth(0)
+	, DepthMask(0)
+{
+}
+
+void FVRPNPoseHistory::Initialize(int32 Capacity, int64 BudgetBytes)
+{
+	const int32 NumSensors = FMath::Max(Capacity, 1);
+
+	// Largest power of two that fits the budget, so slots are a mask away from entry numbers
+	const int64 EntriesPerSensor = FMath::Min<int64>(FMath::Max<int64>(BudgetBytes, 0) / (BytesPerEntry * NumSensors), MaxDepth);
+	Depth = EntriesPerSensor >= 2 ? static_cast<int32>(FMath::RoundDownToPowerOfTwo(static_cast<uint32>(EntriesPerSensor))) : 0;
+	DepthMask = Depth > 0 ? uint64(Depth - 1) : 0;
+	if (Depth == 0 && BudgetBytes > 0)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Pose history budget of %lld bytes is too small for %d sensors; history disabled"), BudgetBytes, NumSensors);
+	}
+
+	Heads.SetNum(NumSensors);
+	Claims.SetNum(NumSensors);
+	Starts.SetNum(NumSensors);
+	Positions.Init(FVector::ZeroVector, NumSensors * Depth);
+	Rotations.Init(FQuat::Identity, NumSensors * Depth);
+	Timestamps.Init(0.0, NumSensors * Depth);
+	Reset();
+}
+
+void FVRPNPoseHistory::Reset()
+{
+	for (int32 SensorId = 0; SensorId < Heads.Num(); ++SensorId)
+	{
+		Heads[SensorId].store(0, std::memory_order_relaxed);
+		Claims[SensorId].store(0, std::memory_order_relaxed);
+		Starts[SensorId].store(0, std::memory_order_relaxed);
+	}
+}
+
+void FVRPNPoseHistory::Write(int32 SensorId, const FVector& Position, const FQuat& Rotation, double Timestamp)
+{
+	if (Depth == 0)
+	{
+		return;
+	}
+
+	const int32 Base = SensorId * Depth;
+	const uint64 Head = Heads[SensorId].load(std::memory_order_relaxed);
+	if (Head > Starts[SensorId].load(std::memory_order_relaxed))
+	{
+		// The search needs ascending times. Clock model corrections can step mapped times back slightly;
+		// those samples are left out, while a large step back starts a new timeline.
+		const double Newest = Timestamps[Base + int32((Head - 1) & DepthMask)];
+		if (Timestamp <= Newest)
+		{
+			if (Newest - Timestamp < TimelineResetSeconds)
+			{
+				return;
+			}
+			Starts[SensorId].store(Head, std::memory_order_release);
+		}
+	}
+
+	// Same ordering as TVRPNSeqLock::Write: a reader that sees any of the new stores also sees the claim
+	Claims[SensorId].store(Head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const int32 Slot = Base + int32(Head & DepthMask);
+	Positions[Slot] = Position;
+	Rotations[Slot] = Rotation;
+	Timestamps[Slot] = Timestamp;
+
+	Heads[SensorId].store(Head + 1, std::memory_order_release);
+}
+
+bool FVRPNPoseHistory::Sample(int32 SensorId, double Time, FVRPNTransformData& OutTransform) const
+{
+	if (Depth == 0 || !Heads.IsValidIndex(SensorId))
+	{
+		return false;
+	}
+
+	const int32 Base = SensorId * Depth;
+	for (;;)
+	{
+		const uint64 Head = Heads[SensorId].load(std::memory_order_acquire);
+		const uint64 Start = Starts[SensorId].load(std::memory_order_acquire);
+
+		// The slot of entry Head - Depth is the one the writer fills next, so the window stops one short of the ring
+		const uint64 Oldest = FMath::Max(Start, Head >= uint64(Depth) ? Head - Depth + 1 : 0);
+		if (Oldest >= Head)
+		{
+			return false;
+		}
+
+		// First entry newer than Time
+		uint64 Low = Oldest;
+		uint64 High = Head;
+		while (Low < High)
+		{
+			const uint64 Mid = Low + (High - Low) / 2;
+			if (Timestamps[Base + int32(Mid & DepthMask)] <= Time)
+			{
+				Low = Mid + 1;
+			}
+			else
+			{
+				High = Mid;
+			}
+		}
+
+		// Entries A and B around Time; past the newest entry they are the two newest
+		const bool bAfterNewest = Low == Head;
+		const uint64 EntryB = bAfterNewest ? Head - 1 : Low;
+		const bool bHasA = EntryB > Oldest;
+		const uint64 EntryA = bHasA ? EntryB - 1 : EntryB;
+
+		const int32 SlotA = Base + int32(EntryA & DepthMask);
+		const int32 SlotB = Base + int32(EntryB & DepthMask);
+		const FVector PositionA = Positions[SlotA];
+		const FQuat RotationA = Rotations[SlotA];
+		const double TimeA = Timestamps[SlotA];
+		const FVector PositionB = Positions[SlotB];
+		const FQuat RotationB = Rotations[SlotB];
+		const double TimeB = Timestamps[SlotB];
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// Overwritten (or being overwritten) while searching or copying: the window moved on, search again
+		if (EntryA + Depth <= Claims[SensorId].load(std::memory_order_relaxed))
+		{
+			continue;
+		}
+		if (bAfterNewest ? TimeB > Time : (TimeB <= Time || (bHasA && TimeA > Time)))
+		{
+			continue;
+		}
+
+		if (!bHasA)
+		{
+			if (!bAfterNewest)
+			{
+				// Older than anything kept
+				return false;
+			}
+			OutTransform = FVRPNTransformData(PositionB, RotationB, TimeB);
+			return true;
+		}
+
+		const double DeltaTime = TimeB - TimeA;
+		FQuat ToB = RotationB;
+		if ((ToB | RotationA) < 0.0)
+		{
+			ToB = ToB * -1.0;
+		}
+
+		FVector Axis;
+		double Angle;
+		(ToB * RotationA.Inverse()).ToAxisAndAngle(Axis, Angle);
+		const FVector Velocity = (PositionB - PositionA) / DeltaTime;
+		const FVector AngularVelocity = Axis * (Angle / DeltaTime);
+
+		if (bAfterNewest)
+		{
+			OutTransform = FVRPNTransformData(PositionB, RotationB, TimeB, Velocity, AngularVelocity);
+			return true;
+		}
+
+		const double Alpha = (Time - TimeA) / DeltaTime;
+		OutTransform = FVRPNTransformData(FMath::Lerp(PositionA, PositionB, Alpha), FQuat::Slerp(RotationA, ToB, Alpha).GetNormalized(),
+			Time, Velocity, AngularVelocity);
+		return true;
+	}
+}
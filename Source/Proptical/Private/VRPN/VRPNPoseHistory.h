@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTransformData.h"
+#include <atomic>
+
+/**
+ * Recent poses of every sensor of one connection, for queries at a past time
+ *
+ * Each sensor owns a fixed-size ring of (position, rotation, measurement time) entries in
+ * structure-of-arrays storage indexed by dense sensor ID. The receive thread appends without
+ * ever waiting; readers on any thread binary-search the ring by time and interpolate between
+ * the two entries around the requested time. The writer claims a slot before overwriting it and a
+ * reader re-checks the claims after copying, so an entry overwritten mid-read is retried instead
+ * of returned torn.
+ *
+ * The ring depth follows from a memory budget and the sensor capacity; all storage is sized
+ * once in Initialize(). Writes are receive-thread only, everything else is safe from any thread.
+ */
+class FVRPNPoseHistory
+{
+public:
+	FVRPNPoseHistory();
+
+	/**
+	 * Allocate storage (call before the receive thread starts)
+	 * @param Capacity Capacity of the connection's sensor table
+	 * @param BudgetBytes Memory for every ring together; 0 disables the history
+	 */
+	void Initialize(int32 Capacity, int64 BudgetBytes);
+
+	/** Forget every sensor's history (call before the receive thread starts) */
+	void Reset();
+
+	/** Entries kept per sensor (0 when disabled) */
+	int32 GetDepth() const { return Depth; }
+
+	/**
+	 * Append a sensor's pose (receive thread only)
+	 * @param Timestamp Measurement time on the local clock
+	 */
+	void Write(int32 SensorId, const FVector& Position, const FQuat& Rotation, double Timestamp);
+
+	/**
+	 * Pose of a sensor at a past time
+	 * Interpolated between the entries around Time; velocities are the rate of change between them.
+	 * Times after the newest entry return the newest entry.
+	 * @param SensorId Dense sensor ID
+	 * @param Time Local time (FPlatformTime::Seconds, same clock as FVRPNTransformData::Timestamp)
+	 * @param OutTransform Pose at Time
+	 * @return false if the sensor has no history or Time is older than its oldest entry
+	 */
+	bool Sample(int32 SensorId, double Time, FVRPNTransformData& OutTransform) const;
+
+	/** Memory used by one entry */
+	static constexpr int64 BytesPerEntry = sizeof(FVector) + sizeof(FQuat) + sizeof(double);
+
+private:
+	/** Entries per sensor (power of two) and Depth - 1 */
+	int32 Depth;
+	uint64 DepthMask;
+
+	/** Entries ever written per sensor; entry N lives in slot N & DepthMask (published with release) */
+	TArray<std::atomic<uint64>> Heads;
+
+	/** Per sensor, one past the entry being written; stored and fenced before the slot is overwritten */
+	TArray<std::atomic<uint64>> Claims;
+
+	/** First entry of the sensor's current timeline; older entries belong to a timeline that was restarted */
+	TArray<std::atomic<uint64>> Starts;
+
+	/** Ring storage, SensorId * Depth + slot */
+	TArray<FVector> Positions;
+	TArray<FQuat> Rotations;
+	TArray<double> Timestamps;
+
+	/** Largest ring kept per sensor, whatever the budget */
+	static constexpr int32 MaxDepth = 65536;
+
+	/** A sample this far behind the newest entry means the timeline restarted (server restart, replay loop) */
+	static constexpr double TimelineResetSeconds = 1.0;
+};
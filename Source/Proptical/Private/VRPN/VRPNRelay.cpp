@@ -0,0 +1,353 @@
+#include "VRPNRelay.h"
+#include "VRPN/VRPNLog.h"
+#include "VRPNWire.h"
+#include "VRPNSensorTable.h"
+#include "VRPNNameTable.h"
+#include "VRPNDatagramReceiver.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+namespace VRPNRelay
+{
+	/** 'PRLY' */
+	constexpr uint32 Magic = 0x50524C59;
+	constexpr uint8 Version = 1;
+
+	constexpr uint8 KindPoses = 0;
+	constexpr uint8 KindNames = 1;
+
+	/** Position quanta per Unreal unit (1/1000 cm, +-21 km range) */
+	constexpr double PositionScale = 1000.0;
+
+	/** Largest value of a 15-bit rotation component */
+	constexpr double RotationQuantMax = 32767.0;
+
+	/** Multicast hops; a stage network is a single subnet */
+	constexpr uint8 MulticastTtl = 1;
+
+	int32 QuantizePosition(double Value)
+	{
+		return static_cast<int32>(FMath::Clamp<int64>(FMath::RoundToInt64(Value * PositionScale), MIN_int32, MAX_int32));
+	}
+
+	/** Smallest-three: drop the largest component (rebuilt from unit length) and store the others in 15 bits each */
+	void WriteRotation(uint8* Ptr, const FQuat& InRotation)
+	{
+		const FQuat Rotation = InRotation.GetNormalized();
+		const double Components[4] = { Rotation.X, Rotation.Y, Rotation.Z, Rotation.W };
+
+		int32 Largest = 0;
+		for (int32 Index = 1; Index < 4; ++Index)
+		{
+			if (FMath::Abs(Components[Index]) > FMath::Abs(Components[Largest]))
+			{
+				Largest = Index;
+			}
+		}
+
+		// q and -q are the same rotation, so the dropped component is made positive; the others are then within +-1/sqrt(2)
+		const double Sign = Components[Largest] < 0.0 ? -1.0 : 1.0;
+		uint64 Bits = uint64(Largest);
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			if (Index != Largest)
+			{
+				const double Unit = FMath::Clamp(Components[Index] * Sign * UE_DOUBLE_SQRT_2 * 0.5 + 0.5, 0.0, 1.0);
+				Bits = (Bits << 15) | uint64(FMath::RoundToInt64(Unit * RotationQuantMax));
+			}
+		}
+
+		// 47 bits, left-aligned in 48
+		Bits <<= 1;
+		VRPNWire::WriteUInt16(Ptr, uint16(Bits >> 32));
+		VRPNWire::WriteUInt32(Ptr + 2, uint32(Bits));
+	}
+
+	FQuat ReadRotation(const uint8* Ptr)
+	{
+		const uint64 Bits = ((uint64(VRPNWire::ReadUInt16(Ptr)) << 32) | uint64(VRPNWire::ReadUInt32(Ptr + 2))) >> 1;
+		const int32 Largest = int32(Bits >> 45);
+
+		double Components[4];
+		double SumSquares = 0.0;
+		int32 Shift = 30;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			if (Index != Largest)
+			{
+				const double Unit = double((Bits >> Shift) & 0x7FFF) / RotationQuantMax;
+				Components[Index] = (Unit * 2.0 - 1.0) / UE_DOUBLE_SQRT_2;
+				SumSquares += Components[Index] * Components[Index];
+				Shift -= 15;
+			}
+		}
+		Components[Largest] = FMath::Sqrt(FMath::Max(1.0 - SumSquares, 0.0));
+
+		return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+	}
+}
+
+FVRPNRelay::FVRPNRelay()
+	: Socket(nullptr)
+	, NumPending(0)
+	, PendingTime(0.0)
+	, NumDatagramsSent(0)
+{
+	Buffer.SetNumZeroed(MaxDatagramSize);
+}
+
+FVRPNRelay::~FVRPNRelay()
+{
+	Close();
+}
+
+bool FVRPNRelay::Open(const FString& TargetAddress, int32 TargetPort, const FString& InterfaceAddress)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		return false;
+	}
+
+	TargetAddr = SocketSubsystem->CreateInternetAddr();
+	bool bIsValid = false;
+	TargetAddr->SetIp(*TargetAddress, bIsValid);
+	if (!bIsValid)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Invalid relay target: %s"), *TargetAddress);
+		return false;
+	}
+	TargetAddr->SetPort(TargetPort);
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("VRPN_Relay"), TargetAddr->GetProtocolType());
+	if (!Socket)
+	{
+		UE_LOG(LogVRPN, Warning, TEXT("Failed to create relay socket"));
+		return false;
+	}
+
+	// The receive thread sends; a full send buffer drops a datagram instead of stalling it
+	Socket->SetNonBlocking(true);
+
+	if (FVRPNDatagramReceiver::IsMulticastAddress(TargetAddress))
+	{
+		// Loopback keeps the group readable by peers on the relaying host itself
+		Socket->SetMulticastLoopback(true);
+		Socket->SetMulticastTtl(VRPNRelay::MulticastTtl);
+		if (!InterfaceAddress.IsEmpty())
+		{
+			bool bInterfaceValid = false;
+			TSharedRef<FInternetAddr> InterfaceAddr = SocketSubsystem->CreateInternetAddr(TargetAddr->GetProtocolType());
+			InterfaceAddr->SetIp(*InterfaceAddress, bInterfaceValid);
+			if (!bInterfaceValid || !Socket->SetMulticastInterface(*InterfaceAddr))
+			{
+				UE_LOG(LogVRPN, Warning, TEXT("Relay could not send on interface %s; using the default"), *InterfaceAddress);
+			}
+		}
+	}
+
+	UE_LOG(LogVRPN, Log, TEXT("Relaying poses to %s:%d"), *TargetAddress, TargetPort);
+	return true;
+}
+
+void FVRPNRelay::Close()
+{
+	if (Socket)
+	{
+		Flush();
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+void FVRPNRelay::Add(int32 SenderId, int32 SensorIndex, const FVRPNTransformData& Transform, double RelayTime)
+{
+	if (!Socket || SenderId < 0 || SenderId > MAX_uint16 || SensorIndex < 0 || SensorIndex > MAX_uint16)
+	{
+		return;
+	}
+
+	if (NumPending == MaxPosesPerDatagram || (NumPending > 0 && RelayTime != PendingTime))
+	{
+		Flush();
+	}
+	PendingTime = RelayTime;
+
+	uint8* Record = Buffer.GetData() + HeaderSize + NumPending * PoseRecordSize;
+	const int64 AgeMicros = FMath::RoundToInt64((RelayTime - Transform.Timestamp) * 1.0e6);
+	VRPNWire::WriteUInt16(Record, uint16(SenderId));
+	VRPNWire::WriteUInt16(Record + 2, uint16(SensorIndex));
+	VRPNWire::WriteUInt32(Record + 4, uint32(FMath::Clamp<int64>(AgeMicros, MIN_int32, MAX_int32)));
+	VRPNWire::WriteUInt32(Record + 8, uint32(VRPNRelay::QuantizePosition(Transform.Position.X)));
+	VRPNWire::WriteUInt32(Record + 12, uint32(VRPNRelay::QuantizePosition(Transform.Position.Y)));
+	VRPNWire::WriteUInt32(Record + 16, uint32(VRPNRelay::QuantizePosition(Transform.Position.Z)));
+	VRPNRelay::WriteRotation(Record + 20, Transform.Rotation);
+	++NumPending;
+}
+
+void FVRPNRelay::Flush()
+{
+	if (NumPending == 0)
+	{
+		return;
+	}
+
+	WriteHeader(VRPNRelay::KindPoses, NumPending, PendingTime);
+	Send(HeaderSize + NumPending * PoseRecordSize);
+	NumPending = 0;
+}
+
+void FVRPNRelay::PublishNames(const FVRPNSensorTable& SensorTable, const FVRPNNameTable& Names)
+{
+	if (!Socket)
+	{
+		return;
+	}
+	Flush();
+
+	NameSenderIds.Reset();
+	const int32 NumSensors = SensorTable.Num();
+	for (int32 SensorId = 0; SensorId < NumSensors; ++SensorId)
+	{
+		const int32 SenderId = SensorTable.GetSenderId(SensorId);
+		if (SenderId >= 0 && SenderId <= MAX_uint16)
+		{
+			NameSenderIds.AddUnique(SenderId);
+		}
+	}
+
+	int32 Size = HeaderSize;
+	int32 Count = 0;
+	FString Name;
+	for (const int32 SenderId : NameSenderIds)
+	{
+		if (!Names.GetName(SenderId, Name))
+		{
+			continue;
+		}
+
+		const FTCHARToUTF8 Utf8(*Name);
+		const int32 Length = FMath::Min(Utf8.Length(), int32(MAX_uint8));
+		if (Size + 3 + Length > MaxDatagramSize)
+		{
+			WriteHeader(VRPNRelay::KindNames, Count, 0.0);
+			Send(Size);
+			Size = HeaderSize;
+			Count = 0;
+		}
+
+		uint8* Record = Buffer.GetData() + Size;
+		VRPNWire::WriteUInt16(Record, uint16(SenderId));
+		Record[2] = uint8(Length);
+		FMemory::Memcpy(Record + 3, Utf8.Get(), Length);
+		Size += 3 + Length;
+		++Count;
+	}
+
+	if (Count > 0)
+	{
+		WriteHeader(VRPNRelay::KindNames, Count, 0.0);
+		Send(Size);
+	}
+}
+
+bool FVRPNRelay::IsRelayDatagram(const uint8* Data, int32 DataSize)
+{
+	// A VRPN datagram starts with a message length, which never comes near the magic's value
+	return DataSize >= HeaderSize && VRPNWire::ReadUInt32(Data) == VRPNRelay::Magic;
+}
+
+FVRPNParseResult FVRPNRelay::ParseDatagram(const uint8* Data, int32 DataSize, TArrayView<FVRPNTrackerSample> OutSamples, FVRPNNameTable& OutNames)
+{
+	FVRPNParseResult Result;
+	if (!IsRelayDatagram(Data, DataSize) || Data[4] != VRPNRelay::Version)
+	{
+		Result.bMalformed = true;
+		return Result;
+	}
+
+	const uint8 Kind = Data[5];
+	const int32 Count = VRPNWire::ReadUInt16(Data + 6);
+	const double RelayTime = VRPNWire::ReadDouble(Data + 8);
+
+	if (Kind == VRPNRelay::KindPoses)
+	{
+		if (HeaderSize + Count * PoseRecordSize > DataSize)
+		{
+			Result.bMalformed = true;
+			return Result;
+		}
+
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			++Result.NumMessages;
+			if (Result.NumSamples >= OutSamples.Num())
+			{
+				++Result.NumDropped;
+				continue;
+			}
+
+			const uint8* Record = Data + HeaderSize + Index * PoseRecordSize;
+			FVRPNTrackerSample& Sample = OutSamples[Result.NumSamples++];
+			Sample.SenderId = VRPNWire::ReadUInt16(Record);
+			Sample.SensorIndex = VRPNWire::ReadUInt16(Record + 2);
+			Sample.ServerTime = RelayTime - double(VRPNWire::ReadInt32(Record + 4)) * 1.0e-6;
+			Sample.Position = FVector(
+				double(VRPNWire::ReadInt32(Record + 8)) / VRPNRelay::PositionScale,
+				double(VRPNWire::ReadInt32(Record + 12)) / VRPNRelay::PositionScale,
+				double(VRPNWire::ReadInt32(Record + 16)) / VRPNRelay::PositionScale);
+			Sample.Rotation = VRPNRelay::ReadRotation(Record + 20);
+		}
+		return Result;
+	}
+
+	if (Kind == VRPNRelay::KindNames)
+	{
+		int32 Offset = HeaderSize;
+		FString Existing;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			if (Offset + 3 > DataSize || Offset + 3 + Data[Offset + 2] > DataSize)
+			{
+				Result.bMalformed = true;
+				break;
+			}
+
+			const int32 SenderId = VRPNWire::ReadUInt16(Data + Offset);
+			const int32 Length = Data[Offset + 2];
+			const FUTF8ToTCHAR Utf8(reinterpret_cast<const ANSICHAR*>(Data + Offset + 3), Length);
+			const FString Name(Utf8.Length(), Utf8.Get());
+			if (!OutNames.GetName(SenderId, Existing) || Existing != Name)
+			{
+				OutNames.Add(SenderId, Name);
+			}
+			Offset += 3 + Length;
+			++Result.NumMessages;
+		}
+		return Result;
+	}
+
+	// Kinds from a newer relay are skipped, not treated as damage
+	return Result;
+}
+
+void FVRPNRelay::WriteHeader(uint8 Kind, int32 Count, double RelayTime)
+{
+	uint8* Header = Buffer.GetData();
+	VRPNWire::WriteUInt32(Header, VRPNRelay::Magic);
+	Header[4] = VRPNRelay::Version;
+	Header[5] = Kind;
+	VRPNWire::WriteUInt16(Header + 6, uint16(Count));
+	VRPNWire::WriteDouble(Header + 8, RelayTime);
+}
+
+void FVRPNRelay::Send(int32 Size)
+{
+	int32 BytesSent = 0;
+	if (Socket->SendTo(Buffer.GetData(), Size, BytesSent, *TargetAddr))
+	{
+		++NumDatagramsSent;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTransformData.h"
+#include "VRPNMessageParser.h"
+
+class FSocket;
+class FInternetAddr;
+class FVRPNSensorTable;
+class FVRPNNameTable;
+
+/**
+ * Re-publishes a connection's poses to cluster peers in a compact quantized datagram
+ *
+ * One node receives from the tracking server and relays every accepted, frame-converted pose
+ * (usually to a multicast group); the other render nodes listen to the relay instead of each
+ * opening a stream of their own. Peers decode relay datagrams in place of VRPN messages and run
+ * them through the rest of their pipeline as usual.
+ *
+ * Wire format (big-endian):
+ * - Header (16 bytes): magic 'PRLY', version (uint8), kind (uint8), record count (uint16),
+ *   relay time (double, the relay's local receive time of the poses)
+ * - Pose record (26 bytes): sender ID (uint16), sensor index (uint16), age in microseconds before the
+ *   relay time (int32), position (3 x int32 in 1/1000 cm), rotation (48 bits smallest-three:
+ *   2-bit index of the dropped component, then the other three in 15 bits each)
+ * - Name record: sender ID (uint16), name length (uint8), UTF-8 name
+ *
+ * Pose records are flushed once per received datagram, so relaying adds no batching delay; names
+ * go out about once per second so peers can bind by device name. Velocities are not relayed,
+ * peers estimate them with their own filters.
+ */
+class FVRPNRelay
+{
+public:
+	FVRPNRelay();
+	~FVRPNRelay();
+
+	/**
+	 * Create the send socket (game thread, before the receive thread starts)
+	 * @param TargetAddress Multicast group or unicast address of the peers
+	 * @param TargetPort UDP port the peers listen on
+	 * @param InterfaceAddress Address of the local interface to send multicast from, empty for the system default
+	 * @return false if the socket could not be created
+	 */
+	bool Open(const FString& TargetAddress, int32 TargetPort, const FString& InterfaceAddress);
+
+	/** Flush pending records and close the socket (after the receive thread stopped) */
+	void Close();
+
+	/**
+	 * Queue one pose; sends a datagram whenever one is full (receive thread only)
+	 * @param RelayTime Local time the pose was received; every record of a datagram shares it
+	 */
+	void Add(int32 SenderId, int32 SensorIndex, const FVRPNTransformData& Transform, double RelayTime);
+
+	/** Send the queued poses (receive thread only, once per received datagram) */
+	void Flush();
+
+	/** Send the names of every sender in the sensor table (receive thread only) */
+	void PublishNames(const FVRPNSensorTable& SensorTable, const FVRPNNameTable& Names);
+
+	/** Datagrams sent so far */
+	uint64 GetNumDatagramsSent() const { return NumDatagramsSent; }
+
+	/** True if the datagram carries relay records rather than VRPN messages */
+	static bool IsRelayDatagram(const uint8* Data, int32 DataSize);
+
+	/**
+	 * Decode a relay datagram
+	 * Poses come out in Unreal space already; their server time is the relay's clock. Name records
+	 * are recorded in OutNames (only when a name changed, so bindings are not resolved again needlessly).
+	 * @param OutSamples Caller-provided storage; records beyond its size are counted as dropped
+	 * @return Summary of the walk (every record counts as a message)
+	 */
+	static FVRPNParseResult ParseDatagram(const uint8* Data, int32 DataSize, TArrayView<FVRPNTrackerSample> OutSamples, FVRPNNameTable& OutNames);
+
+	/** Size of the datagram header */
+	static constexpr int32 HeaderSize = 16;
+
+	/** Size of one pose record */
+	static constexpr int32 PoseRecordSize = 26;
+
+	/** Largest datagram sent; stays under the Ethernet MTU so nothing is fragmented */
+	static constexpr int32 MaxDatagramSize = 1200;
+
+	/** Pose records per datagram */
+	static constexpr int32 MaxPosesPerDatagram = (MaxDatagramSize - HeaderSize) / PoseRecordSize;
+
+private:
+	/** Send Size bytes of Buffer */
+	void Send(int32 Size);
+
+	/** Write the header of a datagram of the given kind into Buffer */
+	void WriteHeader(uint8 Kind, int32 Count, double RelayTime);
+
+	FSocket* Socket;
+	TSharedPtr<FInternetAddr> TargetAddr;
+
+	/** Datagram being filled, allocated once */
+	TArray<uint8> Buffer;
+
+	/** Pose records in Buffer and the relay time they share */
+	int32 NumPending;
+	double PendingTime;
+
+	/** Scratch for PublishNames, reused */
+	TArray<int32> NameSenderIds;
+
+	uint64 NumDatagramsSent;
+};
@@ -0,0 +1,201 @@
+#include "VRPNSensorTable.h"
+#include "HAL/PlatformProcess.h"
+
+FVRPNSensorTable::FVRPNSensorTable()
+	: RegistryMask(0)
+	, NumSensors(0)
+{
+}
+
+void FVRPNSensorTable::Initialize(int32 InCapacity)
+{
+	const int32 NewCapacity = FMath::Max(InCapacity, 1);
+
+	// Keep the registry at most half full so probes stay short
+	const uint32 RegistrySize = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(NewCapacity * 2));
+	RegistryKeys.SetNum(RegistrySize);
+	RegistryValues.Init(INDEX_NONE, RegistrySize);
+	RegistryMask = RegistrySize - 1;
+	for (std::atomic<uint64>& Key : RegistryKeys)
+	{
+		Key.store(EmptyKey, std::memory_order_relaxed);
+	}
+
+	SenderIds.Init(INDEX_NONE, NewCapacity);
+	SensorIndices.Init(INDEX_NONE, NewCapacity);
+	Sequences.SetNum(NewCapacity);
+	for (std::atomic<uint32>& Sequence : Sequences)
+	{
+		Sequence.store(0, std::memory_order_relaxed);
+	}
+
+	Positions.Init(FVector::ZeroVector, NewCapacity);
+	Rotations.Init(FQuat::Identity, NewCapacity);
+	Timestamps.Init(0.0, NewCapacity);
+	Velocities.Init(FVector::ZeroVector, NewCapacity);
+	AngularVelocities.Init(FVector::ZeroVector, NewCapacity);
+	Accelerations.Init(FVector::ZeroVector, NewCapacity);
+	AngularAccelerations.Init(FVector::ZeroVector, NewCapacity);
+
+	NumSensors.store(0, std::memory_order_release);
+}
+
+int32 FVRPNSensorTable::FindOrAdd(int32 SenderId, int32 SensorIndex)
+{
+	const uint64 Key = MakeKey(SenderId, SensorIndex);
+	uint32 Slot = static_cast<uint32>(GetTypeHash(Key)) & RegistryMask;
+
+	for (;;)
+	{
+		const uint64 SlotKey = RegistryKeys[Slot].load(std::memory_order_relaxed);
+		if (SlotKey == Key)
+		{
+			return RegistryValues[Slot];
+		}
+		if (SlotKey == EmptyKey)
+		{
+			break;
+		}
+		Slot = (Slot + 1) & RegistryMask;
+	}
+
+	const int32 SensorId = NumSensors.load(std::memory_order_relaxed);
+	if (SensorId >= Capacity())
+	{
+		return INDEX_NONE;
+	}
+
+	// Fill in everything a reader may look at before publishing the key and the new count
+	SenderIds[SensorId] = SenderId;
+	SensorIndices[SensorId] = SensorIndex;
+	RegistryValues[Slot] = SensorId;
+	RegistryKeys[Slot].store(Key, std::memory_order_release);
+	NumSensors.store(SensorId + 1, std::memory_order_release);
+	return SensorId;
+}
+
+int32 FVRPNSensorTable::Find(int32 SenderId, int32 SensorIndex) const
+{
+	if (RegistryKeys.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const uint64 Key = MakeKey(SenderId, SensorIndex);
+	uint32 Slot = static_cast<uint32>(GetTypeHash(Key)) & RegistryMask;
+
+	for (;;)
+	{
+		const uint64 SlotKey = RegistryKeys[Slot].load(std::memory_order_acquire);
+		if (SlotKey == Key)
+		{
+			return RegistryValues[Slot];
+		}
+		if (SlotKey == EmptyKey)
+		{
+			return INDEX_NONE;
+		}
+		Slot = (Slot + 1) & RegistryMask;
+	}
+}
+
+void FVRPNSensorTable::Write(int32 SensorId, const FVRPNTransformData& Transform)
+{
+	std::atomic<uint32>& Sequence = Sequences[SensorId];
+	const uint32 Begin = Sequence.load(std::memory_order_relaxed);
+	Sequence.store(Begin + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Positions[SensorId] = Transform.Position;
+	Rotations[SensorId] = Transform.Rotation;
+	Timestamps[SensorId] = Transform.Timestamp;
+	Velocities[SensorId] = Transform.Velocity;
+	AngularVelocities[SensorId] = Transform.AngularVelocity;
+	Accelerations[SensorId] = Transform.Acceleration;
+	AngularAccelerations[SensorId] = Transform.AngularAcceleration;
+
+	Sequence.store(Begin + 2, std::memory_order_release);
+}
+
+template <typename CopyFunc>
+bool FVRPNSensorTable::ReadConsistent(int32 SensorId, CopyFunc Copy) const
+{
+	if (SensorId < 0 || SensorId >= Num())
+	{
+		return false;
+	}
+
+	const std::atomic<uint32>& Sequence = Sequences[SensorId];
+	for (;;)
+	{
+		const uint32 Begin = Sequence.load(std::memory_order_acquire);
+		if (Begin & 1)
+		{
+			// Receive thread is mid-write of this sensor; it only holds it for a few nanoseconds
+			FPlatformProcess::Yield();
+			continue;
+		}
+
+		Copy();
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (Sequence.load(std::memory_order_relaxed) == Begin)
+		{
+			return Begin != 0;
+		}
+	}
+}
+
+bool FVRPNSensorTable::Read(int32 SensorId, FVRPNTransformData& OutTransform) const
+{
+	return ReadConsistent(SensorId, [this, SensorId, &OutTransform]()
+	{
+		OutTransform = FVRPNTransformData(Positions[SensorId], Rotations[SensorId], Timestamps[SensorId], Velocities[SensorId], AngularVelocities[SensorId],
+			Accelerations[SensorId], AngularAccelerations[SensorId]);
+	});
+}
+
+bool FVRPNSensorTable::ReadPose(int32 SensorId, FVector& OutPosition, FQuat& OutRotation, double& OutTimestamp) const
+{
+	return ReadConsistent(SensorId, [this, SensorId, &OutPosition, &OutRotation, &OutTimestamp]()
+	{
+		OutPosition = Positions[SensorId];
+		OutRotation = Rotations[SensorId];
+		OutTimestamp = Timestamps[SensorId];
+	});
+}
+
+void FVRPNSensorTable::CopyTo(FVRPNSensorSnapshot& OutSnapshot) const
+{
+	const int32 Count = Num();
+
+	// Sizes only grow up to the table capacity, so after warm-up this never reallocates
+	OutSnapshot.Positions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Rotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Timestamps.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Velocities.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.AngularVelocities.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.Accelerations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.AngularAccelerations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.SenderIds.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.SensorIndices.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutSnapshot.ValidBits.SetNum(Count, false);
+
+	for (int32 SensorId = 0; SensorId < Count; ++SensorId)
+	{
+		const bool bValid = ReadConsistent(SensorId, [this, SensorId, &OutSnapshot]()
+		{
+			OutSnapshot.Positions[SensorId] = Positions[SensorId];
+			OutSnapshot.Rotations[SensorId] = Rotations[SensorId];
+			OutSnapshot.Timestamps[SensorId] = Timestamps[SensorId];
+			OutSnapshot.Velocities[SensorId] = Velocities[SensorId];
+			OutSnapshot.AngularVelocities[SensorId] = AngularVelocities[SensorId];
+			OutSnapshot.Accelerations[SensorId] = Accelerations[SensorId];
+			OutSnapshot.AngularAccelerations[SensorId] = AngularAccelerations[SensorId];
+		});
+
+		OutSnapshot.SenderIds[SensorId] = SenderIds[SensorId];
+		OutSnapshot.SensorIndices[SensorId] = SensorIndices[SensorId];
+		OutSnapshot.ValidBits[SensorId] = bValid;
+	}
+}
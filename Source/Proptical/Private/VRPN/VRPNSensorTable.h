@@ -0,0 +1,120 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTransformData.h"
+#include "VRPN/VRPNSensorSnapshot.h"
+#include <atomic>
+
+/**
+ * Registry and latest-pose storage for every sensor of one connection
+ *
+ * Each (sender ID, sensor index) pair seen on the wire is mapped to a dense sensor ID in
+ * [0, Num()). Poses live in structure-of-arrays storage indexed by that ID, each guarded by
+ * its own sequence counter: the receive thread writes without ever waiting, readers on any
+ * thread get torn-free copies without a lock.
+ *
+ * All storage is sized once in Initialize(); registering and writing sensors never allocates.
+ * Registration and writes are receive-thread only, everything else is safe from any thread.
+ */
+class FVRPNSensorTable
+{
+public:
+	FVRPNSensorTable();
+
+	/**
+	 * Allocate storage for a fixed number of sensors (call before the receive thread starts)
+	 * @param InCapacity Maximum number of distinct sensors
+	 */
+	void Initialize(int32 InCapacity);
+
+	/** Maximum number of sensors */
+	int32 Capacity() const { return Positions.Num(); }
+
+	/** Number of registered sensors */
+	int32 Num() const { return NumSensors.load(std::memory_order_acquire); }
+
+	/**
+	 * Look up a sensor, registering it on first sight (receive thread only)
+	 * @return Dense sensor ID, or INDEX_NONE if the table is full
+	 */
+	int32 FindOrAdd(int32 SenderId, int32 SensorIndex);
+
+	/**
+	 * Look up a sensor without registering it
+	 * @return Dense sensor ID, or INDEX_NONE if it has not been seen
+	 */
+	int32 Find(int32 SenderId, int32 SensorIndex) const;
+
+	/**
+	 * Publish a sensor's latest pose and derivatives (receive thread only)
+	 */
+	void Write(int32 SensorId, const FVRPNTransformData& Transform);
+
+	/**
+	 * Copy a sensor's latest pose and derivatives
+	 * @return false if the sensor has not reported yet
+	 */
+	bool Read(int32 SensorId, FVRPNTransformData& OutTransform) const;
+
+	/**
+	 * Copy a sensor's latest pose at full timestamp precision
+	 * @return false if the sensor has not reported yet
+	 */
+	bool ReadPose(int32 SensorId, FVector& OutPosition, FQuat& OutRotation, double& OutTimestamp) const;
+
+	/** Server-side sender ID of a registered sensor */
+	int32 GetSenderId(int32 SensorId) const { return SenderIds[SensorId]; }
+
+	/** Server-side sensor index of a registered sensor */
+	int32 GetSensorIndex(int32 SensorId) const { return SensorIndices[SensorId]; }
+
+	/**
+	 * Copy every registered sensor into a snapshot (reuses the snapshot's storage)
+	 */
+	void CopyTo(FVRPNSensorSnapshot& OutSnapshot) const;
+
+private:
+	/** Marks an unused registry slot */
+	static constexpr uint64 EmptyKey = ~0ull;
+
+	/**
+	 * Run Copy until it sees a sensor's storage without a concurrent write
+	 * @return false if the sensor has not reported yet
+	 */
+	template <typename CopyFunc>
+	bool ReadConsistent(int32 SensorId, CopyFunc Copy) const;
+
+	/** Pack a (sender, sensor) pair into a registry key */
+	static uint64 MakeKey(int32 SenderId, int32 SensorIndex)
+	{
+		return (uint64(uint32(SenderId)) << 32) | uint64(uint32(SensorIndex));
+	}
+
+	/** Open-addressing registry keys (insert-only, published with release) */
+	TArray<std::atomic<uint64>> RegistryKeys;
+
+	/** Dense sensor ID per registry slot */
+	TArray<int32> RegistryValues;
+
+	/** Registry size - 1 (power of two, at least twice the capacity) */
+	uint32 RegistryMask;
+
+	/** Number of registered sensors */
+	std::atomic<int32> NumSensors;
+
+	/** Identity per dense sensor ID (written once at registration) */
+	TArray<int32> SenderIds;
+	TArray<int32> SensorIndices;
+
+	/** Per-sensor sequence counter; odd while the receive thread is writing that sensor */
+	TArray<std::atomic<uint32>> Sequences;
+
+	/** Pose storage per dense sensor ID */
+	TArray<FVector> Positions;
+	TArray<FQuat> Rotations;
+	TArray<double> Timestamps;
+	TArray<FVector> Velocities;
+	TArray<FVector> AngularVelocities;
+	TArray<FVector> Accelerations;
+	TArray<FVector> AngularAccelerations;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include <atomic>
+
+/**
+ * Single-writer, multi-reader "latest value" slot (sequence lock)
+ *
+ * The writer never blocks or waits: it bumps the sequence to odd, copies the value and bumps it to even.
+ * Readers never take a lock: they copy the value and retry only if a write overlapped the copy,
+ * so every successful read is a torn-free snapshot.
+ *
+ * T must be trivially copyable (it is copied with memcpy on both sides).
+ */
+template <typename T>
+class TVRPNSeqLock
+{
+public:
+	TVRPNSeqLock()
+		: Sequence(0)
+		, Value()
+	{
+	}
+
+	/**
+	 * Publish a new value (writer thread only)
+	 * @param InValue Value to publish
+	 */
+	void Write(const T& InValue)
+	{
+		const uint32 Begin = Sequence.load(std::memory_order_relaxed);
+		Sequence.store(Begin + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		FMemory::Memcpy(&Value, &InValue, sizeof(T));
+
+		Sequence.store(Begin + 2, std::memory_order_release);
+	}
+
+	/**
+	 * Copy the latest published value (any thread)
+	 * @param OutValue Snapshot of the latest value
+	 * @return false if nothing has been published yet
+	 */
+	bool Read(T& OutValue) const
+	{
+		for (;;)
+		{
+			const uint32 Begin = Sequence.load(std::memory_order_acquire);
+			if (Begin & 1)
+			{
+				// Writer is mid-copy; it only holds the slot for a few nanoseconds
+				FPlatformProcess::Yield();
+				continue;
+			}
+
+			FMemory::Memcpy(&OutValue, &Value, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (Sequence.load(std::memory_order_relaxed) == Begin)
+			{
+				return Begin != 0;
+			}
+		}
+	}
+
+	/** Number of values published so far */
+	uint32 GetWriteCount() const
+	{
+		return Sequence.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+	/** Odd while a write is in progress */
+	std::atomic<uint32> Sequence;
+
+	/** Latest published value */
+	T Value;
+};
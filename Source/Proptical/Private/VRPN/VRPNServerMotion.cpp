@@ -0,0 +1,58 @@
+#include "VRPNServerMotion.h"
+
+void FVRPNServerMotion::Initialize(int32 Capacity)
+{
+	const int32 NewCapacity = FMath::Max(Capacity, 1);
+
+	Velocities.SetNum(NewCapacity);
+	AngularVelocities.SetNum(NewCapacity);
+	Accelerations.SetNum(NewCapacity);
+	AngularAccelerations.SetNum(NewCapacity);
+	VelocityTimes.SetNum(NewCapacity);
+	AccelerationTimes.SetNum(NewCapacity);
+	Reset();
+}
+
+void FVRPNServerMotion::Reset()
+{
+	for (int32 SensorId = 0; SensorId < VelocityTimes.Num(); ++SensorId)
+	{
+		Velocities[SensorId] = FVector::ZeroVector;
+		AngularVelocities[SensorId] = FVector::ZeroVector;
+		Accelerations[SensorId] = FVector::ZeroVector;
+		AngularAccelerations[SensorId] = FVector::ZeroVector;
+		VelocityTimes[SensorId] = TNumericLimits<double>::Lowest();
+		AccelerationTimes[SensorId] = TNumericLimits<double>::Lowest();
+	}
+}
+
+void FVRPNServerMotion::Store(int32 SensorId, const FVRPNTrackerDerivative& Derivative)
+{
+	if (Derivative.bAcceleration)
+	{
+		Accelerations[SensorId] = Derivative.Linear;
+		AngularAccelerations[SensorId] = Derivative.Angular;
+		AccelerationTimes[SensorId] = Derivative.ServerTime;
+	}
+	else
+	{
+		Velocities[SensorId] = Derivative.Linear;
+		AngularVelocities[SensorId] = Derivative.Angular;
+		VelocityTimes[SensorId] = Derivative.ServerTime;
+	}
+}
+
+void FVRPNServerMotion::Apply(int32 SensorId, double ServerTime, FVRPNTransformData& InOutTransform) const
+{
+	// Reports usually share the pose's timestamp; either may arrive first, so the age is taken both ways
+	if (FMath::Abs(ServerTime - VelocityTimes[SensorId]) <= MaxReportAge)
+	{
+		InOutTransform.Velocity = Velocities[SensorId];
+		InOutTransform.AngularVelocity = AngularVelocities[SensorId];
+	}
+	if (FMath::Abs(ServerTime - AccelerationTimes[SensorId]) <= MaxReportAge)
+	{
+		InOutTransform.Acceleration = Accelerations[SensorId];
+		InOutTransform.AngularAcceleration = AngularAccelerations[SensorId];
+	}
+}
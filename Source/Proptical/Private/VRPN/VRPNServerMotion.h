@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPN/VRPNTransformData.h"
+#include "VRPNMessageParser.h"
+
+/**
+ * Velocities and accelerations reported by the server, per sensor
+ *
+ * Trackers that estimate motion on the server send velocity and acceleration messages next to
+ * the pose. Those rates come from the tracker's own model rather than from differencing noisy
+ * positions, so while they are recent they replace the filter's estimates in every pose of
+ * their sensor. When the server stops sending them, poses fall back to the filter's estimates.
+ *
+ * State is indexed by dense sensor ID and touched by the receive thread only.
+ */
+class FVRPNServerMotion
+{
+public:
+	/**
+	 * Allocate state for a fixed number of sensors (call before the receive thread starts)
+	 * @param Capacity Capacity of the connection's sensor table
+	 */
+	void Initialize(int32 Capacity);
+
+	/** Forget every sensor's reports (receive thread, or before it starts) */
+	void Reset();
+
+	/**
+	 * Keep a velocity or acceleration report (converted into Unreal space)
+	 * @param SensorId Dense sensor ID of the report's sensor
+	 */
+	void Store(int32 SensorId, const FVRPNTrackerDerivative& Derivative);
+
+	/**
+	 * Put the sensor's recent server-side rates into a pose
+	 * @param SensorId Dense sensor ID
+	 * @param ServerTime Server timestamp of the pose
+	 * @param InOutTransform Pose whose velocities are replaced and accelerations filled in, where the server reported them
+	 */
+	void Apply(int32 SensorId, double ServerTime, FVRPNTransformData& InOutTransform) const;
+
+private:
+	/** Latest reports per sensor */
+	TArray<FVector> Velocities;
+	TArray<FVector> AngularVelocities;
+	TArray<FVector> Accelerations;
+	TArray<FVector> AngularAccelerations;
+
+	/** Server timestamps of the latest velocity and acceleration report per sensor */
+	TArray<double> VelocityTimes;
+	TArray<double> AccelerationTimes;
+
+	/** A report applies to poses at most this far from it in server time */
+	static constexpr double MaxReportAge = 0.1;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Fixed-capacity single-producer/single-consumer ring buffer
+ *
+ * Storage is allocated once in Initialize(); Push/Pop never allocate.
+ * Besides the plain bounded Push, the producer may PushOverwrite, which discards the oldest
+ * element when the ring is full. To make that safe the consumer claims elements with a
+ * compare-exchange on the tail, so an element the producer reclaimed is never returned.
+ *
+ * T must be trivially copyable.
+ */
+template <typename T>
+class TVRPNSpscQueue
+{
+public:
+	TVRPNSpscQueue()
+		: Mask(0)
+		, Head(0)
+		, Tail(0)
+	{
+	}
+
+	/**
+	 * Allocate storage (must be called before the producer or consumer start)
+	 * @param InCapacity Requested capacity, rounded up to a power of two
+	 */
+	void Initialize(int32 InCapacity)
+	{
+		const uint32 Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacity, 2)));
+		Items.SetNumUninitialized(Capacity);
+		Mask = Capacity - 1;
+		Head.store(0, std::memory_order_relaxed);
+		Tail.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Enqueue an element if there is room (producer only)
+	 * @return false if the queue was full and the element was not added
+	 */
+	bool Push(const T& Item)
+	{
+		const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+		if (CurrentHead - Tail.load(std::memory_order_acquire) > Mask)
+		{
+			return false;
+		}
+
+		Items[CurrentHead & Mask] = Item;
+		Head.store(CurrentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Enqueue an element, discarding the oldest one if the queue is full (producer only)
+	 * @return true if an older element was discarded to make room
+	 */
+	bool PushOverwrite(const T& Item)
+	{
+		const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+		uint32 CurrentTail = Tail.load(std::memory_order_acquire);
+		bool bDiscarded = false;
+
+		while (CurrentHead - CurrentTail > Mask)
+		{
+			// Reclaim the oldest slot; if the consumer popped it first the exchange fails and we re-check
+			if (Tail.compare_exchange_weak(CurrentTail, CurrentTail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				bDiscarded = true;
+				break;
+			}
+		}
+
+		Items[CurrentHead & Mask] = Item;
+		Head.store(CurrentHead + 1, std::memory_order_release);
+		return bDiscarded;
+	}
+
+	/**
+	 * Dequeue the oldest element (consumer only)
+	 * @return false if the queue was empty
+	 */
+	bool Pop(T& OutItem)
+	{
+		uint32 CurrentTail = Tail.load(std::memory_order_acquire);
+		for (;;)
+		{
+			if (CurrentTail == Head.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			OutItem = Items[CurrentTail & Mask];
+
+			// Only keep the copy if the producer did not reclaim this slot while we read it
+			if (Tail.compare_exchange_weak(CurrentTail, CurrentTail + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				return true;
+			}
+		}
+	}
+
+	/** Approximate number of queued elements (exact when called from the consumer with the producer idle) */
+	int32 Num() const
+	{
+		return static_cast<int32>(Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire));
+	}
+
+	/** Capacity chosen in Initialize() */
+	int32 Capacity() const
+	{
+		return Items.Num();
+	}
+
+private:
+	/** Ring storage, sized once */
+	TArray<T> Items;
+
+	/** Capacity - 1 (capacity is a power of two) */
+	uint32 Mask;
+
+	/** Next slot to write; only the producer stores it */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head;
+
+	/** Next slot to read; on its own cache line so producer and consumer do not false-share */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail;
+};
@@ -0,0 +1,65 @@
+#include "VRPNStats.h"
+
+DEFINE_STAT(STAT_VRPN_Receive);
+DEFINE_STAT(STAT_VRPN_Parse);
+DEFINE_STAT(STAT_VRPN_Convert);
+DEFINE_STAT(STAT_VRPN_Filter);
+DEFINE_STAT(STAT_VRPN_Dispatch);
+DEFINE_STAT(STAT_VRPN_Drain);
+DEFINE_STAT(STAT_VRPN_Packets);
+DEFINE_STAT(STAT_VRPN_Bytes);
+DEFINE_STAT(STAT_VRPN_Samples);
+DEFINE_STAT(STAT_VRPN_ParseFailures);
+DEFINE_STAT(STAT_VRPN_Dropped);
+DEFINE_STAT(STAT_VRPN_Stale);
+DEFINE_STAT(STAT_VRPN_QueueDepth);
+DEFINE_STAT(STAT_VRPN_PacketAgeP50);
+DEFINE_STAT(STAT_VRPN_PacketAgeP99);
+
+UE_TRACE_CHANNEL_DEFINE(VRPNChannel);
+
+void FVRPNAgeHistogram::Add(double AgeSeconds)
+{
+	const uint64 Micros = static_cast<uint64>(FMath::Max(AgeSeconds, 0.0) * 1000000.0);
+	const int32 Bucket = Micros == 0 ? 0 : FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Micros)), NumBuckets - 1);
+	++Buckets[Bucket];
+	++Count;
+	MaxAge = FMath::Max(MaxAge, AgeSeconds);
+}
+
+void FVRPNAgeHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	MaxAge = 0.0;
+}
+
+double FVRPNAgeHistogram::GetPercentile(double Fraction) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const double Target = FMath::Clamp(Fraction, 0.0, 1.0) * Count;
+	double Cumulative = 0.0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		if (Buckets[Bucket] == 0)
+		{
+			continue;
+		}
+
+		if (Cumulative + Buckets[Bucket] >= Target)
+		{
+			// Assume samples are spread evenly across the bucket
+			const double Low = Bucket == 0 ? 0.0 : double(1ull << Bucket);
+			const double High = double(1ull << (Bucket + 1));
+			const double Alpha = (Target - Cumulative) / Buckets[Bucket];
+			return FMath::Min(FMath::Lerp(Low, High, Alpha) * 0.000001, MaxAge);
+		}
+		Cumulative += Buckets[Bucket];
+	}
+
+	return MaxAge;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "VRPN/VRPNLog.h"
+#include <atomic>
+
+/**
+ * Instrumentation of the VRPN receive pipeline
+ *
+ * - `stat vrpn` shows cycle counters for receive, parse, conversion, filtering, dispatch and drain, plus per-frame
+ *   packet/byte/sample counts, stale samples, queue depth and packet age.
+ * - Unreal Insights shows the same scopes on the "VRPN" trace channel (-trace=cpu,vrpn),
+ *   without having to enable the stat group.
+ * - FVRPNPipelineCounters are plain relaxed atomics, always on, and feed FVRPNPipelineStats.
+ */
+
+DECLARE_STATS_GROUP(TEXT("VRPN"), STATGROUP_VRPN, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive"), STAT_VRPN_Receive, STATGROUP_VRPN, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse"), STAT_VRPN_Parse, STATGROUP_VRPN, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Frame conversion"), STAT_VRPN_Convert, STATGROUP_VRPN, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Filter"), STAT_VRPN_Filter, STATGROUP_VRPN, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch"), STAT_VRPN_Dispatch, STATGROUP_VRPN, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Drain (game thread)"), STAT_VRPN_Drain, STATGROUP_VRPN, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Packets"), STAT_VRPN_Packets, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes"), STAT_VRPN_Bytes, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Samples drained"), STAT_VRPN_Samples, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Parse failures"), STAT_VRPN_ParseFailures, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dropped samples"), STAT_VRPN_Dropped, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Stale samples (reordered/duplicate)"), STAT_VRPN_Stale, STATGROUP_VRPN, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queue depth"), STAT_VRPN_QueueDepth, STATGROUP_VRPN, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Packet age p50 (ms)"), STAT_VRPN_PacketAgeP50, STATGROUP_VRPN, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Packet age p99 (ms)"), STAT_VRPN_PacketAgeP99, STATGROUP_VRPN, );
+
+UE_TRACE_CHANNEL_EXTERN(VRPNChannel);
+
+/** Cycle counter that also shows up in Insights on the VRPN channel */
+#define VRPN_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, VRPNChannel)
+
+/**
+ * Receive-thread counters that the datagram receiver does not keep
+ * Written with relaxed atomics by the receive thread, read from any thread
+ */
+struct FVRPNPipelineCounters
+{
+	/** VRPN messages found in received datagrams (any type) */
+	std::atomic<uint64> Messages{ 0 };
+
+	/** Tracker samples decoded */
+	std::atomic<uint64> Samples{ 0 };
+
+	/** Datagrams whose message walk stopped on a malformed message */
+	std::atomic<uint64> ParseFailures{ 0 };
+
+	/** Failed receive calls (socket errors other than would-block) */
+	std::atomic<uint64> ReceiveErrors{ 0 };
+
+	/** Reconnect attempts and server switches */
+	std::atomic<uint64> Reconnects{ 0 };
+
+	/** Time from the latest connect, reconnect or switch to its first pose, in microseconds (0 until measured) */
+	std::atomic<uint64> TimeToFirstPoseMicros{ 0 };
+};
+
+/**
+ * Histogram of packet age with power-of-two microsecond buckets
+ * Adding a sample is a log2 and an increment, cheap enough for every drained sample.
+ * Percentiles are interpolated within a bucket, so they are accurate to within a factor of two
+ * at worst and usually much better.
+ */
+struct FVRPNAgeHistogram
+{
+	/** Bucket N holds ages in [2^N, 2^(N+1)) microseconds; the last bucket holds everything above ~8 s */
+	static constexpr int32 NumBuckets = 24;
+
+	uint32 Buckets[NumBuckets] = {};
+	uint32 Count = 0;
+	double MaxAge = 0.0;
+
+	void Add(double AgeSeconds);
+	void Reset();
+
+	/**
+	 * Age below which a fraction of the samples fall
+	 * @param Fraction 0..1 (0.5 = median)
+	 * @return Age in seconds, 0 if the histogram is empty
+	 */
+	double GetPercentile(double Fraction) const;
+};
+
+/**
+ * Lets a failure that repeats in a loop log at a bounded rate
+ */
+struct FVRPNLogLimiter
+{
+	explicit FVRPNLogLimiter(double InInterval = 5.0)
+		: Interval(InInterval)
+	{
+	}
+
+	/**
+	 * Call for every occurrence
+	 * @param Now Current time (FPlatformTime::Seconds)
+	 * @param OutSuppressed Occurrences skipped since the last one that was logged
+	 * @return true if this occurrence should be logged
+	 */
+	bool ShouldLog(double Now, uint32& OutSuppressed)
+	{
+		if (Now < NextLogTime)
+		{
+			++Suppressed;
+			return false;
+		}
+
+		OutSuppressed = Suppressed;
+		Suppressed = 0;
+		NextLogTime = Now + Interval;
+		return true;
+	}
+
+	double Interval;
+	double NextLogTime = 0.0;
+	uint32 Suppressed = 0;
+};
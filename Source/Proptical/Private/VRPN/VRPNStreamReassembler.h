@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPNMessageParser.h"
+#include "VRPNWire.h"
+
+/**
+ * Outcome of looking for the next message in a reassembled stream
+ */
+enum class EVRPNStreamMessage : uint8
+{
+	/** A whole message is buffered */
+	Complete,
+
+	/** More bytes are needed */
+	Incomplete,
+
+	/** The length field is impossible; the stream is out of sync and must be dropped */
+	Corrupt
+};
+
+/**
+ * Reassembles VRPN messages from a TCP byte stream
+ *
+ * The socket reads straight into a buffer allocated once by Initialize(). Complete messages are
+ * handed out as views into that buffer, so nothing is copied or allocated per message; a message
+ * split across reads simply stays buffered until the rest of it arrives. Consumed bytes are
+ * reclaimed by moving the unread tail to the front, which only happens when the free space at the
+ * end runs low.
+ */
+class FVRPNStreamReassembler
+{
+public:
+	/**
+	 * Allocate the buffer
+	 * @param InCapacity Largest message accepted (and bytes read per receive call at most)
+	 */
+	void Initialize(int32 InCapacity)
+	{
+		Buffer.SetNumUninitialized(InCapacity);
+		Reset();
+	}
+
+	/** Drop everything buffered */
+	void Reset()
+	{
+		ReadPos = 0;
+		WritePos = 0;
+	}
+
+	/**
+	 * Space to receive into
+	 * @param OutSize Bytes that may be written at the returned pointer
+	 */
+	uint8* GetWriteSpace(int32& OutSize)
+	{
+		if (ReadPos > 0 && Buffer.Num() - WritePos < Buffer.Num() / 4)
+		{
+			Compact();
+		}
+
+		OutSize = Buffer.Num() - WritePos;
+		return Buffer.GetData() + WritePos;
+	}
+
+	/** Mark bytes written into GetWriteSpace() as received */
+	void CommitWrite(int32 Size)
+	{
+		WritePos += Size;
+	}
+
+	/** Bytes received but not consumed yet */
+	int32 NumBuffered() const { return WritePos - ReadPos; }
+
+	/** Start of the unconsumed bytes */
+	const uint8* Peek() const { return Buffer.GetData() + ReadPos; }
+
+	/**
+	 * Look at the next message without consuming it
+	 * @param OutMessage Start of the message (header included), valid until the next GetWriteSpace()
+	 * @param OutPaddedLength Bytes the message occupies in the stream, alignment padding included
+	 */
+	EVRPNStreamMessage NextMessage(const uint8*& OutMessage, int32& OutPaddedLength) const
+	{
+		const int32 Available = NumBuffered();
+		if (Available < 4)
+		{
+			return EVRPNStreamMessage::Incomplete;
+		}
+
+		const int32 Length = VRPNWire::ReadInt32(Peek());
+		if (Length < FVRPNMessageParser::VRPN_HEADER_SIZE || Length > Buffer.Num() - FVRPNMessageParser::VRPN_ALIGN)
+		{
+			return EVRPNStreamMessage::Corrupt;
+		}
+
+		// Messages are padded to the alignment on the stream as well as in datagrams
+		const int32 PaddedLength = VRPNWire::Align(Length, FVRPNMessageParser::VRPN_ALIGN);
+		if (Available < PaddedLength)
+		{
+			return EVRPNStreamMessage::Incomplete;
+		}
+
+		OutMessage = Peek();
+		OutPaddedLength = PaddedLength;
+		return EVRPNStreamMessage::Complete;
+	}
+
+	/** Discard bytes from the front (a message, or the connection cookie) */
+	void Consume(int32 Size)
+	{
+		ReadPos += Size;
+		if (ReadPos >= WritePos)
+		{
+			Reset();
+		}
+	}
+
+private:
+	void Compact()
+	{
+		const int32 Remaining = NumBuffered();
+		FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + ReadPos, Remaining);
+		ReadPos = 0;
+		WritePos = Remaining;
+	}
+
+	TArray<uint8> Buffer;
+	int32 ReadPos = 0;
+	int32 WritePos = 0;
+};
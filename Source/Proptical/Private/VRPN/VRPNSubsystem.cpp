@@ -0,0 +1,755 @@
+#include "VRPN/VRPNSubsystem.h"
+#include "VRPN/VRPNClient.h"
+#include "VRPNConnectionManager.h"
+#include "VRPNFanIn.h"
+#include "VRPNAddressResolver.h"
+#include "Async/Async.h"
+
+namespace VRPNSubsystem
+{
+	/** True if two settings would create the same connection apart from the server it talks to */
+	bool IsSameSetupExceptServer(const FVRPNConnectionSettings& A, const FVRPNConnectionSettings& B)
+	{
+		return A.UpdateQueueCapacity == B.UpdateQueueCapacity
+			&& A.QueueOverflowPolicy == B.QueueOverflowPolicy
+			&& A.MaxSensors == B.MaxSensors
+			&& A.PoseHistoryMemoryKB == B.PoseHistoryMemoryKB
+			&& A.ReceiveWaitMode == B.ReceiveWaitMode
+			&& A.bBatchedReceive == B.bBatchedReceive
+			&& A.LocalUDPPort == B.LocalUDPPort
+			&& A.TransportMode == B.TransportMode
+			&& A.MulticastGroup == B.MulticastGroup
+			&& A.MulticastInterface == B.MulticastInterface
+			&& A.RelayAddress == B.RelayAddress
+			&& A.RelayPort == B.RelayPort
+			&& A.bAutoReconnect == B.bAutoReconnect
+			&& A.LivenessTimeoutMs == B.LivenessTimeoutMs
+			&& A.ReconnectBackoffMinMs == B.ReconnectBackoffMinMs
+			&& A.ReconnectBackoffMaxMs == B.ReconnectBackoffMaxMs
+			&& A.ReplayFile == B.ReplayFile;
+	}
+
+	/** Configure a connection that has not been initialized yet */
+	void ApplySettings(FVRPNConnectionManager& Manager, const FVRPNConnectionSettings& Settings)
+	{
+		Manager.SetUpdateQueueConfig(Settings.UpdateQueueCapacity, Settings.QueueOverflowPolicy);
+		Manager.SetSensorCapacity(Settings.MaxSensors);
+		Manager.SetPoseHistoryBudget(int64(Settings.PoseHistoryMemoryKB) * 1024);
+		Manager.SetReceiveWaitMode(Settings.ReceiveWaitMode);
+		Manager.SetBatchedReceive(Settings.bBatchedReceive);
+		Manager.SetLocalUDPPort(Settings.LocalUDPPort);
+		Manager.SetTransportMode(Settings.TransportMode);
+		Manager.SetFrameConversion(Settings.FrameConversion);
+		Manager.SetMulticastGroup(Settings.MulticastGroup, Settings.MulticastInterface);
+		Manager.SetRelayTarget(Settings.RelayAddress, Settings.RelayPort, Settings.MulticastInterface);
+
+		FVRPNReconnectSettings ReconnectSettings;
+		ReconnectSettings.bAutoReconnect = Settings.bAutoReconnect;
+		ReconnectSettings.LivenessTimeout = Settings.LivenessTimeoutMs * 0.001;
+		ReconnectSettings.MinBackoff = Settings.ReconnectBackoffMinMs * 0.001;
+		ReconnectSettings.MaxBackoff = Settings.ReconnectBackoffMaxMs * 0.001;
+		Manager.SetReconnectSettings(ReconnectSettings);
+		if (!Settings.ReplayFile.IsEmpty())
+		{
+			Manager.SetReplaySource(Settings.ReplayFile, Settings.ReplayRate, Settings.bLoopReplay);
+		}
+	}
+}
+
+void UVRPNSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Resolver = MakeShared<FVRPNAddressResolver, ESPMode::ThreadSafe>();
+}
+
+void UVRPNSubsystem::Deinitialize()
+{
+	// Connections still opening are stopped by their worker once it finds nobody waiting
+	PendingFanIns.Empty();
+	PendingConnections.Empty();
+	Resolver.Reset();
+
+	FanIns.Empty();
+	for (TPair<FString, TSharedPtr<FVRPNSharedConnection>>& Pair : Connections)
+	{
+		Pair.Value->FanIns.Reset();
+		Pair.Value->Manager->StopReceiving();
+	}
+	Connections.Empty();
+
+	Super::Deinitialize();
+}
+
+void UVRPNSubsystem::Subscribe(const FVRPNConnectionSettings& Settings, UVRPNClient* Client)
+{
+	check(IsInGameThread());
+
+	// The component may go away, disconnect or connect elsewhere before the connection opens
+	TWeakObjectPtr<UVRPNClient> WeakClient = Client;
+	const uint32 ConnectSerial = Client->ConnectSerial;
+	OpenConnection(Settings, [WeakClient, ConnectSerial](const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& Error)
+	{
+		UVRPNClient* Subscriber = WeakClient.Get();
+		if (!Subscriber || Subscriber->ConnectSerial != ConnectSerial)
+		{
+			return;
+		}
+		if (!Connection.IsValid())
+		{
+			Subscriber->HandleConnectFailed(Error);
+			return;
+		}
+
+		Connection->Subscribers.AddUnique(Subscriber);
+		Connection->bSubscribersDirty = true;
+
+		// Names the server already described are known; anything else is picked up when it is described
+		if (!Subscriber->TrackedSenderName.IsNone())
+		{
+			Subscriber->TrackedSenderId = Connection->Manager->FindSenderId(Subscriber->TrackedSenderName);
+		}
+
+		Subscriber->HandleSubscribed(Connection, nullptr);
+		if (Connection->Manager->IsConnected())
+		{
+			Subscriber->HandleConnectionEstablished();
+		}
+	});
+}
+
+FString UVRPNSubsystem::MakeConnectionKey(const FVRPNConnectionSettings& Settings)
+{
+	// A TCP-only connection is a different stream from the UDP one, so it is not shared with it
+	if (!Settings.ReplayFile.IsEmpty())
+	{
+		return FString::Printf(TEXT("replay:%s"), *Settings.ReplayFile);
+	}
+	if (!Settings.MulticastGroup.IsEmpty())
+	{
+		return FString::Printf(TEXT("multicast:%s:%d"), *Settings.MulticastGroup, Settings.LocalUDPPort);
+	}
+	return FString::Printf(TEXT("%s:%d%s"), *Settings.ServerAddress, Settings.ServerPort,
+		Settings.TransportMode == EVRPNTransportMode::TCPOnly ? TEXT("/tcp") : TEXT(""));
+}
+
+void UVRPNSubsystem::OpenConnection(const FVRPNConnectionSettings& Settings, FOnConnectionOpened OnOpened)
+{
+	const FString Key = MakeConnectionKey(Settings);
+	if (TSharedPtr<FVRPNSharedConnection>* Existing = Connections.Find(Key))
+	{
+		OnOpened(*Existing, FString());
+		return;
+	}
+
+	// Everyone asking while the connection opens gets the same one
+	if (FPendingConnection* Pending = PendingConnections.Find(Key))
+	{
+		Pending->Waiting.Add(MoveTemp(OnOpened));
+		return;
+	}
+
+	TSharedPtr<FVRPNSharedConnection> Connection = MakeShared<FVRPNSharedConnection>();
+	Connection->Key = Key;
+	Connection->Settings = Settings;
+	Connection->Manager = MakeShareable(new FVRPNConnectionManager());
+
+	// Connection events fan out to every subscriber and every fan-in merging the connection
+	TWeakPtr<FVRPNSharedConnection> WeakConnection = Connection;
+	Connection->Manager->OnConnectionEstablished.BindLambda([WeakConnection]()
+	{
+		if (TSharedPtr<FVRPNSharedConnection> Pinned = WeakConnection.Pin())
+		{
+			// Copied and re-checked before each call: a handler may disconnect other subscribers or release a fan-in
+			for (UVRPNClient* Subscriber : TArray<UVRPNClient*>(Pinned->Subscribers))
+			{
+				if (Pinned->Subscribers.Contains(Subscriber))
+				{
+					Subscriber->HandleConnectionEstablished();
+				}
+			}
+			for (const TPair<FVRPNFanIn*, int32>& FanIn : TArray<TPair<FVRPNFanIn*, int32>>(Pinned->FanIns))
+			{
+				if (Pinned->FanIns.Contains(FanIn))
+				{
+					FanIn.Key->HandleSourceEstablished(FanIn.Value);
+				}
+			}
+		}
+	});
+	Connection->Manager->OnConnectionLost.BindLambda([WeakConnection](const FString& ErrorMessage)
+	{
+		if (TSharedPtr<FVRPNSharedConnection> Pinned = WeakConnection.Pin())
+		{
+			for (UVRPNClient* Subscriber : TArray<UVRPNClient*>(Pinned->Subscribers))
+			{
+				if (Pinned->Subscribers.Contains(Subscriber))
+				{
+					Subscriber->HandleConnectionLost(ErrorMessage);
+				}
+			}
+			for (const TPair<FVRPNFanIn*, int32>& FanIn : TArray<TPair<FVRPNFanIn*, int32>>(Pinned->FanIns))
+			{
+				if (Pinned->FanIns.Contains(FanIn))
+				{
+					FanIn.Key->HandleSourceLost(FanIn.Value, ErrorMessage);
+				}
+			}
+		}
+	});
+
+	FPendingConnection& Pending = PendingConnections.Add(Key);
+	Pending.Connection = Connection;
+	Pending.Waiting.Add(MoveTemp(OnOpened));
+
+	// Replays and multicast groups do not talk to the server address
+	if (!Settings.ReplayFile.IsEmpty() || !Settings.MulticastGroup.IsEmpty())
+	{
+		StartConnection(Connection, Settings.ServerAddress);
+		return;
+	}
+
+	TWeakObjectPtr<UVRPNSubsystem> WeakThis = this;
+	Resolver->Resolve(Settings.ServerAddress, [WeakThis, Connection](const FString& Address)
+	{
+		UVRPNSubsystem* Subsystem = WeakThis.Get();
+		if (!Subsystem)
+		{
+			return;
+		}
+
+		if (Address.IsEmpty())
+		{
+			Subsystem->FinishOpening(Connection, FString::Printf(TEXT("Could not resolve %s"), *Connection->Settings.ServerAddress));
+			return;
+		}
+		Subsystem->StartConnection(Connection, Address);
+	});
+}
+
+void UVRPNSubsystem::StartConnection(const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& ResolvedAddress)
+{
+	// Binding sockets, opening a capture and starting the threads all stay off the game thread; nothing
+	// else touches the connection until it is published in FinishOpening()
+	TWeakObjectPtr<UVRPNSubsystem> WeakThis = this;
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Connection, ResolvedAddress]()
+	{
+		const FVRPNConnectionSettings& Settings = Connection->Settings;
+		FVRPNConnectionManager& Manager = *Connection->Manager;
+		VRPNSubsystem::ApplySettings(Manager, Settings);
+
+		FString Error;
+		if (!Manager.InitializeConnection(ResolvedAddress, Settings.ServerPort))
+		{
+			Error = FString::Printf(TEXT("Failed to initialize connection to %s"), *Connection->Key);
+			UE_LOG(LogVRPN, Warning, TEXT("Check firewall settings and ensure UDP port %d is open"), Settings.ServerPort);
+		}
+		else if (!Manager.StartReceiving())
+		{
+			Error = FString::Printf(TEXT("Failed to start receiving data from %s"), *Connection->Key);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Connection, Error]()
+		{
+			if (UVRPNSubsystem* Subsystem = WeakThis.Get())
+			{
+				Subsystem->FinishOpening(Connection, Error);
+			}
+			else
+			{
+				Connection->Manager->StopReceiving();
+			}
+		});
+	});
+}
+
+void UVRPNSubsystem::FinishOpening(const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& Error)
+{
+	check(IsInGameThread());
+
+	FPendingConnection* Found = PendingConnections.Find(Connection->Key);
+	if (!Found || Found->Connection != Connection)
+	{
+		// Abandoned while it opened (the subsystem shut down)
+		Connection->Manager->StopReceiving();
+		return;
+	}
+
+	FPendingConnection Pending = MoveTemp(*Found);
+	PendingConnections.Remove(Connection->Key);
+
+	if (Error.IsEmpty())
+	{
+		// An established event latched while opening has nobody to reach yet; subscribers check IsConnected() instead
+		Connection->Manager->DispatchConnectionEvents();
+
+		Connections.Add(Connection->Key, Connection);
+		UE_LOG(LogVRPN, Log, TEXT("Opened shared connection to %s"), *Connection->Key);
+	}
+	else
+	{
+		UE_LOG(LogVRPN, Error, TEXT("%s"), *Error);
+		Connection->Manager->StopReceiving();
+	}
+
+	const TSharedPtr<FVRPNSharedConnection> Opened = Error.IsEmpty() ? Connection : nullptr;
+	for (FOnConnectionOpened& Callback : Pending.Waiting)
+	{
+		Callback(Opened, Error);
+	}
+
+	// Everyone who asked for it may have gone away while it opened
+	if (Opened.IsValid() && Connections.FindRef(Connection->Key) == Connection)
+	{
+		ReleaseConnection(Connection);
+	}
+}
+
+void UVRPNSubsystem::Unsubscribe(const TSharedPtr<FVRPNSharedConnection>& Connection, UVRPNClient* Client)
+{
+	check(IsInGameThread());
+
+	if (!Connection.IsValid())
+	{
+		return;
+	}
+
+	Connection->Subscribers.Remove(Client);
+	Connection->bSubscribersDirty = true;
+
+	// Routing lists may be mid-dispatch (a subscriber disconnecting from an event), so clear entries instead of removing them
+	for (TArray<UVRPNClient*>& SensorSubscribers : Connection->SubscribersBySensorId)
+	{
+		for (UVRPNClient*& Subscriber : SensorSubscribers)
+		{
+			Subscriber = (Subscriber == Client) ? nullptr : Subscriber;
+		}
+	}
+	for (UVRPNClient*& Subscriber : Connection->AllSensorSubscribers)
+	{
+		Subscriber = (Subscriber == Client) ? nullptr : Subscriber;
+	}
+
+	ReleaseConnection(Connection);
+}
+
+bool UVRPNSubsystem::RetargetConnection(const TSharedPtr<FVRPNSharedConnection>& Connection, const FVRPNConnectionSettings& Settings, UVRPNClient* Client)
+{
+	check(IsInGameThread());
+
+	// Anyone else sharing the connection still wants the old server
+	if (!Connection.IsValid() || Connection->FanIns.Num() > 0 || Connection->Subscribers.Num() != 1 || Connection->Subscribers[0] != Client)
+	{
+		return false;
+	}
+
+	// The rest of the setup was fixed when the connection was created
+	const FString Key = MakeConnectionKey(Settings);
+	if (Key == Connection->Key || Connections.Contains(Key) || PendingConnections.Contains(Key)
+		|| !VRPNSubsystem::IsSameSetupExceptServer(Connection->Settings, Settings))
+	{
+		return false;
+	}
+
+	// The receive thread swaps sockets without waiting, so a host that needs a lookup opens the usual way
+	FString Address;
+	if (!Resolver->TryResolveNow(Settings.ServerAddress, Address) || !Connection->Manager->Retarget(Address, Settings.ServerPort))
+	{
+		return false;
+	}
+
+	UE_LOG(LogVRPN, Log, TEXT("Moved shared connection from %s to %s"), *Connection->Key, *Key);
+	Connections.Remove(Connection->Key);
+	Connection->Key = Key;
+	Connection->Settings.ServerAddress = Settings.ServerAddress;
+	Connection->Settings.ServerPort = Settings.ServerPort;
+	Connection->Settings.FrameConversion = Settings.FrameConversion;
+	Connection->Manager->SetFrameConversion(Settings.FrameConversion);
+	Connection->bSubscribersDirty = true;
+	Connections.Add(Key, Connection);
+	return true;
+}
+
+void UVRPNSubsystem::ReleaseConnection(const TSharedPtr<FVRPNSharedConnection>& Connection)
+{
+	if (Connection->Subscribers.Num() == 0 && Connection->FanIns.Num() == 0 && Connection->NumPendingFanIns == 0)
+	{
+		Connection->Manager->StopReceiving();
+		Connections.Remove(Connection->Key);
+		UE_LOG(LogVRPN, Log, TEXT("Closed shared connection to %s"), *Connection->Key);
+	}
+}
+
+void UVRPNSubsystem::SubscribeFanIn(const FVRPNConnectionSettings& Settings, TConstArrayView<FVRPNFanInSource> Sources, double StaleTimeout, UVRPNClient* Client)
+{
+	check(IsInGameThread());
+
+	FString Key = TEXT("fanin");
+	for (const FVRPNFanInSource& Source : Sources)
+	{
+		Key += FString::Printf(TEXT("|%s:%d@%d"), *Source.ServerAddress, Source.ServerPort, Source.Priority);
+	}
+
+	TWeakObjectPtr<UVRPNClient> WeakClient = Client;
+	const uint32 ConnectSerial = Client->ConnectSerial;
+	auto OnFanInOpened = [WeakClient, ConnectSerial](const TSharedPtr<FVRPNFanIn>& FanIn, const FString& Error)
+	{
+		UVRPNClient* Subscriber = WeakClient.Get();
+		if (!Subscriber || Subscriber->ConnectSerial != ConnectSerial)
+		{
+			return;
+		}
+		if (!FanIn.IsValid())
+		{
+			Subscriber->HandleConnectFailed(Error);
+			return;
+		}
+
+		FanIn->Subscribers.AddUnique(Subscriber);
+		FanIn->bSubscribersDirty = true;
+		Subscriber->HandleSubscribed(nullptr, FanIn);
+		if (FanIn->IsConnected())
+		{
+			Subscriber->HandleConnectionEstablished();
+		}
+	};
+
+	if (TSharedPtr<FVRPNFanIn>* Existing = FanIns.Find(Key))
+	{
+		OnFanInOpened(*Existing, FString());
+		return;
+	}
+	if (TSharedPtr<FPendingFanIn>* Existing = PendingFanIns.Find(Key))
+	{
+		(*Existing)->Waiting.Add(MoveTemp(OnFanInOpened));
+		return;
+	}
+	if (Sources.Num() == 0)
+	{
+		OnFanInOpened(nullptr, TEXT("Fan-in has no sources"));
+		return;
+	}
+
+	TSharedPtr<FPendingFanIn> Pending = MakeShared<FPendingFanIn>();
+	Pending->FanIn = MakeShared<FVRPNFanIn>(Key, Settings.MaxSensors, StaleTimeout);
+	Pending->Sources.Append(Sources.GetData(), Sources.Num());
+	Pending->SourceConnections.SetNum(Sources.Num());
+	Pending->NumOutstanding = Sources.Num();
+	Pending->Waiting.Add(MoveTemp(OnFanInOpened));
+	PendingFanIns.Add(Key, Pending);
+
+	// Sources open side by side; the fan-in is assembled once each has opened or failed
+	for (int32 SourceIndex = 0; SourceIndex < Sources.Num(); ++SourceIndex)
+	{
+		const FVRPNFanInSource& Source = Sources[SourceIndex];
+
+		// Sources share the component's settings but each receives from its own server on a port of its own
+		FVRPNConnectionSettings SourceSettings = Settings;
+		SourceSettings.ServerAddress = Source.ServerAddress;
+		SourceSettings.ServerPort = Source.ServerPort;
+		SourceSettings.LocalUDPPort = 0;
+		SourceSettings.ReplayFile.Reset();
+		SourceSettings.MulticastGroup.Reset();
+		SourceSettings.RelayAddress.Reset();
+
+		TWeakPtr<FPendingFanIn> WeakPending = Pending;
+		OpenConnection(SourceSettings, [this, WeakPending, SourceIndex](const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& Error)
+		{
+			TSharedPtr<FPendingFanIn> PinnedPending = WeakPending.Pin();
+			if (!PinnedPending.IsValid())
+			{
+				return;
+			}
+
+			if (Connection.IsValid())
+			{
+				// Kept open for the fan-in until it attaches
+				++Connection->NumPendingFanIns;
+				PinnedPending->SourceConnections[SourceIndex] = Connection;
+			}
+			else
+			{
+				// A backup that is down at start-up must not keep the others from being used
+				const FVRPNFanInSource& Source = PinnedPending->Sources[SourceIndex];
+				UE_LOG(LogVRPN, Warning, TEXT("%s: source %s:%d could not be opened and is left out (%s)"), *PinnedPending->FanIn->Key,
+					*Source.ServerAddress, Source.ServerPort, *Error);
+			}
+
+			if (--PinnedPending->NumOutstanding == 0)
+			{
+				FinishFanIn(PinnedPending);
+			}
+		});
+	}
+}
+
+void UVRPNSubsystem::FinishFanIn(const TSharedPtr<FPendingFanIn>& Pending)
+{
+	TSharedPtr<FVRPNFanIn> FanIn = Pending->FanIn;
+	const FString Key = FanIn->Key;
+	PendingFanIns.Remove(Key);
+
+	// Attached in the order given, however fast each source opened
+	for (int32 SourceIndex = 0; SourceIndex < Pending->Sources.Num(); ++SourceIndex)
+	{
+		const TSharedPtr<FVRPNSharedConnection>& Connection = Pending->SourceConnections[SourceIndex];
+		if (!Connection.IsValid())
+		{
+			continue;
+		}
+
+		--Connection->NumPendingFanIns;
+		const int32 FanInSourceIndex = FanIn->AddSource(Connection, Pending->Sources[SourceIndex]);
+		Connection->FanIns.Emplace(FanIn.Get(), FanInSourceIndex);
+	}
+
+	FString Error;
+	if (FanIn->Sources.Num() == 0)
+	{
+		Error = FString::Printf(TEXT("%s: no source could be opened"), *Key);
+		UE_LOG(LogVRPN, Error, TEXT("%s"), *Error);
+		FanIn.Reset();
+	}
+	else
+	{
+		FanIns.Add(Key, FanIn);
+		UE_LOG(LogVRPN, Log, TEXT("Opened fan-in over %d servers (%s)"), FanIn->Sources.Num(), *Key);
+	}
+
+	for (TFunction<void(const TSharedPtr<FVRPNFanIn>&, const FString&)>& Callback : Pending->Waiting)
+	{
+		Callback(FanIn, Error);
+	}
+
+	// Everyone who asked for it may have gone away while its sources opened
+	if (FanIn.IsValid() && FanIn->Subscribers.Num() == 0 && FanIns.FindRef(Key) == FanIn)
+	{
+		ReleaseFanIn(FanIn);
+	}
+}
+
+void UVRPNSubsystem::UnsubscribeFanIn(const TSharedPtr<FVRPNFanIn>& FanIn, UVRPNClient* Client)
+{
+	check(IsInGameThread());
+
+	if (!FanIn.IsValid())
+	{
+		return;
+	}
+
+	FanIn->Subscribers.Remove(Client);
+	FanIn->bSubscribersDirty = true;
+
+	// Same as connections: the routing lists may be mid-dispatch
+	for (TArray<UVRPNClient*>& BodySubscribers : FanIn->SubscribersByBody)
+	{
+		for (UVRPNClient*& Subscriber : BodySubscribers)
+		{
+			Subscriber = (Subscriber == Client) ? nullptr : Subscriber;
+		}
+	}
+	for (UVRPNClient*& Subscriber : FanIn->AllBodySubscribers)
+	{
+		Subscriber = (Subscriber == Client) ? nullptr : Subscriber;
+	}
+
+	if (FanIn->Subscribers.Num() == 0)
+	{
+		ReleaseFanIn(FanIn);
+	}
+}
+
+void UVRPNSubsystem::ReleaseFanIn(const TSharedPtr<FVRPNFanIn>& FanIn)
+{
+	for (FVRPNFanIn::FSource& Source : FanIn->Sources)
+	{
+		Source.Connection->FanIns.RemoveAll([&FanIn](const TPair<FVRPNFanIn*, int32>& Entry)
+		{
+			return Entry.Key == FanIn.Get();
+		});
+		ReleaseConnection(Source.Connection);
+	}
+	FanIns.Remove(FanIn->Key);
+	UE_LOG(LogVRPN, Log, TEXT("Closed fan-in %s"), *FanIn->Key);
+}
+
+void UVRPNSubsystem::PumpFanIn(TSharedPtr<FVRPNFanIn> FanInPtr)
+{
+	check(IsInGameThread());
+
+	// Held by value: a subscriber may disconnect from inside an event and release the last reference
+	if (!FanInPtr.IsValid())
+	{
+		return;
+	}
+	FVRPNFanIn& FanIn = *FanInPtr;
+
+	if (FanIn.LastPumpFrame == GFrameCounter)
+	{
+		return;
+	}
+	FanIn.LastPumpFrame = GFrameCounter;
+
+	// Sources merge while they drain; one already pumped this frame by its own subscribers has merged already
+	for (int32 SourceIndex = 0; SourceIndex < FanIn.Sources.Num(); ++SourceIndex)
+	{
+		Pump(FanIn.Sources[SourceIndex].Connection);
+	}
+
+	FanIn.FinishFrame();
+}
+
+void UVRPNSubsystem::Pump(TSharedPtr<FVRPNSharedConnection> ConnectionPtr)
+{
+	check(IsInGameThread());
+
+	// Held by value: a subscriber may disconnect from inside an event and release the last reference
+	if (!ConnectionPtr.IsValid())
+	{
+		return;
+	}
+	FVRPNSharedConnection& Connection = *ConnectionPtr;
+
+	// Whichever subscriber ticks first this frame drains for all of them
+	if (Connection.LastPumpFrame == GFrameCounter)
+	{
+		return;
+	}
+	Connection.LastPumpFrame = GFrameCounter;
+
+	// Established and lost events are latched by the receive thread; ConnectionPtr keeps the manager alive while they fire
+	Connection.Manager->DispatchConnectionEvents();
+
+	// Device names are resolved once per new sender description, never per sample
+	const uint32 SenderNamesVersion = Connection.Manager->GetSenderNamesVersion();
+	if (SenderNamesVersion != Connection.SenderNamesVersion)
+	{
+		Connection.SenderNamesVersion = SenderNamesVersion;
+		ResolveSenderNames(Connection);
+	}
+
+	if (Connection.bSubscribersDirty)
+	{
+		RebuildSubscribers(Connection);
+	}
+
+	// Every sample goes to the subscribers of its sensor (jitter buffers); events fire once per sensor
+	// Fan-ins merging this connection see every sample too, before coalescing
+	const TConstArrayView<FVRPNSensorUpdate> Updates = Connection.Manager->DrainTransformUpdates([this, &Connection](const FVRPNSensorUpdate& Sample)
+	{
+		for (const TPair<FVRPNFanIn*, int32>& FanIn : Connection.FanIns)
+		{
+			FanIn.Key->MergeSample(FanIn.Value, Sample);
+		}
+		DispatchSample(Connection, Sample);
+	});
+
+	for (const FVRPNSensorUpdate& Update : Updates)
+	{
+		if (Connection.SubscribersBySensorId.IsValidIndex(Update.SensorId))
+		{
+			for (int32 Index = 0; Index < Connection.SubscribersBySensorId[Update.SensorId].Num(); ++Index)
+			{
+				if (UVRPNClient* Subscriber = Connection.SubscribersBySensorId[Update.SensorId][Index])
+				{
+					Subscriber->HandleTransformUpdated(Update.Transform);
+				}
+			}
+		}
+
+		for (int32 Index = 0; Index < Connection.AllSensorSubscribers.Num(); ++Index)
+		{
+			if (UVRPNClient* Subscriber = Connection.AllSensorSubscribers[Index])
+			{
+				Subscriber->HandleTransformUpdated(Update.Transform);
+			}
+		}
+	}
+}
+
+void UVRPNSubsystem::DispatchSample(FVRPNSharedConnection& Connection, const FVRPNSensorUpdate& Sample)
+{
+	// A sensor seen for the first time needs routing before its samples can be delivered
+	if (!Connection.SubscribersBySensorId.IsValidIndex(Sample.SensorId))
+	{
+		RebuildSubscribers(Connection);
+		if (!Connection.SubscribersBySensorId.IsValidIndex(Sample.SensorId))
+		{
+			return;
+		}
+	}
+
+	for (UVRPNClient* Subscriber : Connection.SubscribersBySensorId[Sample.SensorId])
+	{
+		if (Subscriber)
+		{
+			Subscriber->HandleSample(Sample);
+		}
+	}
+}
+
+void UVRPNSubsystem::ResolveSenderNames(FVRPNSharedConnection& Connection)
+{
+	for (UVRPNClient* Subscriber : Connection.Subscribers)
+	{
+		if (Subscriber->TrackedSenderName.IsNone())
+		{
+			continue;
+		}
+
+		const int32 SenderId = Connection.Manager->FindSenderId(Subscriber->TrackedSenderName);
+		if (SenderId != Subscriber->TrackedSenderId)
+		{
+			Subscriber->TrackedSenderId = SenderId;
+			Subscriber->TrackedSensorId = INDEX_NONE;
+			Connection.bSubscribersDirty = true;
+		}
+	}
+}
+
+void UVRPNSubsystem::RebuildSubscribers(FVRPNSharedConnection& Connection)
+{
+	const FVRPNSensorTable& SensorTable = Connection.Manager->GetSensorTable();
+	const int32 NumSensors = SensorTable.Num();
+
+	Connection.SubscribersBySensorId.SetNum(NumSensors);
+	for (TArray<UVRPNClient*>& SensorSubscribers : Connection.SubscribersBySensorId)
+	{
+		SensorSubscribers.Reset();
+	}
+	Connection.AllSensorSubscribers.Reset();
+
+	for (UVRPNClient* Subscriber : Connection.Subscribers)
+	{
+		if (!Subscriber->TrackedSenderName.IsNone())
+		{
+			// Named devices route by sender ID, and only once the server has described the name
+			const int32 SensorId = Subscriber->TrackedSenderId != INDEX_NONE
+				? SensorTable.Find(Subscriber->TrackedSenderId, Subscriber->GetTrackedSensorIndex())
+				: INDEX_NONE;
+			if (SensorId != INDEX_NONE && SensorId < NumSensors)
+			{
+				Connection.SubscribersBySensorId[SensorId].Add(Subscriber);
+			}
+			continue;
+		}
+
+		if (Subscriber->SensorIndex == INDEX_NONE)
+		{
+			Connection.AllSensorSubscribers.Add(Subscriber);
+			continue;
+		}
+
+		// Same resolution as FVRPNConnectionManager::FindSensorByIndex: first sender reporting that index
+		for (int32 SensorId = 0; SensorId < NumSensors; ++SensorId)
+		{
+			if (SensorTable.GetSensorIndex(SensorId) == Subscriber->SensorIndex)
+			{
+				Connection.SubscribersBySensorId[SensorId].Add(Subscriber);
+				break;
+			}
+		}
+	}
+
+	Connection.bSubscribersDirty = false;
+}
@@ -0,0 +1,207 @@
+#include "VRPNSyntheticServer.h"
+#include "VRPN/VRPNLog.h"
+#include "VRPNMessageParser.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+FVRPNSyntheticServer::FVRPNSyntheticServer(const FVRPNSyntheticServerConfig& InConfig)
+	: Config(InConfig)
+	, Socket(nullptr)
+	, Thread(nullptr)
+	, bShouldStop(false)
+	, Random(InConfig.Seed)
+	, HeldSize(0)
+	, HeldMessages(0)
+	, NumFrames(0)
+	, NumMessagesSent(0)
+	, NumDatagramsSent(0)
+	, NumDatagramsLost(0)
+	, NumDatagramsReordered(0)
+{
+	Config.NumSensors = FMath::Max(Config.NumSensors, 1);
+	Config.MessagesPerDatagram = FMath::Clamp(Config.MessagesPerDatagram, 1, 64);
+	Config.RateHz = FMath::Max(Config.RateHz, 1.0);
+
+	const int32 MessageSize = FVRPNMessageParser::VRPN_HEADER_SIZE + FVRPNMessageParser::VRPN_TRACKER_POS_QUAT_SIZE;
+	PacketBuffer.SetNumZeroed(MessageSize * Config.MessagesPerDatagram);
+	HeldBuffer.SetNumZeroed(PacketBuffer.Num());
+}
+
+FVRPNSyntheticServer::~FVRPNSyntheticServer()
+{
+	Shutdown();
+}
+
+bool FVRPNSyntheticServer::Start()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		return false;
+	}
+
+	TargetAddr = SocketSubsystem->CreateInternetAddr();
+	bool bIsValid = false;
+	TargetAddr->SetIp(*Config.TargetAddress, bIsValid);
+	if (!bIsValid)
+	{
+		UE_LOG(LogVRPN, Error, TEXT("Invalid synthetic server target: %s"), *Config.TargetAddress);
+		return false;
+	}
+	TargetAddr->SetPort(Config.TargetPort);
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("VRPN_SyntheticServer"), TargetAddr->GetProtocolType());
+	if (!Socket)
+	{
+		return false;
+	}
+
+	int32 ActualSize = 0;
+	Socket->SetSendBufferSize(1024 * 1024, ActualSize);
+
+	bShouldStop = false;
+	Thread = FRunnableThread::Create(this, TEXT("VRPNSyntheticServer"), 0, TPri_AboveNormal);
+	if (Thread == nullptr)
+	{
+		Shutdown();
+		return false;
+	}
+
+	UE_LOG(LogVRPN, Log, TEXT("Synthetic server sending %d sensors at %.0f Hz to %s:%d"),
+		Config.NumSensors, Config.RateHz, *Config.TargetAddress, Config.TargetPort);
+	return true;
+}
+
+void FVRPNSyntheticServer::Shutdown()
+{
+	if (Thread != nullptr)
+	{
+		bShouldStop = true;
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+void FVRPNSyntheticServer::Stop()
+{
+	bShouldStop = true;
+}
+
+uint32 FVRPNSyntheticServer::Run()
+{
+	const double Period = 1.0 / Config.RateHz;
+	const double StartTime = FPlatformTime::Seconds();
+	double NextFrameTime = StartTime;
+
+	while (!bShouldStop)
+	{
+		// Frames are scheduled on an absolute timeline so the rate does not drift with send cost
+		const double FrameTime = NextFrameTime;
+		NextFrameTime += Period;
+
+		const double SendTime = FrameTime + (Config.JitterMs > 0.0 ? Random.FRand() * Config.JitterMs * 0.001 : 0.0);
+		double Now = FPlatformTime::Seconds();
+		while (Now < SendTime && !bShouldStop)
+		{
+			const double Remaining = SendTime - Now;
+			FPlatformProcess::SleepNoStats(Remaining > 0.002 ? static_cast<float>(Remaining - 0.001) : 0.0f);
+			Now = FPlatformTime::Seconds();
+		}
+
+		// Every sensor of a frame is stamped with the frame time, as a camera system would
+		const double ServerTime = FrameTime + Config.ClockOffset;
+		const double T = FrameTime - StartTime;
+
+		int32 PacketSize = 0;
+		int32 PacketMessages = 0;
+		for (int32 Sensor = 0; Sensor < Config.NumSensors; ++Sensor)
+		{
+			const double Phase = T * 0.5 * UE_DOUBLE_TWO_PI + Sensor * 0.37;
+			const FVector Position(FMath::Cos(Phase) * 1.0, FMath::Sin(Phase) * 1.0, 1.5 + 0.1 * Sensor);
+			const FQuat Rotation(FVector::UpVector, Phase);
+
+			PacketSize += FVRPNMessageParser::WriteTrackerMessage(PacketBuffer.GetData() + PacketSize, PacketBuffer.Num() - PacketSize,
+				Config.SenderId, Config.TypeId, ServerTime, Sensor, Position, Rotation);
+			++PacketMessages;
+
+			if (PacketMessages == Config.MessagesPerDatagram)
+			{
+				SendDatagram(PacketBuffer.GetData(), PacketSize, PacketMessages);
+				PacketSize = 0;
+				PacketMessages = 0;
+			}
+		}
+
+		if (PacketMessages > 0)
+		{
+			SendDatagram(PacketBuffer.GetData(), PacketSize, PacketMessages);
+		}
+
+		NumFrames.fetch_add(1, std::memory_order_relaxed);
+
+		// If sending fell more than a frame behind, skip ahead rather than bursting to catch up
+		if (FPlatformTime::Seconds() > NextFrameTime + Period)
+		{
+			NextFrameTime = FPlatformTime::Seconds();
+		}
+	}
+
+	if (HeldSize > 0)
+	{
+		SendRaw(HeldBuffer.GetData(), HeldSize);
+		NumMessagesSent.fetch_add(HeldMessages, std::memory_order_relaxed);
+		HeldSize = 0;
+	}
+
+	return 0;
+}
+
+void FVRPNSyntheticServer::SendDatagram(const uint8* Data, int32 Size, int32 NumMessages)
+{
+	if (Config.LossRate > 0.0 && Random.FRand() < Config.LossRate)
+	{
+		NumDatagramsLost.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (HeldSize == 0 && Config.ReorderRate > 0.0 && Random.FRand() < Config.ReorderRate)
+	{
+		// Send this one after the next datagram
+		FMemory::Memcpy(HeldBuffer.GetData(), Data, Size);
+		HeldSize = Size;
+		HeldMessages = NumMessages;
+		NumDatagramsReordered.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	SendRaw(Data, Size);
+	NumMessagesSent.fetch_add(NumMessages, std::memory_order_relaxed);
+
+	if (HeldSize > 0)
+	{
+		SendRaw(HeldBuffer.GetData(), HeldSize);
+		NumMessagesSent.fetch_add(HeldMessages, std::memory_order_relaxed);
+		HeldSize = 0;
+	}
+}
+
+void FVRPNSyntheticServer::SendRaw(const uint8* Data, int32 Size)
+{
+	int32 BytesSent = 0;
+	if (Socket->SendTo(Data, Size, BytesSent, *TargetAddr))
+	{
+		NumDatagramsSent.fetch_add(1, std::memory_order_relaxed);
+	}
+}
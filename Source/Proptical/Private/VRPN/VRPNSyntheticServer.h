@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Math/RandomStream.h"
+#include <atomic>
+
+class FSocket;
+class FInternetAddr;
+class FRunnableThread;
+
+/**
+ * Settings of the synthetic tracker server
+ */
+struct FVRPNSyntheticServerConfig
+{
+	/** Where to send the stream */
+	FString TargetAddress = TEXT("127.0.0.1");
+	int32 TargetPort = 3883;
+
+	/** Sensors reported every frame */
+	int32 NumSensors = 16;
+
+	/** Frames per second (every sensor is reported once per frame) */
+	double RateHz = 240.0;
+
+	/** Tracker messages packed into one datagram */
+	int32 MessagesPerDatagram = 8;
+
+	/** Random delay added to each frame's send time, uniform in [0, JitterMs] */
+	double JitterMs = 0.0;
+
+	/** Probability that a datagram is silently not sent */
+	double LossRate = 0.0;
+
+	/** Probability that a datagram is held back and sent after the next one */
+	double ReorderRate = 0.0;
+
+	/** Added to the local clock to form server timestamps (simulates an unsynchronized server) */
+	double ClockOffset = 0.0;
+
+	/** Sender ID and message type ID written into every message */
+	int32 SenderId = 0;
+	int32 TypeId = 0;
+
+	/** Random seed for jitter, loss and reordering */
+	int32 Seed = 1;
+};
+
+/**
+ * Stand-in for a VRPN tracker server, for tests and benchmarks without tracking hardware
+ *
+ * Sends tracker position messages for NumSensors sensors moving on circles at a fixed rate over
+ * UDP, with optional send jitter, loss and reordering. Server timestamps come from the local
+ * clock plus ClockOffset, so a receiver on the same machine can measure latency exactly.
+ */
+class FVRPNSyntheticServer : public FRunnable
+{
+public:
+	explicit FVRPNSyntheticServer(const FVRPNSyntheticServerConfig& InConfig);
+	virtual ~FVRPNSyntheticServer();
+
+	/** Open the socket and start sending on a background thread */
+	bool Start();
+
+	/** Stop sending and close the socket */
+	void Shutdown();
+
+	/** Frames generated so far */
+	uint64 GetNumFrames() const { return NumFrames.load(std::memory_order_relaxed); }
+
+	/** Tracker messages handed to the socket */
+	uint64 GetNumMessagesSent() const { return NumMessagesSent.load(std::memory_order_relaxed); }
+
+	/** Datagrams handed to the socket */
+	uint64 GetNumDatagramsSent() const { return NumDatagramsSent.load(std::memory_order_relaxed); }
+
+	/** Datagrams deliberately dropped (LossRate) */
+	uint64 GetNumDatagramsLost() const { return NumDatagramsLost.load(std::memory_order_relaxed); }
+
+	/** Datagrams deliberately reordered (ReorderRate) */
+	uint64 GetNumDatagramsReordered() const { return NumDatagramsReordered.load(std::memory_order_relaxed); }
+
+	const FVRPNSyntheticServerConfig& GetConfig() const { return Config; }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Send one packed datagram, applying loss and reordering */
+	void SendDatagram(const uint8* Data, int32 Size, int32 NumMessages);
+
+	/** Send bytes as-is */
+	void SendRaw(const uint8* Data, int32 Size);
+
+	FVRPNSyntheticServerConfig Config;
+	FSocket* Socket;
+	TSharedPtr<FInternetAddr> TargetAddr;
+	FRunnableThread* Thread;
+	std::atomic<bool> bShouldStop;
+	FRandomStream Random;
+
+	/** Datagram being packed, and a datagram held back for reordering */
+	TArray<uint8> PacketBuffer;
+	TArray<uint8> HeldBuffer;
+	int32 HeldSize;
+	int32 HeldMessages;
+
+	std::atomic<uint64> NumFrames;
+	std::atomic<uint64> NumMessagesSent;
+	std::atomic<uint64> NumDatagramsSent;
+	std::atomic<uint64> NumDatagramsLost;
+	std::atomic<uint64> NumDatagramsReordered;
+};
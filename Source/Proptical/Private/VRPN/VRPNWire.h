@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Big-endian field access for VRPN messages (shared by the UDP parser, the TCP control channel and the relay)
+ */
+namespace VRPNWire
+{
+	/** Read a big-endian 16-bit value from an unaligned buffer */
+	FORCEINLINE uint16 ReadUInt16(const uint8* Ptr)
+	{
+		return uint16((uint32(Ptr[0]) << 8) | uint32(Ptr[1]));
+	}
+
+	/** Read a big-endian 32-bit value from an unaligned buffer */
+	FORCEINLINE uint32 ReadUInt32(const uint8* Ptr)
+	{
+		return (uint32(Ptr[0]) << 24) | (uint32(Ptr[1]) << 16) | (uint32(Ptr[2]) << 8) | uint32(Ptr[3]);
+	}
+
+	/** Read a big-endian 32-bit signed value from an unaligned buffer */
+	FORCEINLINE int32 ReadInt32(const uint8* Ptr)
+	{
+		return static_cast<int32>(ReadUInt32(Ptr));
+	}
+
+	/** Read a big-endian IEEE 754 double from an unaligned buffer */
+	FORCEINLINE double ReadDouble(const uint8* Ptr)
+	{
+		const uint64 Bits = (uint64(ReadUInt32(Ptr)) << 32) | uint64(ReadUInt32(Ptr + 4));
+		double Value;
+		FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	/** Write a big-endian 16-bit value to an unaligned buffer */
+	FORCEINLINE void WriteUInt16(uint8* Ptr, uint16 Value)
+	{
+		Ptr[0] = uint8(Value >> 8);
+		Ptr[1] = uint8(Value);
+	}
+
+	/** Write a big-endian 32-bit value to an unaligned buffer */
+	FORCEINLINE void WriteUInt32(uint8* Ptr, uint32 Value)
+	{
+		Ptr[0] = uint8(Value >> 24);
+		Ptr[1] = uint8(Value >> 16);
+		Ptr[2] = uint8(Value >> 8);
+		Ptr[3] = uint8(Value);
+	}
+
+	/** Write a big-endian IEEE 754 double to an unaligned buffer */
+	FORCEINLINE void WriteDouble(uint8* Ptr, double Value)
+	{
+		uint64 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		WriteUInt32(Ptr, uint32(Bits >> 32));
+		WriteUInt32(Ptr + 4, uint32(Bits));
+	}
+
+	/** Round a size up to the VRPN message alignment */
+	FORCEINLINE int32 Align(int32 Size, int32 Alignment)
+	{
+		return (Size + Alignment - 1) & ~(Alignment - 1);
+	}
+}
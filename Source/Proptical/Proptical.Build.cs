@@ -17,7 +17,10 @@ public class Proptical : ModuleRules
 		
 		PrivateDependencyModuleNames.AddRange(new string[]
 		{
-			// Networking modules for socket operations
+			// Skeleton streaming (FVRPNLiveLinkSource)
+			"LiveLinkInterface",
+			// Render-thread late update (FVRPNLateUpdateExtension)
+			"RenderCore"
 		});
 	}
 }
@@ -1,7 +1,10 @@
 #include "Proptical.h"
+#include "VRPN/VRPNLog.h"
 
 #define LOCTEXT_NAMESPACE "FPropticalModule"
 
+DEFINE_LOG_CATEGORY(LogVRPN);
+
 void FPropticalModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
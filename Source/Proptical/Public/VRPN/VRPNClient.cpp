@@ -1,25 +1,62 @@
 #include "VRPNClient.h"
 #include "VRPN/VRPNConnectionManager.h"
 #include "VRPN/VRPNTransformData.h"
+#include "VRPN/VRPNJitterBuffer.h"
+#include "VRPN/VRPNLiveLinkSource.h"
+#include "VRPN/VRPNLateUpdate.h"
+#include "VRPN/VRPNSubsystem.h"
+#include "VRPN/VRPNFanIn.h"
+#include "VRPN/VRPNConnectAction.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "SceneViewExtension.h"
 
 UVRPNClient::UVRPNClient(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, ServerAddress(TEXT("127.0.0.1"))
 	, ServerPort(3883)
 	, RigidBodyName(TEXT(""))
+	, SensorIndex(INDEX_NONE)
 	, bAutoConnect(false)
 	, bSmoothInterpolation(true)
-	, InterpolationSpeed(0.1f)
+	, PlayoutDelayMs(30.0f)
+	, bAdaptivePlayoutDelay(true)
+	, MaxExtrapolationMs(50.0f)
+	, bPredictPose(false)
+	, PredictionLeadMs(20.0f)
+	, MaxPredictionMs(100.0f)
+	, UpdateQueueCapacity(1024)
+	, QueueOverflowPolicy(EVRPNQueueOverflowPolicy::DropOldest)
+	, MaxSensors(512)
+	, PoseHistoryMemoryKB(4096)
+	, ReceiveWaitMode(EVRPNReceiveWaitMode::Blocking)
+	, bBatchedReceive(true)
+	, LocalUDPPort(0)
+	, TransportMode(EVRPNTransportMode::UDP)
+	, ReplayRate(1.0f)
+	, bLoopReplay(false)
+	, bLateUpdate(false)
+	, FanInStaleTimeoutMs(100.0f)
+	, RelayPort(3884)
+	, bAutoReconnect(true)
+	, LivenessTimeoutMs(1000.0f)
+	, ReconnectBackoffMinMs(250.0f)
+	, ReconnectBackoffMaxMs(8000.0f)
+	, TrackedSensorId(INDEX_NONE)
+	, TrackedSenderId(INDEX_NONE)
+	, ConnectSerial(0)
+	, bConnecting(false)
+	, bConnectFailed(false)
 {
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.TickGroup = TG_PrePhysics;
 }
 
-// Destructor must be defined here so TUniquePtr can see full definition of FVRPNConnectionManager
+// Destructor must be defined here so TSharedPtr can see full definition of FVRPNSharedConnection
 UVRPNClient::~UVRPNClient()
 {
 	DisconnectFromServer();
-	// TUniquePtr will automatically clean up ConnectionManager
 }
 
 void UVRPNClient::BeginPlay()
@@ -38,26 +75,181 @@ void UVRPNClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 }
 
+void UVRPNClient::OnUnregister()
+{
+	// Components that never began play (editor worlds, CallInEditor connects) are destroyed without EndPlay;
+	// a plain re-register keeps the connection
+	if (IsBeingDestroyed())
+	{
+		DisconnectFromServer();
+	}
+	Super::OnUnregister();
+}
+
+void UVRPNClient::BeginDestroy()
+{
+	// Last chance before the memory goes away: the subsystem dispatches to raw subscriber pointers
+	DisconnectFromServer();
+	Super::BeginDestroy();
+}
+
 void UVRPNClient::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (ConnectionManager.IsValid() && ConnectionManager->IsConnected())
+	if (!Connection.IsValid() && !FanIn.IsValid())
+	{
+		return;
+	}
+
+	UVRPNSubsystem* Subsystem = GEngine ? GEngine->GetEngineSubsystem<UVRPNSubsystem>() : nullptr;
+	if (FanIn.IsValid())
+	{
+		// Merged bodies are found by device name and sensor index, like sensors on a single server; a body retired
+		// because its sensor was renamed is looked up again
+		if (GetTrackedSensorIndex() != INDEX_NONE && (TrackedSensorId == INDEX_NONE || FanIn->IsBodyRetired(TrackedSensorId)))
+		{
+			TrackedSensorId = FanIn->FindBody(TrackedSenderName, GetTrackedSensorIndex());
+		}
+
+		// The first subscriber to tick this frame drains every source and delivers the merged samples
+		if (Subsystem)
+		{
+			Subsystem->PumpFanIn(FanIn);
+		}
+	}
+	else
 	{
-		FVRPNTransformData LastTransform = ConnectionManager->GetLastTransform();
-		
-		if (bSmoothInterpolation && LastTransform.IsValid())
+		// Resolve the tracked sensor to its dense ID once; afterwards filtering is an integer compare
+		if (GetTrackedSensorIndex() != INDEX_NONE && TrackedSensorId == INDEX_NONE)
+		{
+			if (TrackedSenderName.IsNone())
+			{
+				TrackedSensorId = Connection->GetManager().FindSensorByIndex(SensorIndex);
+			}
+			else if (TrackedSenderId != INDEX_NONE)
+			{
+				TrackedSensorId = Connection->GetManager().FindSensor(TrackedSenderId, GetTrackedSensorIndex());
+			}
+		}
+
+		// The first subscriber to tick this frame drains the shared connection; every sample of a tracked
+		// sensor goes to its subscribers' jitter buffers through HandleSample, events fire once per sensor
+		if (Subsystem)
 		{
-			// Smooth interpolation
-			CurrentTransform.Position = FMath::Lerp(CurrentTransform.Position, LastTransform.Position, InterpolationSpeed);
-			CurrentTransform.Rotation = FQuat::Slerp(CurrentTransform.Rotation, LastTransform.Rotation, InterpolationSpeed);
-			CurrentTransform.Timestamp = LastTransform.Timestamp;
+			Subsystem->Pump(Connection);
+		}
+	}
+
+	// An event handler may have disconnected this component
+	if (!Connection.IsValid() && !FanIn.IsValid())
+	{
+		return;
+	}
+
+	// Whole skeletons go to Live Link as one frame each, straight from the snapshot just refreshed
+	if (LiveLinkSource.IsValid() && Connection.IsValid())
+	{
+		LiveLinkSource->PublishFrame(Connection->GetManager());
+	}
+
+	if (IsConnected())
+	{
+		const FVRPNTransformData LastTransform = GetLastTransform();
+		double DisplayTime = -1.0;
+		bool bPlayedOut = false;
+
+		if (bPredictPose && LastTransform.IsValid())
+		{
+			// Measurement to display spans transit, the rest of this frame and rendering; the newest sample is carried
+			// across all of it with its rates, which the server measures directly when it reports them
+			DisplayTime = FPlatformTime::Seconds() + PredictionLeadMs * 0.001;
+			const double PredictionTime = FMath::Clamp(DisplayTime - LastTransform.Timestamp, 0.0, MaxPredictionMs * 0.001);
+			CurrentTransform = LastTransform.Extrapolate(PredictionTime);
+		}
+		else if (bSmoothInterpolation && JitterBuffer.IsValid() && JitterBuffer->Num() > 0)
+		{
+			bPlayedOut = true;
+
+			// Play out the tracked sensor a fixed delay behind real time on the server's (synchronized) timeline,
+			// interpolating between the samples that bracket that instant; network jitter does not distort the motion
+			const double PlayoutTime = FPlatformTime::Seconds() - GetPlayoutDelay();
+			FVector Position;
+			FQuat Rotation;
+			if (JitterBuffer->Sample(PlayoutTime, MaxExtrapolationMs * 0.001, Position, Rotation) != EVRPNJitterSample::Empty)
+			{
+				CurrentTransform.Position = Position;
+				CurrentTransform.Rotation = Rotation;
+				CurrentTransform.Timestamp = PlayoutTime;
+			}
 		}
 		else if (LastTransform.IsValid())
 		{
 			CurrentTransform = LastTransform;
 		}
+
+		if (LateUpdateExtension.IsValid())
+		{
+			ApplyLateUpdatePose(LastTransform, DisplayTime, bPlayedOut);
+		}
+	}
+}
+
+void UVRPNClient::ApplyLateUpdatePose(const FVRPNTransformData& LastTransform, double DisplayTime, bool bPlayedOut)
+{
+	USceneComponent* Root = GetOwner() ? GetOwner()->GetRootComponent() : nullptr;
+	if (!Root || TrackedSensorId == INDEX_NONE || !CurrentTransform.IsValid())
+	{
+		return;
+	}
+
+	Root->SetRelativeLocationAndRotation(CurrentTransform.Position, CurrentTransform.Rotation);
+	if (bPlayedOut)
+	{
+		// A played-out pose lies a playout delay behind the newest sample; re-sampling on the render thread would
+		// undo the delay and the smoothing, so the frame renders the pose as played out
+		LateUpdateExtension->Suspend();
+		return;
+	}
+
+	if (DisplayTime < 0.0)
+	{
+		LateUpdateExtension->Setup(Root, Connection->GetManagerRef(), TrackedSensorId, CurrentTransform.Timestamp);
+		return;
+	}
+
+	// A predicted pose is stamped with its display time, which no sample reaches; the render thread compares
+	// measurement times instead and predicts a newer sample to the same display time
+	FVRPNLateUpdateExtension::FPrediction Prediction;
+	Prediction.Rates = LastTransform;
+	Prediction.DisplayTime = DisplayTime;
+	Prediction.MaxSeconds = MaxPredictionMs * 0.001;
+	LateUpdateExtension->Setup(Root, Connection->GetManagerRef(), TrackedSensorId, LastTransform.Timestamp, &Prediction);
+}
+
+double UVRPNClient::GetPlayoutDelay() const
+{
+	const double MaxDelay = PlayoutDelayMs * 0.001;
+	if (!bAdaptivePlayoutDelay || !JitterBuffer.IsValid() || JitterBuffer->GetArrivalInterval() <= 0.0)
+	{
+		return MaxDelay;
 	}
+
+	// Samples are timestamped at measurement, so the delay must cover transit; one arrival interval
+	// keeps a bracketing sample available and the jitter margin covers late packets
+	double Latency = 0.0;
+	double Jitter = JitterBuffer->GetArrivalJitter();
+	FVRPNClockEstimate Estimate;
+	int32 PoseSensorId = INDEX_NONE;
+	const FVRPNSharedConnection* PoseConnection = GetPoseConnection(PoseSensorId);
+	if (PoseConnection && PoseConnection->GetManager().GetClockEstimate(Estimate))
+	{
+		Latency = Estimate.Latency;
+		Jitter = Estimate.Jitter;
+	}
+
+	const double Delay = Latency + JitterBuffer->GetArrivalInterval() + 4.0 * Jitter;
+	return FMath::Min(Delay, MaxDelay);
 }
 
 void UVRPNClient::ConnectToServer(const FString& InServerAddress, int32 InServerPort, const FString& InRigidBodyName)
@@ -67,73 +259,402 @@ void UVRPNClient::ConnectToServer(const FString& InServerAddress, int32 InServer
 	ServerPort = InServerPort;
 	RigidBodyName = InRigidBodyName;
 
-	// Disconnect existing connection if any
-	DisconnectFromServer();
+	UVRPNSubsystem* Subsystem = GEngine ? GEngine->GetEngineSubsystem<UVRPNSubsystem>() : nullptr;
+	const FVRPNConnectionSettings Settings = MakeConnectionSettings();
 
-	// Create connection manager
-	ConnectionManager = MakeShareable(new FVRPNConnectionManager());
+	// A connection this component has to itself moves to the new server without a new receive thread or buffers
+	const bool bRetargeted = Subsystem && Connection.IsValid() && FanInSources.Num() == 0 && Subsystem->RetargetConnection(Connection, Settings, this);
+	if (!bRetargeted)
+	{
+		// Disconnect existing connection if any
+		DisconnectFromServer();
+	}
+	TrackedSensorId = INDEX_NONE;
+	TrackedSenderName = RigidBodyName.IsEmpty() ? NAME_None : FName(*RigidBodyName);
+	TrackedSenderId = INDEX_NONE;
+	CurrentTransform = FVRPNTransformData();
+	JitterBuffer = MakeShared<FVRPNJitterBuffer>();
 
-	// Setup callbacks
-	ConnectionManager->OnConnectionEstablished.BindUObject(this, &UVRPNClient::HandleConnectionEstablished);
-	ConnectionManager->OnConnectionLost.BindUObject(this, &UVRPNClient::HandleConnectionLost);
-	ConnectionManager->OnTransformUpdated.BindUObject(this, &UVRPNClient::HandleTransformUpdated);
+	// A result from an earlier attempt still opening in the background must not land on this one
+	++ConnectSerial;
+	bConnecting = true;
+	bConnectFailed = false;
 
-	// Initialize connection
-	if (!ConnectionManager->InitializeConnection(ServerAddress, ServerPort))
+	if (bRetargeted)
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to initialize connection to %s:%d"), *ServerAddress, ServerPort);
-		UE_LOG(LogTemp, Warning, TEXT("VRPN: Check firewall settings and ensure UDP port %d is open"), ServerPort);
+		// Sender IDs are re-resolved once the new server describes its devices
+		UE_LOG(LogVRPN, Log, TEXT("Switching to server %s:%d (Rigid Body: %s)"), *ServerAddress, ServerPort, *RigidBodyName);
 		return;
 	}
 
-	// Start receiving data
-	if (!ConnectionManager->StartReceiving())
+	if (!Subsystem)
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRPN: Failed to start receiving data"));
-		ConnectionManager.Reset();
+		UE_LOG(LogVRPN, Error, TEXT("Subsystem not available"));
+		bConnecting = false;
+		bConnectFailed = true;
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("VRPN: Connecting to server %s:%d (Rigid Body: %s)"), *ServerAddress, ServerPort, *RigidBodyName);
+	UE_LOG(LogVRPN, Log, TEXT("Connecting to server %s:%d (Rigid Body: %s)"), *ServerAddress, ServerPort, *RigidBodyName);
+
+	// Join the shared connection to this server, creating it if this is the first component; completes in HandleSubscribed()
+	if (FanInSources.Num() > 0)
+	{
+		Subsystem->SubscribeFanIn(Settings, FanInSources, FanInStaleTimeoutMs * 0.001, this);
+	}
+	else
+	{
+		Subsystem->Subscribe(Settings, this);
+	}
+}
+
+void UVRPNClient::ConnectToServerAndWait(EVRPNConnectResult& Result, FLatentActionInfo LatentInfo, const FString& InServerAddress, int32 InServerPort, const FString& InRigidBodyName, float TimeoutSeconds)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	// A node that is still waiting keeps its attempt instead of starting another
+	FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
+	if (LatentActionManager.FindExistingAction<FVRPNConnectAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
+	{
+		return;
+	}
+
+	ConnectToServer(InServerAddress, InServerPort, InRigidBodyName);
+	LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new FVRPNConnectAction(this, Result, LatentInfo, TimeoutSeconds));
+}
+
+void UVRPNClient::HandleSubscribed(const TSharedPtr<FVRPNSharedConnection>& InConnection, const TSharedPtr<FVRPNFanIn>& InFanIn)
+{
+	Connection = InConnection;
+	FanIn = InFanIn;
+
+	// Filters are per device and sensor index on the shared connection; a component without one leaves them as they are
+	if (FilterSettings.Type != EVRPNFilterType::None)
+	{
+		SetFilterSettings(FilterSettings);
+	}
+
+	if (FanIn.IsValid())
+	{
+		if (bLateUpdate || LiveLinkSkeletons.Num() > 0)
+		{
+			UE_LOG(LogVRPN, Warning, TEXT("Late update and Live Link skeletons need a single server; ignoring them with FanInSources set"));
+		}
+		UE_LOG(LogVRPN, Log, TEXT("Merging %d servers (Rigid Body: %s)"), FanIn->GetSourceConnections().Num(), *RigidBodyName);
+		return;
+	}
+
+	if (bLateUpdate)
+	{
+		if (GetTrackedSensorIndex() == INDEX_NONE)
+		{
+			UE_LOG(LogVRPN, Warning, TEXT("Late update needs a SensorIndex or RigidBodyName to track; ignoring bLateUpdate"));
+		}
+		else
+		{
+			LateUpdateExtension = FSceneViewExtensions::NewExtension<FVRPNLateUpdateExtension>();
+			if (bSmoothInterpolation && !bPredictPose)
+			{
+				UE_LOG(LogVRPN, Warning, TEXT("Late update is skipped while smooth interpolation plays the pose out; clear bSmoothInterpolation to use it"));
+			}
+		}
+	}
+
+	if (LiveLinkSkeletons.Num() > 0)
+	{
+		LiveLinkSource = FVRPNLiveLinkSource::Create(ServerAddress);
+		if (LiveLinkSource.IsValid())
+		{
+			LiveLinkSource->SetSkeletons(LiveLinkSkeletons);
+		}
+	}
+}
+
+FVRPNConnectionSettings UVRPNClient::MakeConnectionSettings() const
+{
+	FVRPNConnectionSettings Settings;
+	Settings.ServerAddress = ServerAddress;
+	Settings.ServerPort = ServerPort;
+	Settings.UpdateQueueCapacity = UpdateQueueCapacity;
+	Settings.QueueOverflowPolicy = QueueOverflowPolicy;
+	Settings.MaxSensors = MaxSensors;
+	Settings.PoseHistoryMemoryKB = PoseHistoryMemoryKB;
+	Settings.ReceiveWaitMode = ReceiveWaitMode;
+	Settings.bBatchedReceive = bBatchedReceive;
+	Settings.LocalUDPPort = LocalUDPPort;
+	Settings.TransportMode = TransportMode;
+	Settings.MulticastGroup = MulticastGroup;
+	Settings.MulticastInterface = MulticastInterface;
+	Settings.RelayAddress = RelayAddress;
+	Settings.RelayPort = RelayPort;
+	Settings.bAutoReconnect = bAutoReconnect;
+	Settings.LivenessTimeoutMs = LivenessTimeoutMs;
+	Settings.ReconnectBackoffMinMs = ReconnectBackoffMinMs;
+	Settings.ReconnectBackoffMaxMs = ReconnectBackoffMaxMs;
+	Settings.FrameConversion = FrameConversion;
+	Settings.ReplayFile = ReplayFile;
+	Settings.ReplayRate = ReplayRate;
+	Settings.bLoopReplay = bLoopReplay;
+	return Settings;
 }
 
 void UVRPNClient::DisconnectFromServer()
 {
-	if (ConnectionManager.IsValid())
+	// A connect still opening in the background is dropped when it completes
+	++ConnectSerial;
+	bConnecting = false;
+
+	if (LiveLinkSource.IsValid())
+	{
+		LiveLinkSource->Shutdown();
+		LiveLinkSource.Reset();
+	}
+
+	if (Connection.IsValid())
+	{
+		// The subsystem closes the connection once its last subscriber leaves
+		if (UVRPNSubsystem* Subsystem = GEngine ? GEngine->GetEngineSubsystem<UVRPNSubsystem>() : nullptr)
+		{
+			Subsystem->Unsubscribe(Connection, this);
+		}
+		Connection.Reset();
+		UE_LOG(LogVRPN, Log, TEXT("Disconnected from server"));
+	}
+
+	if (FanIn.IsValid())
+	{
+		if (UVRPNSubsystem* Subsystem = GEngine ? GEngine->GetEngineSubsystem<UVRPNSubsystem>() : nullptr)
+		{
+			Subsystem->UnsubscribeFanIn(FanIn, this);
+		}
+		FanIn.Reset();
+		UE_LOG(LogVRPN, Log, TEXT("Disconnected from servers"));
+	}
+
+	if (LateUpdateExtension.IsValid())
 	{
-		ConnectionManager->StopReceiving();
-		ConnectionManager.Reset();
-		UE_LOG(LogTemp, Log, TEXT("VRPN: Disconnected from server"));
+		LateUpdateExtension->Release();
+		LateUpdateExtension.Reset();
 	}
 }
 
 bool UVRPNClient::IsConnected() const
 {
-	return ConnectionManager.IsValid() && ConnectionManager->IsConnected();
+	if (FanIn.IsValid())
+	{
+		return FanIn->IsConnected();
+	}
+	return Connection.IsValid() && Connection->GetManager().IsConnected();
+}
+
+FVRPNSharedConnection* UVRPNClient::GetPoseConnection(int32& OutSensorId) const
+{
+	OutSensorId = TrackedSensorId;
+	if (!FanIn.IsValid())
+	{
+		return Connection.Get();
+	}
+
+	// Before the tracked body has reported, the first source stands in
+	FVRPNSharedConnection* Source = FanIn->GetActiveSource(TrackedSensorId, OutSensorId);
+	return Source ? Source : FanIn->GetSourceConnections()[0];
 }
 
 FVRPNTransformData UVRPNClient::GetLastTransform() const
 {
-	if (ConnectionManager.IsValid())
+	if (FanIn.IsValid())
 	{
-		return ConnectionManager->GetLastTransform();
+		FVRPNTransformData Transform;
+		if (GetTrackedSensorIndex() == INDEX_NONE)
+		{
+			Transform = FanIn->GetLastTransform();
+		}
+		else
+		{
+			FanIn->GetSensorTable().Read(TrackedSensorId, Transform);
+		}
+		return Transform;
 	}
-	return FVRPNTransformData();
+
+	if (!Connection.IsValid())
+	{
+		return FVRPNTransformData();
+	}
+
+	if (GetTrackedSensorIndex() == INDEX_NONE)
+	{
+		return Connection->GetManager().GetLastTransform();
+	}
+
+	FVRPNTransformData Transform;
+	Connection->GetManager().GetSensorTransform(TrackedSensorId, Transform);
+	return Transform;
+}
+
+FVRPNTransformData UVRPNClient::GetCurrentTransform() const
+{
+	return CurrentTransform;
+}
+
+bool UVRPNClient::GetTransformAtTime(double Time, FVRPNTransformData& OutTransform) const
+{
+	int32 PoseSensorId = INDEX_NONE;
+	const FVRPNSharedConnection* PoseConnection = GetPoseConnection(PoseSensorId);
+	return PoseConnection && PoseSensorId != INDEX_NONE && PoseConnection->GetManager().GetTransformAtTime(PoseSensorId, Time, OutTransform);
+}
+
+double UVRPNClient::GetTrackingTime() const
+{
+	return FPlatformTime::Seconds();
+}
+
+bool UVRPNClient::StartRecording(const FString& FilePath)
+{
+	return Connection.IsValid() && Connection->GetManager().StartRecording(FilePath);
+}
+
+void UVRPNClient::StopRecording()
+{
+	if (Connection.IsValid())
+	{
+		Connection->GetManager().StopRecording();
+	}
+}
+
+void UVRPNClient::SeekReplay(float Time)
+{
+	if (Connection.IsValid())
+	{
+		Connection->GetManager().SeekReplay(Time);
+	}
+}
+
+void UVRPNClient::SetFrameConversion(const FVRPNFrameConversion& NewConversion)
+{
+	FrameConversion = NewConversion;
+	if (Connection.IsValid())
+	{
+		Connection->GetManager().SetFrameConversion(FrameConversion);
+	}
+	if (FanIn.IsValid())
+	{
+		for (FVRPNSharedConnection* Source : FanIn->GetSourceConnections())
+		{
+			Source->GetManager().SetFrameConversion(FrameConversion);
+		}
+	}
+}
+
+void UVRPNClient::SetFilterSettings(const FVRPNFilterSettings& NewSettings)
+{
+	FilterSettings = NewSettings;
+	if (Connection.IsValid())
+	{
+		Connection->GetManager().SetFilterSettings(TrackedSenderName, GetTrackedSensorIndex(), FilterSettings);
+	}
+	if (FanIn.IsValid())
+	{
+		for (FVRPNSharedConnection* Source : FanIn->GetSourceConnections())
+		{
+			Source->GetManager().SetFilterSettings(TrackedSenderName, GetTrackedSensorIndex(), FilterSettings);
+		}
+	}
+}
+
+FVRPNConnectionTiming UVRPNClient::GetConnectionTiming() const
+{
+	FVRPNConnectionTiming Timing;
+	FVRPNClockEstimate Estimate;
+	int32 PoseSensorId = INDEX_NONE;
+	const FVRPNSharedConnection* PoseConnection = GetPoseConnection(PoseSensorId);
+	if (PoseConnection && PoseConnection->GetManager().GetClockEstimate(Estimate))
+	{
+		Timing.bValid = true;
+		Timing.LatencyMs = static_cast<float>(Estimate.Latency * 1000.0);
+		Timing.JitterMs = static_cast<float>(Estimate.Jitter * 1000.0);
+		Timing.RoundTripMs = Estimate.RoundTrip >= 0.0 ? static_cast<float>(Estimate.RoundTrip * 1000.0) : -1.0f;
+		Timing.ClockOffset = Estimate.Offset;
+		Timing.ClockDriftPpm = static_cast<float>(Estimate.Drift * 1.0e6);
+	}
+	return Timing;
+}
+
+FVRPNPipelineStats UVRPNClient::GetPipelineStats() const
+{
+	FVRPNPipelineStats Stats;
+	int32 PoseSensorId = INDEX_NONE;
+	if (const FVRPNSharedConnection* PoseConnection = GetPoseConnection(PoseSensorId))
+	{
+		PoseConnection->GetManager().GetPipelineStats(Stats);
+	}
+	return Stats;
+}
+
+FVRPNSensorLinkStats UVRPNClient::GetSensorLinkStats() const
+{
+	FVRPNSensorLinkStats Stats;
+	int32 PoseSensorId = INDEX_NONE;
+	const FVRPNSharedConnection* PoseConnection = GetPoseConnection(PoseSensorId);
+	if (PoseConnection && PoseSensorId != INDEX_NONE)
+	{
+		PoseConnection->GetManager().GetSensorLinkStats(PoseSensorId, Stats);
+	}
+	return Stats;
+}
+
+const FVRPNSensorSnapshot* UVRPNClient::GetSensorSnapshot() const
+{
+	if (FanIn.IsValid())
+	{
+		return &FanIn->GetSensorSnapshot();
+	}
+	return Connection.IsValid() ? &Connection->GetManager().GetSensorSnapshot() : nullptr;
+}
+
+bool UVRPNClient::GetSensorSnapshotAtTime(double Time, FVRPNSensorSnapshot& OutSnapshot) const
+{
+	if (!Connection.IsValid())
+	{
+		return false;
+	}
+
+	Connection->GetManager().GetSensorSnapshotAtTime(Time, OutSnapshot);
+	return true;
 }
 
 void UVRPNClient::HandleConnectionEstablished()
 {
-	UE_LOG(LogTemp, Log, TEXT("VRPN: Connection established"));
+	bConnecting = false;
+	UE_LOG(LogVRPN, Log, TEXT("Connection established"));
 	OnConnectionEstablished.Broadcast();
 }
 
 void UVRPNClient::HandleConnectionLost(const FString& ErrorMessage)
 {
-	UE_LOG(LogTemp, Warning, TEXT("VRPN: Connection lost - %s"), *ErrorMessage);
-	UE_LOG(LogTemp, Warning, TEXT("VRPN: Troubleshooting: Check firewall settings, ensure UDP port %d is open on both client and server"), ServerPort);
+	UE_LOG(LogVRPN, Warning, TEXT("Connection lost - %s"), *ErrorMessage);
+	UE_LOG(LogVRPN, Warning, TEXT("Troubleshooting: Check firewall settings, ensure UDP port %d is open on both client and server"), ServerPort);
 	OnConnectionLost.Broadcast(ErrorMessage);
 }
 
+void UVRPNClient::HandleConnectFailed(const FString& ErrorMessage)
+{
+	bConnecting = false;
+	bConnectFailed = true;
+	HandleConnectionLost(ErrorMessage);
+}
+
+void UVRPNClient::HandleSample(const FVRPNSensorUpdate& Sample)
+{
+	if (JitterBuffer.IsValid())
+	{
+		JitterBuffer->Push(Sample.Transform.Timestamp, Sample.ReceiveTime, Sample.Transform.Position, Sample.Transform.Rotation);
+	}
+}
+
 void UVRPNClient::HandleTransformUpdated(const FVRPNTransformData& Transform)
 {
 	if (Transform.IsValid())
@@ -3,10 +3,19 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "VRPNTransformData.h"
+#include "VRPNTypes.h"
+#include "VRPNSensorSnapshot.h"
+#include "Engine/LatentActionManager.h"
 #include "VRPNClient.generated.h"
 
 // Forward declaration
-class FVRPNConnectionManager;
+class FVRPNSharedConnection;
+class FVRPNFanIn;
+class FVRPNJitterBuffer;
+class FVRPNLiveLinkSource;
+class FVRPNLateUpdateExtension;
+struct FVRPNSensorUpdate;
+struct FVRPNConnectionSettings;
 
 /**
  * VRPN Client
@@ -16,6 +25,9 @@ class FVRPNConnectionManager;
  * - UDP is primary for real-time tracking data
  * - TCP handshake is low priority (may be deferred)
  * - If UDP connection fails, check firewall settings and ensure UDP port is open
+ * - Components tracking the same server share one connection through UVRPNSubsystem
+ * - With FanInSources set, the component merges several servers and fails over between them per body
+ * - Connecting never blocks: hostnames resolve and sockets open in the background, then OnConnectionEstablished fires
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class PROPTICAL_API UVRPNClient : public UActorComponent
@@ -28,6 +40,8 @@ public:
 
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnUnregister() override;
+	virtual void BeginDestroy() override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	/**
@@ -35,6 +49,10 @@ public:
 	 * Server Address: IP or hostname (e.g., 127.0.0.1)
 	 * Server Port: UDP port (default 3883)
 	 * If connection fails, check firewall settings and ensure UDP port is open.
+	 * Called while connected to another server, a connection nobody else shares is switched over in place:
+	 * the receive thread and buffers are kept and only the sockets are replaced.
+	 * Returns right away; the hostname is resolved and the connection opened in the background, and
+	 * OnConnectionEstablished fires once the server streams (OnConnectionLost if it cannot be opened).
 	 * @param InServerAddress IP address or hostname of VRPN server (e.g., "127.0.0.1" or "192.168.1.100")
 	 * @param InServerPort UDP port for VRPN server (default: 3883)
 	 * @param InRigidBodyName Name of the rigid body to track (optional, can be empty to track all)
@@ -42,6 +60,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "VRPN", CallInEditor)
 	void ConnectToServer(const FString& InServerAddress = TEXT("127.0.0.1"), int32 InServerPort = 3883, const FString& InRigidBodyName = TEXT(""));
 
+	/**
+	 * Connect to VRPN server and resume once it streams, fails or the timeout runs out
+	 * Same as ConnectToServer() otherwise; a timed out connect keeps trying in the background.
+	 * @param Result How the connect finished
+	 * @param TimeoutSeconds Seconds to wait, 0 to wait until connected or failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN", meta = (Latent, LatentInfo = "LatentInfo", ExpandEnumAsExecs = "Result", AdvancedDisplay = "TimeoutSeconds"))
+	void ConnectToServerAndWait(EVRPNConnectResult& Result, FLatentActionInfo LatentInfo, const FString& InServerAddress = TEXT("127.0.0.1"), int32 InServerPort = 3883, const FString& InRigidBodyName = TEXT(""), float TimeoutSeconds = 10.0f);
+
 	/**
 	 * Disconnect from VRPN server
 	 */
@@ -54,12 +81,119 @@ public:
 	UFUNCTION(BlueprintPure, Category = "VRPN")
 	bool IsConnected() const;
 
+	/**
+	 * Check if a connect is still under way (resolving, opening, or waiting for the server's first data)
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	bool IsConnecting() const { return bConnecting; }
+
 	/**
 	 * Get last received transform data
+	 * Returns the tracked sensor's pose if SensorIndex is set, otherwise the latest pose of any sensor
 	 */
 	UFUNCTION(BlueprintPure, Category = "VRPN")
 	FVRPNTransformData GetLastTransform() const;
 
+	/**
+	 * Get the smoothed transform of the tracked sensor for this frame
+	 * With pose prediction enabled this is the newest pose projected to display time; otherwise with smooth
+	 * interpolation enabled it is the pose at (now - playout delay), else the latest pose
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	FVRPNTransformData GetCurrentTransform() const;
+
+	/**
+	 * Get the tracked sensor's pose at a past time, interpolated from the connection's pose history
+	 * For lag compensation, aligning with timestamped video, or replaying the last moments. Times after the
+	 * newest sample return the newest sample. Requires SensorIndex or RigidBodyName.
+	 * @param Time Local time in seconds, on the clock of GetTrackingTime() and FVRPNTransformData::Timestamp
+	 * @param OutTransform Pose at that time
+	 * @return false if the sensor has not reported or Time is older than the history reaches (see PoseHistoryMemoryKB)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|History")
+	bool GetTransformAtTime(double Time, FVRPNTransformData& OutTransform) const;
+
+	/**
+	 * Current time on the clock pose timestamps are expressed in
+	 * Subtract from it to query GetTransformAtTime() a fixed delay in the past
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN|History")
+	double GetTrackingTime() const;
+
+	/**
+	 * Get the estimated latency, jitter and clock offset of the current connection
+	 * bValid is false until the first tracker sample arrives
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	FVRPNConnectionTiming GetConnectionTiming() const;
+
+	/**
+	 * Get receive pipeline counters, queue depth and packet age of the current connection
+	 * The connection is shared, so the counters include samples for every subscribed component
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	FVRPNPipelineStats GetPipelineStats() const;
+
+	/**
+	 * Get loss, reorder and duplicate counts of the tracked sensor
+	 * Reordered and duplicate samples are discarded on arrival; bValid is false until the sensor reports
+	 */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	FVRPNSensorLinkStats GetSensorLinkStats() const;
+
+	/**
+	 * Start writing the raw tracking stream of this component's connection to a capture file
+	 * Shared connections record once for all components tracking the same server
+	 * @param FilePath Capture file to create (.vrpncap)
+	 * @return false if not connected, already recording, or the file could not be created
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|Replay")
+	bool StartRecording(const FString& FilePath);
+
+	/**
+	 * Stop recording and finalize the capture file
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|Replay")
+	void StopRecording();
+
+	/**
+	 * Jump to a time in the replayed capture (only when ReplayFile is set)
+	 * @param Time Seconds from the start of the capture
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|Replay")
+	void SeekReplay(float Time);
+
+	/**
+	 * Change the frame conversion (e.g. after calibrating the tracking origin)
+	 * Applies to the whole shared connection from the next received packet
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|Coordinates")
+	void SetFrameConversion(const FVRPNFrameConversion& NewConversion);
+
+	/**
+	 * Change the noise filter of this component's sensor (of every sensor without its own filter when neither SensorIndex nor RigidBodyName is set)
+	 * Filtering runs on the receive thread and applies from the next received packet
+	 */
+	UFUNCTION(BlueprintCallable, Category = "VRPN|Filtering")
+	void SetFilterSettings(const FVRPNFilterSettings& NewSettings);
+
+	/**
+	 * Get the latest pose of every sensor on this connection (C++ only)
+	 * Refreshed once per tick; index with dense sensor IDs and iterate its spans without copying
+	 * @return nullptr if not connected
+	 */
+	const FVRPNSensorSnapshot* GetSensorSnapshot() const;
+
+	/**
+	 * Get the pose of every sensor on this connection at one past time, sampled in a single pass (C++ only)
+	 * Same layout as GetSensorSnapshot(); sensors without history at that time are invalid in the snapshot.
+	 * Not available with FanInSources, whose sources keep separate histories.
+	 * @param Time Local time in seconds (see GetTrackingTime())
+	 * @param OutSnapshot Receives the poses; reuses its storage, so keep one around across frames
+	 * @return false if not connected to a single server
+	 */
+	bool GetSensorSnapshotAtTime(double Time, FVRPNSensorSnapshot& OutSnapshot) const;
+
 	/** Server address (IP or hostname). Example: 127.0.0.1 or 192.168.1.100 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ToolTip = "VRPN server IP address or hostname (e.g., 127.0.0.1 or 192.168.1.100)"))
 	FString ServerAddress;
@@ -68,26 +202,187 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ToolTip = "VRPN server UDP port. Default is 3883. Ensure this port is open in your firewall."))
 	int32 ServerPort;
 
-	/** Name of rigid body to track (empty = track all) */
+	/**
+	 * Name of rigid body to track (empty = track all)
+	 * This is the VRPN device name (e.g. "RigidBody1"). It is resolved to the server's integer sender ID once the
+	 * server describes it over TCP; the component then tracks SensorIndex of that device, or its sensor 0 when SensorIndex is -1.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ToolTip = "Name of the rigid body to track. Leave empty to track all rigid bodies."))
 	FString RigidBodyName;
 
+	/** Sensor index to track within the server's tracker (-1 = all sensors) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "-1", ToolTip = "Sensor index to track. Leave at -1 to receive every sensor."))
+	int32 SensorIndex;
+
 	/** Auto-connect on BeginPlay */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
 	bool bAutoConnect;
 
-	/** Enable smooth interpolation of transforms */
+	/** Enable timestamp-driven interpolation of the tracked sensor (requires SensorIndex) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
 	bool bSmoothInterpolation;
 
-	/** Interpolation speed (0-1, higher = faster) */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", ClampMax = "1.0"))
-	float InterpolationSpeed;
+	/** How far behind real time the smoothed pose is played out (upper bound when adaptive) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", ClampMax = "500.0", Units = "ms", EditCondition = "bSmoothInterpolation"))
+	float PlayoutDelayMs;
+
+	/** Shrink the playout delay to the smallest value the measured network jitter allows */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bSmoothInterpolation"))
+	bool bAdaptivePlayoutDelay;
+
+	/** Longest time to keep projecting the pose forward when samples are late */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", ClampMax = "500.0", Units = "ms", EditCondition = "bSmoothInterpolation"))
+	float MaxExtrapolationMs;
+
+	/**
+	 * Project the tracked sensor's newest pose forward to display time (now + PredictionLeadMs) instead of playing it out
+	 * behind real time. Uses the server's velocity and acceleration reports when it sends them (e.g. trackers with their
+	 * own motion model), otherwise the noise filter's velocity estimate; without either the newest pose is used unchanged.
+	 * Takes precedence over smooth interpolation.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Prediction")
+	bool bPredictPose;
+
+	/** How far past the tick the pose is projected: the time from game-thread tick until the frame is displayed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Prediction", meta = (ClampMin = "0.0", ClampMax = "200.0", Units = "ms", EditCondition = "bPredictPose"))
+	float PredictionLeadMs;
+
+	/** Longest projection past the newest sample; when samples stop arriving the pose holds there instead of drifting away */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Prediction", meta = (ClampMin = "0.0", ClampMax = "500.0", Units = "ms", EditCondition = "bPredictPose"))
+	float MaxPredictionMs;
+
+	/** Maximum pose samples buffered between the receive thread and the next tick (rounded up to a power of two) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced", meta = (ClampMin = "16", ClampMax = "65536"))
+	int32 UpdateQueueCapacity;
+
+	/** What to do with new samples when the game thread falls behind and the queue is full */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced")
+	EVRPNQueueOverflowPolicy QueueOverflowPolicy;
+
+	/** Maximum number of distinct sensors (rigid bodies) tracked by the connection */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced", meta = (ClampMin = "1", ClampMax = "4096"))
+	int32 MaxSensors;
+
+	/**
+	 * Memory for the connection's pose history, shared by all MaxSensors sensors (0 = no history)
+	 * Each sensor keeps the largest power-of-two number of samples that fits; at 64 bytes per sample, 4096 KB over 512
+	 * sensors keeps 128 samples each, about half a second at 240 Hz.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|History", meta = (ClampMin = "0", ClampMax = "1048576", Units = "KB"))
+	int32 PoseHistoryMemoryKB;
+
+	/** How the receive thread waits for packets. Busy Poll shaves scheduler wake-up latency at the cost of a full core. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced")
+	EVRPNReceiveWaitMode ReceiveWaitMode;
+
+	/** Receive many datagrams per system call (recvmmsg). Linux only; other platforms always receive one at a time. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced")
+	bool bBatchedReceive;
+
+	/** Local UDP port to receive tracking data on (0 = pick a free port). Open this port in your firewall if set. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced", meta = (ClampMin = "0", ClampMax = "65535", ToolTip = "Local UDP port for tracking data. 0 picks a free port. If set, ensure this port is open in your firewall."))
+	int32 LocalUDPPort;
+
+	/** Conversion of server poses into Unreal space (axes, handedness, units, calibration), done on the receive thread */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRPN|Coordinates")
+	FVRPNFrameConversion FrameConversion;
+
+	/**
+	 * Noise filter for this component's sensor (of its RigidBodyName device if set), or the default for the connection's sensors when neither is set.
+	 * Runs on the receive thread; filtered poses carry velocity and angular velocity. None leaves the shared filter settings alone.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "VRPN|Filtering")
+	FVRPNFilterSettings FilterSettings;
+
+	/** UDP gives the lowest latency. TCP Only works on networks that block UDP, at the cost of stalls when packets are lost. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Advanced")
+	EVRPNTransportMode TransportMode;
+
+	/** Capture file to replay instead of connecting to the server (empty = live). Useful to reproduce on-set issues offline. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Replay")
+	FString ReplayFile;
+
+	/** Replay speed: 1 = real time, N = N times faster, 0 = as fast as possible */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Replay", meta = (ClampMin = "0.0"))
+	float ReplayRate;
+
+	/** Restart the replay at the end of the capture */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Replay")
+	bool bLoopReplay;
+
+	/**
+	 * Move the owner's root component to the tracked sensor every tick, then re-sample the sensor on the render
+	 * thread just before rendering and shift the root's primitives (and views through the owner) to the newest pose.
+	 * Requires SensorIndex. Mutually exclusive with smooth interpolation: while bSmoothInterpolation plays the pose
+	 * out of the jitter buffer (and bPredictPose is off), the root follows the played-out pose and no late update is
+	 * applied, since the newest raw sample would discard the playout delay.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Late Update")
+	bool bLateUpdate;
+
+	/**
+	 * Skeletons to publish to Live Link, one subject per binding
+	 * Drive a Skeletal Mesh with the Live Link Pose node; all bones are applied in one pass on the animation thread
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Skeleton")
+	TArray<FVRPNSkeletonBinding> LiveLinkSkeletons;
+
+	/**
+	 * Servers to merge into one pose source instead of connecting to ServerAddress (empty = single server)
+	 * Bodies are matched across servers by device name and sensor index. Each body follows the highest priority server
+	 * whose samples are fresh and fails over to the next one when they go stale. Late update and Live Link skeletons
+	 * need a single server; timing and stats report the server the tracked body currently comes from.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Fan-In")
+	TArray<FVRPNFanInSource> FanInSources;
+
+	/** How long a body's active server may go without a sample before a lower priority server takes over */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Fan-In", meta = (ClampMin = "1.0", ClampMax = "5000.0", Units = "ms"))
+	float FanInStaleTimeoutMs;
+
+	/**
+	 * Multicast group to receive from instead of connecting to ServerAddress (empty = connect to the server)
+	 * Listens on LocalUDPPort without a TCP handshake; the group is fed by a server that multicasts or by a relaying node.
+	 * A non-multicast address such as 0.0.0.0 just listens on the port, e.g. for a relay sending to 127.0.0.1.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Cluster")
+	FString MulticastGroup;
+
+	/** Address of the network interface to join the group and send relayed poses on (empty = system default) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Cluster")
+	FString MulticastInterface;
+
+	/**
+	 * Re-publish every received pose to this address (usually a multicast group) for other render nodes (empty = no relay)
+	 * Poses are sent in Unreal space, quantized to 10 micrometres and about 0.01 degrees
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Cluster")
+	FString RelayAddress;
+
+	/** UDP port relayed poses are sent to; peers use it as their LocalUDPPort */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Cluster", meta = (ClampMin = "1", ClampMax = "65535"))
+	int32 RelayPort;
+
+	/** Reconnect by itself when the server stops sending or the socket fails, retrying with exponential backoff */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Reconnect")
+	bool bAutoReconnect;
+
+	/** How long a connected server may send nothing before the link counts as lost (0 = only socket errors count) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Reconnect", meta = (ClampMin = "0.0", ClampMax = "60000.0", Units = "ms"))
+	float LivenessTimeoutMs;
+
+	/** Delay before the second reconnect attempt; every further attempt doubles it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Reconnect", meta = (ClampMin = "10.0", ClampMax = "60000.0", Units = "ms", EditCondition = "bAutoReconnect"))
+	float ReconnectBackoffMinMs;
+
+	/** Longest delay between reconnect attempts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN|Reconnect", meta = (ClampMin = "10.0", ClampMax = "600000.0", Units = "ms", EditCondition = "bAutoReconnect"))
+	float ReconnectBackoffMaxMs;
 
 	/** Delegate type for transform updates */
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTransformUpdatedDelegate, const FVRPNTransformData&, Transform);
 
-	/** Event fired when transform is updated */
+	/** Event fired when transform is updated (at most once per sensor per tick) */
 	UPROPERTY(BlueprintAssignable, Category = "VRPN")
 	FOnTransformUpdatedDelegate OnTransformUpdated;
 
@@ -106,12 +401,81 @@ public:
 	FOnConnectionLostDelegate OnConnectionLost;
 
 private:
-	/** Connection manager instance (forward declared, full definition in .cpp) */
-	TSharedPtr<FVRPNConnectionManager> ConnectionManager;
+	friend class UVRPNSubsystem;
+	friend class FVRPNFanIn;
+	friend class FVRPNConnectAction;
+
+	/** Shared server connection from UVRPNSubsystem (forward declared, full definition in .cpp) */
+	TSharedPtr<FVRPNSharedConnection> Connection;
+
+	/** Shared fan-in from UVRPNSubsystem when FanInSources is set (Connection is then unset) */
+	TSharedPtr<FVRPNFanIn> FanIn;
+
+	/**
+	 * Connection the tracked pose comes from: Connection, or the fan-in source currently active for the tracked body
+	 * @param OutSensorId Receives the tracked sensor's dense ID on that connection (INDEX_NONE if unknown)
+	 */
+	FVRPNSharedConnection* GetPoseConnection(int32& OutSensorId) const;
 
 	/** Current interpolated transform */
 	FVRPNTransformData CurrentTransform;
 
+	/** Recent samples of the tracked sensor (forward declared, full definition in .cpp) */
+	TSharedPtr<FVRPNJitterBuffer> JitterBuffer;
+
+	/** Live Link source for LiveLinkSkeletons (forward declared, full definition in .cpp) */
+	TSharedPtr<FVRPNLiveLinkSource> LiveLinkSource;
+
+	/** Render-thread late update of the owner's root component while bLateUpdate is set */
+	TSharedPtr<FVRPNLateUpdateExtension, ESPMode::ThreadSafe> LateUpdateExtension;
+
+	/**
+	 * Move the owner's root to this frame's pose and hand the frame to the late update
+	 * @param LastTransform Newest sample of the tracked sensor
+	 * @param DisplayTime Time CurrentTransform was predicted to, negative if it was not predicted
+	 * @param bPlayedOut CurrentTransform was played out of the jitter buffer; the late update is skipped for it
+	 */
+	void ApplyLateUpdatePose(const FVRPNTransformData& LastTransform, double DisplayTime, bool bPlayedOut);
+
+	/** Playout delay for this frame in seconds */
+	double GetPlayoutDelay() const;
+
+	/** Connection settings from this component's properties */
+	FVRPNConnectionSettings MakeConnectionSettings() const;
+
+	/** Dense sensor ID of SensorIndex on the current connection, or body ID on the fan-in (INDEX_NONE until it reports) */
+	int32 TrackedSensorId;
+
+	/** RigidBodyName interned when connecting (None = sensors of any device) */
+	FName TrackedSenderName;
+
+	/** Server-side sender ID of TrackedSenderName, kept up to date by the subsystem (INDEX_NONE until described) */
+	int32 TrackedSenderId;
+
+	/** Bumped by every connect and disconnect; results of an older attempt that arrive late are ignored */
+	uint32 ConnectSerial;
+
+	/** Connect started and the server has not streamed yet */
+	bool bConnecting;
+
+	/** The current connect could not resolve the host or open the connection */
+	bool bConnectFailed;
+
+	/** Sensor index this component tracks: SensorIndex, or sensor 0 of a named device when SensorIndex is -1 */
+	int32 GetTrackedSensorIndex() const
+	{
+		return (SensorIndex == INDEX_NONE && !TrackedSenderName.IsNone()) ? 0 : SensorIndex;
+	}
+
+	/**
+	 * Take over the connection or fan-in the subsystem opened for this component
+	 * Sets up filters, the late update and Live Link, which need the connection.
+	 */
+	void HandleSubscribed(const TSharedPtr<FVRPNSharedConnection>& InConnection, const TSharedPtr<FVRPNFanIn>& InFanIn);
+
+	/** Handle a connect that could not resolve the host or open the connection */
+	void HandleConnectFailed(const FString& ErrorMessage);
+
 	/** Handle connection established callback */
 	void HandleConnectionEstablished();
 
@@ -120,5 +484,8 @@ private:
 
 	/** Handle transform updated callback */
 	void HandleTransformUpdated(const FVRPNTransformData& Transform);
+
+	/** Handle one queued sample of the tracked sensor (called for every sample, before coalescing) */
+	void HandleSample(const FVRPNSensorUpdate& Sample);
 };
 
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Log category for the VRPN client, connection and receive pipeline */
+PROPTICAL_API DECLARE_LOG_CATEGORY_EXTERN(LogVRPN, Log, All);
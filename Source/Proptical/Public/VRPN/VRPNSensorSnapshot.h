@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPNTransformData.h"
+
+/**
+ * Game-thread copy of every tracked sensor of a connection, in structure-of-arrays layout
+ *
+ * Refreshed once per frame when the connection's updates are drained. Indices are the dense
+ * sensor IDs assigned by the connection's sensor table, so iterating a span touches only
+ * contiguous memory and never compares names.
+ */
+struct FVRPNSensorSnapshot
+{
+	/** Position per sensor */
+	TArray<FVector> Positions;
+
+	/** Rotation per sensor */
+	TArray<FQuat> Rotations;
+
+	/** Measurement time per sensor on the local clock (FPlatformTime::Seconds) */
+	TArray<double> Timestamps;
+
+	/** Linear velocity per sensor (zero unless filtered) */
+	TArray<FVector> Velocities;
+
+	/** Angular velocity per sensor in radians per second (zero unless filtered) */
+	TArray<FVector> AngularVelocities;
+
+	/** Linear acceleration per sensor (zero unless the server sends acceleration reports) */
+	TArray<FVector> Accelerations;
+
+	/** Angular acceleration per sensor in radians per second squared (zero unless the server sends acceleration reports) */
+	TArray<FVector> AngularAccelerations;
+
+	/** Set for sensors that have reported at least once */
+	TBitArray<> ValidBits;
+
+	/** Server-side sender ID per sensor */
+	TArray<int32> SenderIds;
+
+	/** Server-side sensor index per sensor */
+	TArray<int32> SensorIndices;
+
+	/** Number of sensors in the snapshot */
+	int32 Num() const
+	{
+		return Positions.Num();
+	}
+
+	/** Check if a sensor has reported at least once */
+	bool IsValidSensor(int32 SensorId) const
+	{
+		return SensorId >= 0 && SensorId < Num() && ValidBits[SensorId];
+	}
+
+	/**
+	 * Get one sensor's pose
+	 * @param SensorId Dense sensor ID
+	 * @param OutTransform Pose of that sensor
+	 * @return false if the sensor is unknown or has not reported yet
+	 */
+	bool GetTransform(int32 SensorId, FVRPNTransformData& OutTransform) const
+	{
+		if (!IsValidSensor(SensorId))
+		{
+			return false;
+		}
+		OutTransform = FVRPNTransformData(Positions[SensorId], Rotations[SensorId], Timestamps[SensorId], Velocities[SensorId], AngularVelocities[SensorId],
+			Accelerations[SensorId], AngularAccelerations[SensorId]);
+		return true;
+	}
+
+	/** All positions, indexed by dense sensor ID */
+	TConstArrayView<FVector> GetPositions() const { return Positions; }
+
+	/** All rotations, indexed by dense sensor ID */
+	TConstArrayView<FQuat> GetRotations() const { return Rotations; }
+
+	/** All timestamps, indexed by dense sensor ID */
+	TConstArrayView<double> GetTimestamps() const { return Timestamps; }
+
+	/** All linear velocities, indexed by dense sensor ID */
+	TConstArrayView<FVector> GetVelocities() const { return Velocities; }
+
+	/** All angular velocities, indexed by dense sensor ID */
+	TConstArrayView<FVector> GetAngularVelocities() const { return AngularVelocities; }
+
+	/** All linear accelerations, indexed by dense sensor ID */
+	TConstArrayView<FVector> GetAccelerations() const { return Accelerations; }
+
+	/** All angular accelerations, indexed by dense sensor ID */
+	TConstArrayView<FVector> GetAngularAccelerations() const { return AngularAccelerations; }
+};
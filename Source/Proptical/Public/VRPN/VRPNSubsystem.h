@@ -0,0 +1,271 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "VRPNTypes.h"
+#include "VRPNSubsystem.generated.h"
+
+// Forward declaration
+class FVRPNConnectionManager;
+class FVRPNFanIn;
+class FVRPNAddressResolver;
+class UVRPNClient;
+struct FVRPNSensorUpdate;
+
+/**
+ * Settings a shared connection is created with
+ * The first subscriber's settings apply; later subscribers to the same server share them
+ */
+struct PROPTICAL_API FVRPNConnectionSettings
+{
+	/** IP address or hostname; hostnames are resolved off the game thread */
+	FString ServerAddress = TEXT("127.0.0.1");
+	int32 ServerPort = 3883;
+	int32 UpdateQueueCapacity = 1024;
+	EVRPNQueueOverflowPolicy QueueOverflowPolicy = EVRPNQueueOverflowPolicy::DropOldest;
+	int32 MaxSensors = 512;
+	int32 PoseHistoryMemoryKB = 4096;
+	EVRPNReceiveWaitMode ReceiveWaitMode = EVRPNReceiveWaitMode::Blocking;
+	bool bBatchedReceive = true;
+	int32 LocalUDPPort = 0;
+	EVRPNTransportMode TransportMode = EVRPNTransportMode::UDP;
+	FVRPNFrameConversion FrameConversion;
+
+	/** Multicast group to listen to instead of the server (empty = server) and the interface to join on */
+	FString MulticastGroup;
+	FString MulticastInterface;
+
+	/** Where received poses are relayed to for cluster peers (empty = no relay); sent from MulticastInterface */
+	FString RelayAddress;
+	int32 RelayPort = 3884;
+
+	/** Reconnect on receive errors and silence, with the silence that counts as lost and the backoff between attempts */
+	bool bAutoReconnect = true;
+	float LivenessTimeoutMs = 1000.0f;
+	float ReconnectBackoffMinMs = 250.0f;
+	float ReconnectBackoffMaxMs = 8000.0f;
+
+	/** Capture file to replay instead of connecting (empty = live server) */
+	FString ReplayFile;
+	float ReplayRate = 1.0f;
+	bool bLoopReplay = false;
+};
+
+/**
+ * One server connection shared by every component subscribed to it (game thread only)
+ * Owns the only socket and receive thread for that server
+ */
+class PROPTICAL_API FVRPNSharedConnection
+{
+public:
+	/** Connection manager doing the actual receiving */
+	FVRPNConnectionManager& GetManager() const { return *Manager; }
+
+	/** Shared reference to the manager, for threads that may outlive the subscription (e.g. the render thread) */
+	const TSharedPtr<FVRPNConnectionManager>& GetManagerRef() const { return Manager; }
+
+	/** "address:port" (or "multicast:group:port", "replay:file") this connection is keyed by; other settings come from the first subscriber */
+	const FString& GetKey() const { return Key; }
+
+	/** Number of subscribed components */
+	int32 GetNumSubscribers() const { return Subscribers.Num(); }
+
+	/** Number of fan-ins merging this connection */
+	int32 GetNumFanIns() const { return FanIns.Num(); }
+
+private:
+	friend class UVRPNSubsystem;
+
+	TSharedPtr<FVRPNConnectionManager> Manager;
+	FString Key;
+
+	/** Settings the connection was created with (server and frame conversion follow retargets) */
+	FVRPNConnectionSettings Settings;
+
+	/** Every subscribed component; each unsubscribes on EndPlay, destroy or BeginDestroy, so none is ever dangling */
+	TArray<UVRPNClient*> Subscribers;
+
+	/** Fan-ins merging this connection, with the connection's source index in each */
+	TArray<TPair<FVRPNFanIn*, int32>> FanIns;
+
+	/** Subscribers per dense sensor ID, rebuilt when sensors appear or subscriptions change */
+	TArray<TArray<UVRPNClient*>> SubscribersBySensorId;
+
+	/** Subscribers that receive every sensor (SensorIndex = -1) */
+	TArray<UVRPNClient*> AllSensorSubscribers;
+
+	/** SubscribersBySensorId must be rebuilt before the next dispatch */
+	bool bSubscribersDirty = true;
+
+	/** Fan-ins still waiting for their other sources to open; the connection stays open for them */
+	int32 NumPendingFanIns = 0;
+
+	/** Version of the manager's sender names the subscribers' device names were last resolved against */
+	uint32 SenderNamesVersion = 0;
+
+	/** Frame the queue was last drained on */
+	uint64 LastPumpFrame = MAX_uint64;
+};
+
+/**
+ * VRPN Subsystem
+ * Owns server connections keyed by address and port and reference-counts them by subscriber.
+ * Any number of UVRPNClient components tracking the same server share one socket, one receive
+ * thread and one parse per packet; the first subscriber to tick each frame drains the queue and
+ * the samples are demultiplexed by sensor to the components that track them.
+ *
+ * Fan-ins merge several of these connections into one pose source. They are shared the same way
+ * (by their list of sources) and hook into the drain of each source connection, so merging adds
+ * no receive, parse or storage work per server.
+ *
+ * Opening never blocks the game thread: hostnames are resolved on a worker (answers are cached for
+ * a minute) and the connection is configured, bound and started on another. Components subscribing
+ * in the meantime wait for the same connection and are attached once it is receiving.
+ */
+UCLASS()
+class PROPTICAL_API UVRPNSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Subscribe a component to a server, creating and starting the connection if needed
+	 * Completes on a later frame when the connection has to be opened: the component gets HandleSubscribed(),
+	 * or HandleConnectFailed() if the host could not be resolved or the connection not started. A component that
+	 * disconnects or connects elsewhere in the meantime is left out.
+	 * @param Settings Server and connection settings (only used when the connection is created)
+	 * @param Client Component to receive connection events and pose updates
+	 */
+	void Subscribe(const FVRPNConnectionSettings& Settings, UVRPNClient* Client);
+
+	/**
+	 * Remove a component from a connection; the connection is closed once nobody subscribes to it
+	 */
+	void Unsubscribe(const TSharedPtr<FVRPNSharedConnection>& Connection, UVRPNClient* Client);
+
+	/**
+	 * Move a component's connection to another server without closing it
+	 * The receive thread, buffers and sensor IDs are kept and only the sockets are swapped. Applies when the
+	 * component is the connection's only user, nothing is open to the new server yet, the new server's address
+	 * is known without a lookup (literal or cached), and every setting but the server and frame conversion is
+	 * unchanged; otherwise unsubscribe and subscribe instead.
+	 * @param Settings Settings with the new server
+	 * @return false if the connection cannot be moved (nothing was changed)
+	 */
+	bool RetargetConnection(const TSharedPtr<FVRPNSharedConnection>& Connection, const FVRPNConnectionSettings& Settings, UVRPNClient* Client);
+
+	/**
+	 * Drain the connection's updates and hand them to every subscriber
+	 * Does nothing if the connection was already drained this frame
+	 */
+	void Pump(TSharedPtr<FVRPNSharedConnection> ConnectionPtr);
+
+	/**
+	 * Subscribe a component to a fan-in over several servers, opening the fan-in and its source connections if needed
+	 * Completes like Subscribe(), once every source has opened or failed; it fails only if no source opened.
+	 * @param Settings Connection settings for the sources (address and port come from each source)
+	 * @param Sources Servers to merge, with their priorities
+	 * @param StaleTimeout Seconds without samples after which a body fails over to the next source
+	 * @param Client Component to receive connection events and merged pose updates
+	 */
+	void SubscribeFanIn(const FVRPNConnectionSettings& Settings, TConstArrayView<FVRPNFanInSource> Sources, double StaleTimeout, UVRPNClient* Client);
+
+	/**
+	 * Remove a component from a fan-in; the fan-in (and any source nobody else uses) is closed once nobody subscribes to it
+	 */
+	void UnsubscribeFanIn(const TSharedPtr<FVRPNFanIn>& FanIn, UVRPNClient* Client);
+
+	/**
+	 * Drain every source of a fan-in and hand the merged updates to its subscribers
+	 * Does nothing if the fan-in was already pumped this frame
+	 */
+	void PumpFanIn(TSharedPtr<FVRPNFanIn> FanInPtr);
+
+	/**
+	 * Rebuild the sensor routing of a connection (call after a subscriber changes its SensorIndex)
+	 */
+	void InvalidateSubscribers(FVRPNSharedConnection& Connection) { Connection.bSubscribersDirty = true; }
+
+	/** Number of open server connections */
+	UFUNCTION(BlueprintPure, Category = "VRPN")
+	int32 GetNumConnections() const { return Connections.Num(); }
+
+private:
+	/**
+	 * Called on the game thread when a connection has opened (or failed to)
+	 * @param Connection Receiving connection, nullptr on failure
+	 * @param Error Why it failed
+	 */
+	using FOnConnectionOpened = TFunction<void(const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& Error)>;
+
+	/** Connection being resolved and started, with everyone waiting for it */
+	struct FPendingConnection
+	{
+		TSharedPtr<FVRPNSharedConnection> Connection;
+		TArray<FOnConnectionOpened> Waiting;
+	};
+
+	/** Fan-in waiting for its sources to open */
+	struct FPendingFanIn
+	{
+		TSharedPtr<FVRPNFanIn> FanIn;
+		TArray<FVRPNFanInSource> Sources;
+
+		/** Opened connection per source, nullptr for a source that failed or has not answered */
+		TArray<TSharedPtr<FVRPNSharedConnection>> SourceConnections;
+		int32 NumOutstanding = 0;
+
+		TArray<TFunction<void(const TSharedPtr<FVRPNFanIn>& FanIn, const FString& Error)>> Waiting;
+	};
+
+	/** Open connections by "address:port" or "replay:file" */
+	TMap<FString, TSharedPtr<FVRPNSharedConnection>> Connections;
+
+	/** Connections still being resolved or started, by the same keys */
+	TMap<FString, FPendingConnection> PendingConnections;
+
+	/** Open fan-ins by their list of sources */
+	TMap<FString, TSharedPtr<FVRPNFanIn>> FanIns;
+
+	/** Fan-ins whose sources are still opening */
+	TMap<FString, TSharedPtr<FPendingFanIn>> PendingFanIns;
+
+	/** Hostname lookups and their cache */
+	TSharedPtr<FVRPNAddressResolver, ESPMode::ThreadSafe> Resolver;
+
+	/** "address:port[/tcp]", "multicast:group:port" or "replay:file" */
+	static FString MakeConnectionKey(const FVRPNConnectionSettings& Settings);
+
+	/**
+	 * Find the connection for a server, opening and starting it if nobody uses it yet
+	 * OnOpened runs before this returns when the connection is already open, otherwise on a later frame
+	 */
+	void OpenConnection(const FVRPNConnectionSettings& Settings, FOnConnectionOpened OnOpened);
+
+	/** Configure, bind and start a pending connection on a worker thread */
+	void StartConnection(const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& ResolvedAddress);
+
+	/** Publish a pending connection and hand it to everyone waiting (game thread) */
+	void FinishOpening(const TSharedPtr<FVRPNSharedConnection>& Connection, const FString& Error);
+
+	/** Attach the opened sources of a pending fan-in and hand it to everyone waiting (game thread) */
+	void FinishFanIn(const TSharedPtr<FPendingFanIn>& Pending);
+
+	/** Close a connection once neither components nor fan-ins use it */
+	void ReleaseConnection(const TSharedPtr<FVRPNSharedConnection>& Connection);
+
+	/** Close a fan-in nobody subscribes to, and any source nobody else uses */
+	void ReleaseFanIn(const TSharedPtr<FVRPNFanIn>& FanIn);
+
+	/** Resolve the device names of a connection's subscribers to sender IDs (only when the server described new senders) */
+	void ResolveSenderNames(FVRPNSharedConnection& Connection);
+
+	/** Map every sensor of the connection to the subscribers that track it */
+	void RebuildSubscribers(FVRPNSharedConnection& Connection);
+
+	/** Route one queued sample to the subscribers tracking its sensor */
+	void DispatchSample(FVRPNSharedConnection& Connection, const FVRPNSensorUpdate& Sample);
+};
@@ -20,24 +20,94 @@ struct PROPTICAL_API FVRPNTransformData
 	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
 	FQuat Rotation;
 
-	/** Timestamp when this transform was received (in seconds since connection start) */
+	/** Time the server measured this pose, mapped onto the local clock (FPlatformTime::Seconds, in seconds) */
 	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
-	float Timestamp;
+	double Timestamp;
+
+	/** Linear velocity in position units per second (from the server's velocity reports if it sends them, else zero unless the sensor is filtered) */
+	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
+	FVector Velocity;
+
+	/** Angular velocity in radians per second, as a world-space axis scaled by the rate (server-reported or filtered, like Velocity) */
+	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
+	FVector AngularVelocity;
+
+	/** Linear acceleration in position units per second squared (zero unless the server sends acceleration reports) */
+	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
+	FVector Acceleration;
+
+	/** Angular acceleration in radians per second squared, world-space axis (zero unless the server sends acceleration reports) */
+	UPROPERTY(BlueprintReadWrite, Category = "VRPN")
+	FVector AngularAcceleration;
 
 	/** Default constructor */
 	FVRPNTransformData()
 		: Position(FVector::ZeroVector)
 		, Rotation(FQuat::Identity)
-		, Timestamp(0.0f)
+		, Timestamp(0.0)
+		, Velocity(FVector::ZeroVector)
+		, AngularVelocity(FVector::ZeroVector)
+		, Acceleration(FVector::ZeroVector)
+		, AngularAcceleration(FVector::ZeroVector)
 	{
 	}
 
 	/** Constructor with values */
-	FVRPNTransformData(const FVector& InPosition, const FQuat& InRotation, float InTimestamp)
+	FVRPNTransformData(const FVector& InPosition, const FQuat& InRotation, double InTimestamp)
+		: Position(InPosition)
+		, Rotation(InRotation)
+		, Timestamp(InTimestamp)
+		, Velocity(FVector::ZeroVector)
+		, AngularVelocity(FVector::ZeroVector)
+		, Acceleration(FVector::ZeroVector)
+		, AngularAcceleration(FVector::ZeroVector)
+	{
+	}
+
+	/** Constructor with values and velocities */
+	FVRPNTransformData(const FVector& InPosition, const FQuat& InRotation, double InTimestamp, const FVector& InVelocity, const FVector& InAngularVelocity)
+		: Position(InPosition)
+		, Rotation(InRotation)
+		, Timestamp(InTimestamp)
+		, Velocity(InVelocity)
+		, AngularVelocity(InAngularVelocity)
+		, Acceleration(FVector::ZeroVector)
+		, AngularAcceleration(FVector::ZeroVector)
+	{
+	}
+
+	/** Constructor with values, velocities and accelerations */
+	FVRPNTransformData(const FVector& InPosition, const FQuat& InRotation, double InTimestamp, const FVector& InVelocity, const FVector& InAngularVelocity,
+		const FVector& InAcceleration, const FVector& InAngularAcceleration)
 		: Position(InPosition)
 		, Rotation(InRotation)
 		, Timestamp(InTimestamp)
+		, Velocity(InVelocity)
+		, AngularVelocity(InAngularVelocity)
+		, Acceleration(InAcceleration)
+		, AngularAcceleration(InAngularAcceleration)
+	{
+	}
+
+	/**
+	 * Project the pose forward with its velocities and accelerations (constant acceleration model)
+	 * @param DeltaTime Seconds past Timestamp
+	 * @return Pose, velocities and timestamp DeltaTime later; accelerations are kept
+	 */
+	FVRPNTransformData Extrapolate(double DeltaTime) const
 	{
+		const double HalfDeltaSquared = 0.5 * DeltaTime * DeltaTime;
+		const FVector RotationVector = AngularVelocity * DeltaTime + AngularAcceleration * HalfDeltaSquared;
+
+		// Angular rates are world-space axes, so the increment is applied on the left
+		return FVRPNTransformData(
+			Position + Velocity * DeltaTime + Acceleration * HalfDeltaSquared,
+			(FQuat::MakeFromRotationVector(RotationVector) * Rotation).GetNormalized(),
+			Timestamp + DeltaTime,
+			Velocity + Acceleration * DeltaTime,
+			AngularVelocity + AngularAcceleration * DeltaTime,
+			Acceleration,
+			AngularAcceleration);
 	}
 
 	/** Check if transform data is valid */
@@ -0,0 +1,412 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRPNTypes.generated.h"
+
+/**
+ * What the receive thread does when the game thread falls behind and the update queue is full
+ */
+UENUM(BlueprintType)
+enum class EVRPNQueueOverflowPolicy : uint8
+{
+	/** Discard the oldest queued sample to make room for the new one */
+	DropOldest UMETA(DisplayName = "Drop Oldest"),
+
+	/** Stop queueing and deliver only the latest pose of each sensor that overflowed */
+	KeepLatestPerSensor UMETA(DisplayName = "Keep Latest Per Sensor")
+};
+
+/**
+ * How the receive thread waits for incoming datagrams
+ */
+UENUM(BlueprintType)
+enum class EVRPNReceiveWaitMode : uint8
+{
+	/** Sleep in the socket until data arrives; packets are handled the moment they land, no CPU while idle */
+	Blocking UMETA(DisplayName = "Blocking"),
+
+	/** Poll the socket continuously; lowest latency, but keeps one core busy for the connection's lifetime */
+	BusyPoll UMETA(DisplayName = "Busy Poll")
+};
+
+/**
+ * How tracking data travels from the server
+ */
+UENUM(BlueprintType)
+enum class EVRPNTransportMode : uint8
+{
+	/** Handshake and descriptions over TCP, tracker data over UDP (lowest latency). Plain UDP streams are still received if the server has no TCP port. */
+	UDP UMETA(DisplayName = "UDP (TCP Control)"),
+
+	/** Everything over the TCP connection, for networks that drop UDP. Lost packets stall the stream until retransmitted. */
+	TCPOnly UMETA(DisplayName = "TCP Only")
+};
+
+/**
+ * How a latent connect finished
+ */
+UENUM(BlueprintType)
+enum class EVRPNConnectResult : uint8
+{
+	/** The server (or, with fan-in, one of the servers) is streaming */
+	Connected UMETA(DisplayName = "Connected"),
+
+	/** The host could not be resolved, the connection could not be started, or the component connected elsewhere first */
+	Failed UMETA(DisplayName = "Failed"),
+
+	/** Nothing arrived before the timeout; the component keeps trying in the background */
+	TimedOut UMETA(DisplayName = "Timed Out")
+};
+
+/**
+ * Clock and latency estimate for one connection
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNConnectionTiming
+{
+	GENERATED_BODY()
+
+	/** True once the connection has received enough timestamps to estimate timing */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	bool bValid = false;
+
+	/** Estimated one-way latency from server measurement to local receive. Excludes the fixed network delay until a round trip has been measured. */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float LatencyMs = 0.0f;
+
+	/** Smoothed variation of the one-way latency */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float JitterMs = 0.0f;
+
+	/** Smallest measured round trip to the server (negative until one is measured) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float RoundTripMs = -1.0f;
+
+	/** Local clock minus server clock (seconds) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	double ClockOffset = 0.0;
+
+	/** Rate the server clock drifts against the local clock (parts per million) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	float ClockDriftPpm = 0.0f;
+};
+
+/**
+ * Receive pipeline counters and packet age for one connection
+ * Counters are totals since the connection started; rates and ages cover the last second
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNPipelineStats
+{
+	GENERATED_BODY()
+
+	/** Datagrams received */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 PacketsReceived = 0;
+
+	/** Payload bytes received */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 BytesReceived = 0;
+
+	/** Tracker samples decoded */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 SamplesParsed = 0;
+
+	/** Datagrams containing a malformed message, plus corrupt records of a replayed capture */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 ParseFailures = 0;
+
+	/** Samples lost before reaching the game thread (update queue, sensor table or parse buffer full) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 DroppedSamples = 0;
+
+	/** Failed receive calls */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 ReceiveErrors = 0;
+
+	/** Samples discarded for arriving after a newer sample of the same sensor */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 ReorderedSamples = 0;
+
+	/** Samples discarded for repeating the newest sample of the same sensor */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 DuplicateSamples = 0;
+
+	/** Samples that never arrived, estimated from gaps in each sensor's server timestamps */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 LostSamples = 0;
+
+	/** Samples waiting in the update queue at the last drain */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int32 QueueDepth = 0;
+
+	/** Datagrams received per second */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	float PacketsPerSecond = 0.0f;
+
+	/** Median time from datagram arrival to the game thread draining it */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float PacketAgeP50Ms = 0.0f;
+
+	/** 99th percentile of the same */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float PacketAgeP99Ms = 0.0f;
+
+	/** Largest packet age seen */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float PacketAgeMaxMs = 0.0f;
+
+	/** Reconnect attempts (after a receive error or packet silence) and server switches */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 Reconnects = 0;
+
+	/** Time from the latest connect, reconnect or server switch to its first pose (-1 until a pose arrived) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN", meta = (Units = "ms"))
+	float TimeToFirstPoseMs = -1.0f;
+};
+
+/**
+ * Delivery quality of one sensor's stream
+ * Reordering and duplicates only ever come from the network; loss without either points at the
+ * tracker or the server dropping reports. Counters are totals since the connection started.
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNSensorLinkStats
+{
+	GENERATED_BODY()
+
+	/** True once the sensor has reported */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	bool bValid = false;
+
+	/** Samples accepted (newer than any before them) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 SamplesAccepted = 0;
+
+	/** Samples that never arrived, estimated from gaps in the server timestamps */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 SamplesLost = 0;
+
+	/** Samples discarded for arriving after a newer one */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 SamplesReordered = 0;
+
+	/** Samples discarded for repeating the newest timestamp */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	int64 SamplesDuplicated = 0;
+
+	/** Lost / (accepted + lost) */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	float LossRate = 0.0f;
+
+	/** Reordered / arrived */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	float ReorderRate = 0.0f;
+
+	/** Duplicated / arrived */
+	UPROPERTY(BlueprintReadOnly, Category = "VRPN")
+	float DuplicateRate = 0.0f;
+};
+
+/**
+ * A signed source axis
+ */
+UENUM(BlueprintType)
+enum class EVRPNAxis : uint8
+{
+	PositiveX UMETA(DisplayName = "+X"),
+	NegativeX UMETA(DisplayName = "-X"),
+	PositiveY UMETA(DisplayName = "+Y"),
+	NegativeY UMETA(DisplayName = "-Y"),
+	PositiveZ UMETA(DisplayName = "+Z"),
+	NegativeZ UMETA(DisplayName = "-Z")
+};
+
+/**
+ * Coordinate system the server sends poses in
+ */
+UENUM(BlueprintType)
+enum class EVRPNSourceAxes : uint8
+{
+	/** Right-handed, Z up, X forward, Y left (Proptical, ROS) */
+	RightHandedZUp UMETA(DisplayName = "Right-Handed Z-Up"),
+
+	/** Right-handed, Y up, X right, Z toward the viewer (Motive, OpenGL) */
+	RightHandedYUp UMETA(DisplayName = "Right-Handed Y-Up"),
+
+	/** Use the axis mapping given in ForwardAxis, RightAxis and UpAxis */
+	Custom UMETA(DisplayName = "Custom")
+};
+
+/**
+ * Conversion of incoming poses into Unreal space (left-handed, Z up, centimeters)
+ * Applied on the receive thread to every sample, so everything downstream sees engine-space poses.
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNFrameConversion
+{
+	GENERATED_BODY()
+
+	/** Convert poses; when off they are passed through exactly as the server sent them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	bool bEnabled = false;
+
+	/** Coordinate system of the server */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled"))
+	EVRPNSourceAxes SourceAxes = EVRPNSourceAxes::RightHandedZUp;
+
+	/** Source axis that becomes Unreal +X (forward) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled && SourceAxes == EVRPNSourceAxes::Custom"))
+	EVRPNAxis ForwardAxis = EVRPNAxis::PositiveX;
+
+	/** Source axis that becomes Unreal +Y (right) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled && SourceAxes == EVRPNSourceAxes::Custom"))
+	EVRPNAxis RightAxis = EVRPNAxis::NegativeY;
+
+	/** Source axis that becomes Unreal +Z (up) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled && SourceAxes == EVRPNSourceAxes::Custom"))
+	EVRPNAxis UpAxis = EVRPNAxis::PositiveZ;
+
+	/** Unreal units per source unit (100 for meters) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled"))
+	float UnitScale = 100.0f;
+
+	/** Pose of the tracking space origin in Unreal space, applied after the axis and unit conversion (scale is ignored) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (EditCondition = "bEnabled"))
+	FTransform CalibrationOffset = FTransform::Identity;
+};
+
+/**
+ * Noise filter applied to a sensor on the receive thread
+ */
+UENUM(BlueprintType)
+enum class EVRPNFilterType : uint8
+{
+	/** Poses are passed through unfiltered */
+	None UMETA(DisplayName = "None"),
+
+	/** Speed-adaptive low-pass: heavy smoothing at rest, little lag when moving */
+	OneEuro UMETA(DisplayName = "One Euro"),
+
+	/** Constant-velocity Kalman filter on position and constant-angular-velocity Kalman filter on rotation */
+	Kalman UMETA(DisplayName = "Constant-Velocity Kalman")
+};
+
+/**
+ * Per-body filter parameters
+ * Position and rotation both use the selected filter, each with its own parameters.
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNFilterSettings
+{
+	GENERATED_BODY()
+
+	/** Filter to apply */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	EVRPNFilterType Type = EVRPNFilterType::None;
+
+	/** One Euro: position cutoff frequency at rest; lower removes more jitter on a still body */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.01", Units = "Hz", EditCondition = "Type == EVRPNFilterType::OneEuro"))
+	float MinCutoff = 1.0f;
+
+	/** One Euro: cutoff increase per unit of speed; higher reduces lag during fast motion */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", EditCondition = "Type == EVRPNFilterType::OneEuro"))
+	float Beta = 0.05f;
+
+	/** One Euro: cutoff frequency of the speed estimates (position and rotation) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.01", Units = "Hz", EditCondition = "Type == EVRPNFilterType::OneEuro"))
+	float DerivativeCutoff = 1.0f;
+
+	/** One Euro: rotation cutoff frequency at rest */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.01", Units = "Hz", EditCondition = "Type == EVRPNFilterType::OneEuro"))
+	float RotationMinCutoff = 1.0f;
+
+	/** One Euro: rotation cutoff increase per radian per second of angular speed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", EditCondition = "Type == EVRPNFilterType::OneEuro"))
+	float RotationBeta = 0.5f;
+
+	/** Kalman: standard deviation of the unmodeled acceleration, in position units per second squared */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", EditCondition = "Type == EVRPNFilterType::Kalman"))
+	float ProcessNoise = 500.0f;
+
+	/** Kalman: standard deviation of the measured position, in position units */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.001", EditCondition = "Type == EVRPNFilterType::Kalman"))
+	float MeasurementNoise = 0.5f;
+
+	/** Kalman: standard deviation of the unmodeled angular acceleration, in degrees per second squared */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.0", EditCondition = "Type == EVRPNFilterType::Kalman"))
+	float RotationProcessNoise = 1000.0f;
+
+	/** Kalman: standard deviation of the measured orientation, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0.001", Units = "Degrees", EditCondition = "Type == EVRPNFilterType::Kalman"))
+	float RotationMeasurementNoise = 0.5f;
+};
+
+/**
+ * One segment of a tracked skeleton: a VRPN sensor driving a bone
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNSkeletonSegment
+{
+	GENERATED_BODY()
+
+	/** Bone the segment drives */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	FName BoneName;
+
+	/** Parent bone (None for the root); must be another segment of the same skeleton */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	FName ParentBoneName;
+
+	/** Sensor index of the segment within the device */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "0"))
+	int32 SensorIndex = 0;
+};
+
+/**
+ * Maps the sensors of one VRPN device to the bones of a Live Link subject
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNSkeletonBinding
+{
+	GENERATED_BODY()
+
+	/** Live Link subject to publish (select it in the Live Link Pose node) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	FName SubjectName;
+
+	/** VRPN device carrying the segments, e.g. "Performer1" (empty = sensors of any device). Names come from the TCP connection. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	FString DeviceName;
+
+	/** Segments, one per bone */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	TArray<FVRPNSkeletonSegment> Segments;
+};
+
+/**
+ * One server merged into a fan-in pose source
+ * Bodies are matched across servers by device name and sensor index; for each body the freshest source with the
+ * highest priority wins.
+ */
+USTRUCT(BlueprintType)
+struct PROPTICAL_API FVRPNFanInSource
+{
+	GENERATED_BODY()
+
+	/** Server address (IP or hostname) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	FString ServerAddress = TEXT("127.0.0.1");
+
+	/** Server port */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN", meta = (ClampMin = "1", ClampMax = "65535"))
+	int32 ServerPort = 3883;
+
+	/** Priority of this server for every body (higher wins while its samples are fresh) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	int32 Priority = 0;
+
+	/** Priority of this server for individual bodies, by device name; overrides Priority */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRPN")
+	TMap<FString, int32> BodyPriorities;
+};